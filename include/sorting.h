@@ -3,61 +3,577 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
+#include <stdint.h>
 #include <time.h>
 
 // Global counters for algorithm analysis
 extern long long comparison_count;
 extern long long swap_count;
-extern size_t memory_used;
+extern size_t memory_used;   // Bytes currently held by sort_malloc/sort_calloc
+extern size_t memory_peak;   // High-water mark of memory_used since reset
 
 // Reset counters
 void reset_counters(void);
 
+// Tracked allocator shim: every scratch buffer an algorithm allocates goes
+// through these so memory_used/memory_peak reflect its real extra space
+void *sort_malloc(size_t bytes);
+void *sort_calloc(size_t count, size_t size);
+void sort_free(void *ptr);
+
+// Large buffers: huge pages and NUMA first touch (see memory.c)
+typedef enum {
+    SORT_PAGES_NORMAL,      // malloc, 4 KB pages
+    SORT_PAGES_THP,         // 2 MB-aligned mapping with MADV_HUGEPAGE
+    SORT_PAGES_HUGETLB      // MAP_HUGETLB from the reserved pool, else THP
+} SortPageMode;
+
+typedef struct {
+    SortPageMode pages;
+    int first_touch;        // Fault pages in from the parallelFor workers
+    size_t large_min;       // Bytes from which the policy applies
+} SortMemoryPolicy;
+
+void sortMemoryPolicyDefaults(SortMemoryPolicy *policy);  // SORT_HUGEPAGES, SORT_FIRST_TOUCH
+const SortMemoryPolicy *sortMemoryPolicy(void);
+void setSortMemoryPolicy(const SortMemoryPolicy *policy);
+const char *sortPageModeName(SortPageMode mode);
+int parseSortPageMode(const char *name, SortPageMode *mode);  // 0, or -1 if unknown
+int sortHugetlbAvailable(void);
+void *sortBufferAlloc(size_t bytes);        // Untracked; free with sortBufferFree
+void *sortBufferAllocZeroed(size_t bytes);
+size_t sortBufferSize(const void *ptr);
+void sortBufferFree(void *ptr);
+
 // Utility functions
 void swap(int *a, int *b);
 void swap_counted(int *a, int *b);  // Counts swaps
 int compare_counted(int a, int b);   // Counts comparisons, returns a > b
-void printArray(int arr[], int n);
-void copyArray(int src[], int dest[], int n);
-int isSorted(int arr[], int n);
+void printArray(int arr[], size_t n);
+void copyArray(int src[], int dest[], size_t n);
+int isSorted(int arr[], size_t n);
+double now_ms(void);  // Monotonic wall clock in milliseconds
+
+// Random number generation (xoshiro256**, explicit seeds, see random.c)
+typedef struct {
+    uint64_t s[4];
+} SortRng;
+
+void rngSeed(SortRng *rng, uint64_t seed);
+uint64_t rngNext(SortRng *rng);
+uint64_t rngBounded(SortRng *rng, uint64_t range);  // Uniform in [0, range)
+void rngJump(SortRng *rng);                          // Next independent stream
+double rngUniform(SortRng *rng);                     // Uniform in [0, 1)
+void setSortSeed(uint64_t seed);   // Makes every following generator call reproducible
+uint64_t getSortSeed(void);
+uint64_t nextInputSeed(void);
+void setInputSeed(uint64_t seed);  // Regenerate an input whose seed was recorded
+typedef void (*StreamFill)(SortRng *rng, size_t begin, size_t end, void *ctx);
+void parallelFillStreams(size_t n, uint64_t seed, StreamFill fill, void *ctx);
+void fillRandomRange(int arr[], size_t n, int minVal, int maxVal, uint64_t seed);
+void fillRandomRange64(int64_t arr[], size_t n, int64_t minVal, int64_t maxVal, uint64_t seed);
+
+// Parallel loops (POSIX threads, see parallel.c)
+typedef void (*ParallelBody)(size_t begin, size_t end, int worker, void *ctx);
+int sortThreadCount(void);          // SORT_THREADS or the number of online CPUs
+void setSortThreadCount(int threads);
+void parallelFor(size_t count, size_t grain, ParallelBody body, void *ctx);
+int sortInParallelRegion(void);     // 1 inside a parallelFor range or a multi-worker pool task
+int sortSetParallelRegion(int inside);  // For this thread; returns the previous value
+
+// Persistent worker pool for long-running callers (see thread_pool.c)
+typedef struct ThreadPool ThreadPool;
+typedef void (*PoolTask)(void *arg);
+ThreadPool *threadPoolCreate(int threads);   // threads <= 0: sortThreadCount()
+int threadPoolSubmit(ThreadPool *pool, PoolTask task, void *arg);  // 0, or -1 after shutdown
+void threadPoolWait(ThreadPool *pool);       // Until every submitted task has finished
+void threadPoolDestroy(ThreadPool *pool);    // Runs the queued tasks, then joins
+int threadPoolSize(const ThreadPool *pool);
 
 // Test case generators
-void generateRandomArray(int arr[], int n, int maxVal);
-void generateSortedArray(int arr[], int n);
-void generateReverseSortedArray(int arr[], int n);
-void generateNearlySortedArray(int arr[], int n, int swaps);
-void generateDuplicatesArray(int arr[], int n, int uniqueValues);
+void generateRandomArray(int arr[], size_t n, int maxVal);
+void generateRandomArray64(int64_t arr[], size_t n, int64_t minVal, int64_t maxVal);
+void generateSortedArray(int arr[], size_t n);
+void generateReverseSortedArray(int arr[], size_t n);
+void generateNearlySortedArray(int arr[], size_t n, size_t swaps);
+void generateDuplicatesArray(int arr[], size_t n, int uniqueValues);
+int sequenceKey(size_t i, size_t n);  // i, scaled down when n exceeds INT_MAX
+
+// Adversarial and realistic distributions (see distributions.c)
+typedef void (*ComparatorSort)(void *base, size_t n, size_t size,
+                               int (*cmp)(const void *, const void *));
+
+void generateZipfArray(int arr[], size_t n, int numKeys, double s);
+void generateExponentialArray(int arr[], size_t n, double mean);
+void generateOrganPipeArray(int arr[], size_t n);
+void generateSawtoothArray(int arr[], size_t n, int period);
+void generateRandomRunsArray(int arr[], size_t n, int maxRunLength, int maxVal);
+void generateAllEqualArray(int arr[], size_t n, int value);
+void generateWideKeysArray(int arr[], size_t n);
+void generateWideKeys64(int64_t arr[], size_t n);
+void antiqsort(int arr[], size_t n, ComparatorSort sorter);  // McIlroy's adversary
+void quickSortComparator(void *base, size_t n, size_t size,
+                         int (*cmp)(const void *, const void *));
+void generateAntiQuicksortArray(int arr[], size_t n);
 
 // Bubble Sort
-void bubbleSort(int arr[], int n);
-void bubbleSortOpt(int arr[], int n);
-void bubbleSortCounted(int arr[], int n);  // With counters
+void bubbleSort(int arr[], size_t n);
+void bubbleSortOpt(int arr[], size_t n);
+void bubbleSortCounted(int arr[], size_t n);  // With counters
+void oddEvenSort(int arr[], size_t n);          // Vectorized odd-even transposition
+void parallelOddEvenSort(int arr[], size_t n);  // Block merge-split across threads
 
 // Gnome Sort
-void gnomeSort(int arr[], int n);
-void gnomeSortCounted(int arr[], int n);  // With counters
+void gnomeSort(int arr[], size_t n);
+void gnomeSortCounted(int arr[], size_t n);  // With counters
 
 // Radix Sort
 int key(int x, int i);
-void sortAux(int arr[], int n, int digit);
-void radixSort(int arr[], int n, int k);
+void sortAux(int arr[], size_t n, int digit);
+void radixSort(int arr[], size_t n, int k);
+void radixSortLSD(int arr[], size_t n);   // Base 256, any int (negatives too)
+void radixSortLSDBuffered(int arr[], int scratch[], size_t n);
+void radixSortLSD64(int64_t arr[], size_t n);
+
+// Counting sort for small key ranges (0 on success, -1 if the range
+// max - min + 1 exceeds 2^24 or memory runs out; arr is then unchanged)
+int countingSortRange(int arr[], size_t n, int minVal, int maxVal);
+int countingSort(int arr[], size_t n);                      // Finds min/max itself
+int countingSortKV(int keys[], int values[], size_t n);     // Stable, values follow keys
+int countingSortParallel(int arr[], size_t n);              // Per-thread histograms
+
+// Sort fused with grouping equal keys (no separate sweep over the output)
+size_t sortUnique(int arr[], size_t n);                     // Distinct keys to arr[0..m), returns m
+size_t sortRunLengths(int arr[], size_t n, size_t counts[]); // Same, counts[0..m) (room for n)
+size_t sortDistinctCount(int arr[], size_t n);              // Sorts all n, returns distinct keys
 
 // Quick Sort
-int partition(int arr[], int p, int r);
-void quickSort(int arr[], int p, int r);
-void quickSortCounted(int arr[], int p, int r);  // With counters
+ptrdiff_t partition(int arr[], ptrdiff_t p, ptrdiff_t r);
+void quickSort(int arr[], ptrdiff_t p, ptrdiff_t r);
+void quickSortCounted(int arr[], ptrdiff_t p, ptrdiff_t r);  // With counters
+void quickSort3Way(int arr[], ptrdiff_t p, ptrdiff_t r);     // Equal keys partitioned out
+
+// Lazy sorted iterator: sorts arr in place only as far as keys are taken
+typedef struct {
+    int *arr;
+    size_t n;
+    size_t pos;      // Keys emitted, arr[0..pos) is final
+    size_t ready;    // arr[pos..ready) is sorted too
+    size_t *stack;   // Boundaries of the ranges not yet sorted
+    size_t depth;
+    size_t cap;
+} SortedIterator;
+
+int sortedIteratorInit(SortedIterator *it, int arr[], size_t n);  // 0, or -1
+int sortedIteratorNext(SortedIterator *it, int *key);             // 1, 0 at the end, -1
+size_t sortedIteratorTake(SortedIterator *it, int out[], size_t m);
+void sortedIteratorFree(SortedIterator *it);
+
+// Vectorized quick sort (AVX-512 / AVX2 with scalar introsort fallback)
+void simdSort32(int32_t arr[], size_t n);
+void simdSort64(int64_t arr[], size_t n);
+void simdSortFloat(float arr[], size_t n);
+const char *simdSortIsa(void);  // "avx512", "avx2" or "scalar"
+
+// TimSort (natural runs + galloping merges, stable)
+void timSort(int arr[], size_t n);
 
 // Heap Sort
-void heapify(int arr[], int n, int i);
-void buildMaxHeap(int arr[], int n);
-void heapSort(int arr[], int n);
-void heapSortCounted(int arr[], int n);  // With counters
+void heapify(int arr[], size_t n, size_t i);
+void buildMaxHeap(int arr[], size_t n);
+void heapSort(int arr[], size_t n);
+void heapSortCounted(int arr[], size_t n);  // With counters
+void heapTopK(int arr[], size_t n, size_t k);  // k smallest keys, ascending, into arr[0..k)
+
+// Loser tree k-way merge of sorted runs (next to the heap code)
+typedef struct {
+    int k;
+    int *tree;    // tree[0] = winner run, tree[1..k-1] = loser of each match
+    int *keys;    // Current head key of every run
+    int *done;    // 1 once a run is exhausted
+} LoserTree;
+
+typedef int (*MergeSource)(void *ctx, int run, int *value);  // 0 = run exhausted, -1 = error
+typedef int (*MergeSink)(void *ctx, int value);              // nonzero = error
+
+int loserTreeInit(LoserTree *lt, int k, const int keys[], const int exhausted[]);
+int loserTreeWinner(const LoserTree *lt);
+int loserTreeWinnerKey(const LoserTree *lt);
+void loserTreeReplace(LoserTree *lt, int key);
+void loserTreeExhaust(LoserTree *lt);
+void loserTreeFree(LoserTree *lt);
+int mergeKWay(const int *runs[], const size_t lens[], int k, int out[]);
+long long mergeKWayStream(int k, MergeSource next, void *srcCtx, MergeSink emit, void *sinkCtx);
+long long mergeKWayFiles(const char *paths[], int k, const char *outPath);
 
 // Bucket Sort (for floating point [0,1))
-void bucketSort(float arr[], int n);
+void bucketSort(float arr[], size_t n);
 // Bucket Sort for integers
-void bucketSortInt(int arr[], int n, int maxVal);
+void bucketSortInt(int arr[], size_t n, int maxVal);
+
+// Segmented batch sort: many small arrays in one buffer, segment s is
+// keys[offsets[s] .. offsets[s + 1]) (see segmented_sort.c)
+int segmentedSort(int keys[], const size_t offsets[], size_t segments);  // 0, or -1
+
+// Sorted multiset fed in batches: buffered inserts, merged runs (see
+// sorted_container.c). Functions returning int give 0, or -1 when out of memory
+typedef struct SortedContainer SortedContainer;
+
+typedef struct {
+    size_t buffer_keys;       // Inserts are sorted and merged once this many wait
+    int leveled;              // 0: one main array, 1: log-structured runs
+} SortedContainerConfig;
+
+void sortedContainerConfigDefaults(SortedContainerConfig *cfg);
+SortedContainer *sortedContainerCreate(const SortedContainerConfig *cfg);  // NULL cfg = defaults
+void sortedContainerDestroy(SortedContainer *sc);
+int sortedContainerInsert(SortedContainer *sc, int key);
+int sortedContainerInsertBatch(SortedContainer *sc, const int keys[], size_t n);
+int sortedContainerFlush(SortedContainer *sc);     // Merge the buffered keys now
+int sortedContainerCompact(SortedContainer *sc);   // Merge everything into one array
+size_t sortedContainerSize(const SortedContainer *sc);
+int sortedContainerRuns(const SortedContainer *sc);
+size_t sortedContainerRank(const SortedContainer *sc, int key);   // Keys < key
+size_t sortedContainerCount(const SortedContainer *sc, int key);  // Keys == key
+int sortedContainerContains(const SortedContainer *sc, int key);
+size_t sortedContainerRange(SortedContainer *sc, int lo, int hi, int out[], size_t max);
+
+// String and byte-key sorting (see string_sort.c). Keys are compared
+// bytewise unsigned, a prefix before the longer key; they may contain NUL
+typedef struct {
+    const char *ptr;
+    size_t len;
+} SortString;
+
+int compareSortStrings(const SortString *a, const SortString *b);
+int isSortedStrings(const SortString strs[], size_t n);
+int stringSortMultikey(SortString strs[], size_t n);   // 0, or -1 if out of memory
+int stringSortMSD(SortString strs[], size_t n);        // MSD radix, multikey below 64 keys
+int stringSortQsort(SortString strs[], size_t n);      // libc qsort + memcmp baseline
+
+// Machine tuning profile (see tuning.c, written by `sort_test tune`)
+typedef struct {
+    int small_sort_max;       // sortAuto: insertion sort up to this many keys
+    int radix_bits;           // Digit width of radixSortLSD (4..16)
+    size_t parallel_grain;    // Fewest keys worth a thread of their own
+    int radix_min_n;          // sortAuto: radix from here up, quick sort below
+} SortTuning;
+
+void sortTuningDefaults(SortTuning *t);
+const SortTuning *sortTuning(void);          // Loads the profile on first use
+void setSortTuning(const SortTuning *t);
+const char *sortTuningPath(void);            // SORT_PROFILE or output/sort_profile.txt
+int sortTuningLoad(const char *path, SortTuning *t);   // 0 on success
+int sortTuningSave(const char *path, const SortTuning *t);
+
+// Automatic algorithm selection (see auto_sort.c)
+typedef enum {
+    SORT_STRATEGY_SMALL,      // Insertion sort kernel
+    SORT_STRATEGY_COUNTING,   // Key range no larger than n
+    SORT_STRATEGY_TIMSORT,    // Long runs (ascending or descending)
+    SORT_STRATEGY_QUICK3,     // Few distinct keys over a wide range
+    SORT_STRATEGY_RADIX,      // Everything else, from radix_min_n keys up
+    SORT_STRATEGY_QUICK       // Everything else below radix_min_n
+} SortStrategy;
+
+typedef struct {
+    SortStrategy strategy;
+    size_t n;
+    int min, max;             // Key range (full pass)
+    double ascending;         // Fraction of sampled neighbour pairs in order
+    double descending;        // Fraction of sampled neighbour pairs reversed
+    double estimated_runs;    // Ascending runs extrapolated from the sample
+    int sample_size;
+    int sample_distinct;      // Distinct keys among the sampled positions
+} SortDecision;
+
+const char *sortStrategyName(SortStrategy strategy);
+void insertionSort(int arr[], size_t n);  // Small-sort kernel
+void sortAutoInspect(const int arr[], size_t n, SortDecision *decision);
+void sortAuto(int arr[], size_t n, SortDecision *decision);  // decision may be NULL
+void printSortDecision(const SortDecision *decision);
+
+// Benchmark harness
+typedef void (*SortFunction)(int arr[], size_t n);
+
+typedef struct {
+    const char *name;     // Identifier used on the command line and in CSV/JSON
+    SortFunction sort;
+    long long max_n;      // Largest size the benchmark matrix runs it on (0 = no cap)
+} SortAlgorithm;
+
+typedef struct {
+    const char *name;
+    void (*generate)(int arr[], size_t n);
+} InputGenerator;
+
+typedef struct {
+    const char *name;
+    int (*sort)(SortString strs[], size_t n);
+} StringSortAlgorithm;
+
+typedef struct {
+    int warmup_runs;      // Untimed runs before sampling
+    int min_runs;         // Repeat at least this many times...
+    int max_runs;         // ...but never more than this
+    double min_time_ms;   // Keep sampling until this much time was measured
+    int pin_cpu;          // CPU to pin to (-1 = the current one)
+} BenchConfig;
+
+typedef struct {
+    const char *algorithm;
+    const char *generator;
+    size_t n;
+    int runs;
+    double min_ms;
+    double median_ms;
+    double p90_ms;
+    double mean_ms;
+    double stddev_ms;
+    size_t peak_bytes;
+    int passed;
+    uint64_t input_seed;  // setInputSeed() value the input was generated with
+    double *samples;      // The runs' times in ascending order (runs entries)
+} BenchResult;
+
+typedef struct {
+    BenchConfig bench;
+    long long min_n;      // First size of the 1-2-5 sweep
+    long long max_n;      // Last size (bounded only by memory)
+    double budget_ms;     // Drop an algorithm once a cell's median would exceed this
+    const char *only_algo;  // Optional filters (NULL = all)
+    const char *only_gen;
+} MatrixConfig;
+
+typedef struct {
+    BenchConfig bench;
+    double threshold;     // Relative change that matters (0.05 = 5%)
+    double alpha;         // Significance level of the per-cell test
+    const char *only_algo;
+} CompareConfig;
+
+extern const SortAlgorithm sort_algorithms[];
+extern const int sort_algorithm_count;
+extern const StringSortAlgorithm string_algorithms[];
+extern const int string_algorithm_count;
+extern const InputGenerator input_generators[];
+extern const int input_generator_count;
+
+const SortAlgorithm *findSortAlgorithm(const char *name);
+const InputGenerator *findInputGenerator(const char *name);
+const StringSortAlgorithm *findStringSortAlgorithm(const char *name);
+uint64_t benchGenerateInput(const InputGenerator *gen, int arr[], size_t n);  // Returns its seed
+void benchConfigDefaults(BenchConfig *cfg);
+int benchPinCpu(int cpu);
+void benchSummarize(BenchResult *res, double samples[], int count);
+BenchResult benchMeasure(const SortAlgorithm *alg, const char *generator,
+                         const int input[], int *work, size_t n, const BenchConfig *cfg);
+void matrixConfigDefaults(MatrixConfig *cfg);
+int benchMatrix(const MatrixConfig *cfg, FILE *csv, FILE *samplesCsv,
+                BenchResult **results, int *count);
+void benchFreeResults(BenchResult results[], int count);
+void benchWriteCsvHeader(FILE *f);
+void benchWriteCsvRow(FILE *f, const BenchResult *res);
+void benchWriteSamplesCsvHeader(FILE *f);
+void benchWriteSamplesCsvRows(FILE *f, const BenchResult *res);
+void benchWriteJson(FILE *f, const BenchResult results[], int count);
+
+// Asynchronous generate -> sort -> verify pipeline (see sort_pipeline.c)
+typedef struct SortPipeline SortPipeline;
+typedef struct SortJob SortJob;        // A future: wait, poll, cancel, release
+typedef void (*SortJobCallback)(SortJob *job, void *ctx);
+
+typedef enum {
+    SORT_JOB_QUEUED,
+    SORT_JOB_GENERATING,
+    SORT_JOB_SORTING,
+    SORT_JOB_VERIFYING,
+    SORT_JOB_DONE,            // Terminal states from here on
+    SORT_JOB_CANCELLED,
+    SORT_JOB_FAILED           // Out of memory
+} SortJobState;
+
+typedef struct {
+    SortFunction sort;
+    void (*generate)(int arr[], size_t n);  // NULL: copy input instead
+    const int *input;
+    size_t n;
+    int keep_output;          // Keep the sorted keys until sortJobRelease() (not
+                              // counted against depth: the caller bounds them)
+    SortJobCallback on_done;  // Runs on a pipeline thread once the job has ended
+    void *ctx;
+} SortJobSpec;
+
+typedef struct {
+    SortJobState state;
+    int passed;               // Sorted, with the keys it was generated with
+    double generate_ms;       // Including the copy from input
+    double sort_ms;
+    double verify_ms;
+    double latency_ms;        // Submitted -> ended
+} SortJobResult;
+
+SortPipeline *sortPipelineCreate(int depth);  // depth: arrays in flight at most (0 = 3)
+SortJob *sortPipelineSubmit(SortPipeline *pipeline, const SortJobSpec *spec);
+int sortJobCancel(SortJob *job);              // 0, or -1 once sorting has started
+SortJobState sortJobPoll(SortJob *job);
+void sortJobWait(SortJob *job, SortJobResult *result);
+const int *sortJobOutput(SortJob *job);
+void sortJobRelease(SortJob *job);
+void sortPipelineDrain(SortPipeline *pipeline);
+void sortPipelineDestroy(SortPipeline *pipeline);  // Drains first
+
+// Autotuning of SortTuning (see autotune.c)
+typedef struct {
+    BenchConfig bench;
+    size_t n;                 // Size for the radix width and grain sweeps, and
+                              // the largest size of the crossover sweep
+    const char *only_gen;     // Tune on one generator (NULL = a mixed set)
+} TuneConfig;
+
+void tuneConfigDefaults(TuneConfig *cfg);
+int autotune(const TuneConfig *cfg, SortTuning *best);   // 0 on success
+
+// Benchmark regression comparison
+void compareConfigDefaults(CompareConfig *cfg);
+double mannWhitneyP(const double a[], int na, const double b[], int nb);  // -1 if out of memory
+int bootstrapMedianCI(const double samples[], int count, double confidence,
+                      double *lo, double *hi);                            // 0, or -1 if out of memory
+int benchCompare(const char *baselinePath, const CompareConfig *cfg);
+
+// External merge sort for int32 files larger than RAM (see external_sort.c)
+typedef struct {
+    size_t memory_bytes;    // Budget for chunk and merge buffers
+    const char *temp_dir;   // Where sorted runs are spilled
+} ExternalSortConfig;
+
+typedef struct {
+    size_t elements;
+    int runs;               // Sorted runs produced by phase 1
+    int merge_passes;       // Including the final pass
+    double run_ms;
+    double merge_ms;
+} ExternalSortStats;
+
+void externalSortConfigDefaults(ExternalSortConfig *cfg);
+int externalSort(const char *inPath, const char *outPath,
+                 const ExternalSortConfig *cfg, ExternalSortStats *stats);
+
+// Sorting raw binary files in place through mmap (see file_sort.c)
+typedef struct {
+    int element_size;        // 4 (int32) or 8 (int64), little-endian
+    int lines;               // Newline-delimited text instead (element_size unused)
+    const char *algorithm;   // int32 engine from sort_algorithms (default "simd", in
+                             // place; int64 uses simd unless "radix_lsd"),
+                             // or with lines one from string_algorithms
+    int verify;              // Numeric files: check the result in a second pass
+    int advise_sequential;   // madvise(MADV_SEQUENTIAL) for the verify pass
+    int advise_hugepage;     // madvise(MADV_HUGEPAGE)
+} FileSortConfig;
+
+typedef struct {
+    size_t elements;
+    double copy_ms;          // Kernel-side copy to the output file
+    double sort_ms;
+    double lines_ms;         // Lines: splitting and writing the text back
+    double verify_ms;
+    int sorted;              // Verify pass result (1 if it did not run)
+    int hugepage_ok;         // The kernel accepted MADV_HUGEPAGE
+} FileSortStats;
+
+void fileSortConfigDefaults(FileSortConfig *cfg);
+int mmapSortFile(const char *inPath, const char *outPath,
+                 const FileSortConfig *cfg, FileSortStats *stats);
+
+// Local sort service over a Unix domain socket (see sort_server.c)
+// Every request and response is one SOCK_SEQPACKET message. The keys
+// (int32, host order) live in a memfd sent with the request (SCM_RIGHTS);
+// results are written back into it in place.
+#define SORT_SERVICE_SOCKET "/tmp/sort_server.sock"
+#define SORT_SERVICE_MAX_RUNS 4096
+
+typedef enum {
+    SORT_OP_SORT = 1,       // Sort the payload
+    SORT_OP_TOPK,           // k smallest keys, ascending, into payload[0..k)
+    SORT_OP_MERGE,          // Merge the sorted runs whose lengths follow the request
+    SORT_OP_STATS,          // No payload: totals since the server started
+    SORT_OP_SHUTDOWN        // No payload: finish the queued jobs and exit
+} SortOp;
+
+typedef struct {
+    uint32_t op;            // SortOp
+    uint32_t runs;          // SORT_OP_MERGE: uint64 run lengths after the request
+    uint64_t id;            // Echoed in the response
+    uint64_t n;             // Keys in the payload
+    uint64_t k;             // SORT_OP_TOPK
+} SortRequest;
+
+typedef struct {
+    uint64_t id;
+    int32_t status;         // 0 done, -1 bad request or out of memory
+    uint32_t batch;         // Jobs in the pool task this job ran in
+    double queue_ms;        // Received -> started
+    double run_ms;          // Started -> finished
+    // SORT_OP_STATS only
+    uint64_t jobs;
+    uint64_t keys;
+    uint64_t batches;
+    double uptime_ms;
+    double mean_latency_ms; // Received -> answered
+    double max_latency_ms;
+} SortResponse;
+
+typedef struct {
+    const char *socket_path;
+    int threads;            // Pool workers (0 = sortThreadCount())
+    size_t batch_max_keys;  // Jobs this small are batched
+    int batch_max_jobs;     // Jobs per batch, at most
+    int verbose;            // One line per job
+} SortServerConfig;
+
+void sortServerConfigDefaults(SortServerConfig *cfg);
+int sortServerRun(const SortServerConfig *cfg);  // 0 after SORT_OP_SHUTDOWN or sortServerStop()
+void sortServerStop(void);                       // Async-signal-safe
+
+// Client side (see sort_client.c)
+int sortClientConnect(const char *path);         // Socket, or -1
+int sortClientSend(int sock, const SortRequest *req, int payload, const uint64_t runLens[]);
+int sortClientReceive(int sock, SortResponse *resp);
+int sortPayloadCreate(size_t n, int **keys);     // memfd mapped at *keys, or -1
+void sortPayloadDestroy(int payload, int *keys, size_t n);
+
+// Per-phase tracing (build with `make TRACE=1`)
+// Without SORT_TRACE the hooks below expand to nothing, so the algorithms
+// compile exactly as if they were not there.
+#ifdef SORT_TRACE
+void trace_reset(void);
+void trace_qs_enter(void);
+void trace_qs_leave(void);
+void trace_qs_split(ptrdiff_t p, ptrdiff_t q, ptrdiff_t r);
+void trace_bucket_run(void);
+void trace_bucket_occupancy(long long occupancy);
+double trace_radix_pass_begin(void);
+void trace_radix_pass_end(int pass, double start_ms);
+int trace_write_json(const char *path);  // Returns 0 on success
+
+#define TRACE_QS_ENTER() trace_qs_enter()
+#define TRACE_QS_LEAVE() trace_qs_leave()
+#define TRACE_QS_SPLIT(p, q, r) trace_qs_split((p), (q), (r))
+#define TRACE_BUCKET_RUN() trace_bucket_run()
+#define TRACE_BUCKET_OCCUPANCY(count) trace_bucket_occupancy(count)
+#define TRACE_RADIX_PASS_BEGIN(var) double var = trace_radix_pass_begin()
+#define TRACE_RADIX_PASS_END(pass, var) trace_radix_pass_end((pass), (var))
+#else
+#define TRACE_QS_ENTER() ((void)0)
+#define TRACE_QS_LEAVE() ((void)0)
+#define TRACE_QS_SPLIT(p, q, r) ((void)0)
+#define TRACE_BUCKET_RUN() ((void)0)
+#define TRACE_BUCKET_OCCUPANCY(count) ((void)0)
+#define TRACE_RADIX_PASS_BEGIN(var) ((void)0)
+#define TRACE_RADIX_PASS_END(pass, var) ((void)0)
+#endif
 
 // Stability demonstration
 typedef struct {
@@ -67,4 +583,8 @@ typedef struct {
 
 void demonstrateStability(void);
 
+// Parallel stable merge sort (merge-path partitioned levels)
+void parallelMergeSort(int arr[], size_t n);
+void parallelMergeSortStable(StableElement arr[], size_t n);
+
 #endif // SORTING_H
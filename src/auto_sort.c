@@ -0,0 +1,160 @@
+/*
+ * Automatic Algorithm Selection
+ *
+ * sortAuto() looks at the input before sorting it and picks the
+ * algorithm the selection guide would recommend:
+ *   - n tiny                       -> insertion sort kernel
+ *   - key range no larger than n   -> counting sort
+ *   - almost every sampled pair in
+ *     order (or reverse order)     -> TimSort (merges the natural runs)
+ *   - few distinct sampled keys    -> three-way quick sort
+ *   - otherwise, large n           -> LSD radix sort
+ *   - otherwise                    -> vectorized quick sort
+ *
+ * "Tiny" and "large" are small_sort_max and radix_min_n from the tuning
+ * profile (see tuning.c and `sort_test tune`).
+ *
+ * Inspection costs one min/max pass plus AUTO_SAMPLE sampled positions:
+ * adjacent pairs there estimate presortedness (runs), and the sampled
+ * keys themselves estimate the number of distinct values.
+ */
+
+#include "../include/sorting.h"
+
+#define AUTO_SAMPLE 256            // Sampled positions
+#define AUTO_PRESORTED 0.97        // Fraction of ordered pairs that means "runs"
+#define AUTO_DUPLICATES 4          // sample / distinct above this means "duplicates"
+
+const char *sortStrategyName(SortStrategy strategy) {
+    switch (strategy) {
+        case SORT_STRATEGY_SMALL:    return "insertion";
+        case SORT_STRATEGY_COUNTING: return "counting";
+        case SORT_STRATEGY_TIMSORT:  return "timsort";
+        case SORT_STRATEGY_QUICK3:   return "quick3way";
+        case SORT_STRATEGY_RADIX:    return "radix_lsd";
+        case SORT_STRATEGY_QUICK:    return "simd_quick";
+    }
+    return "unknown";
+}
+
+/*
+ * Small-sort kernel: straight insertion sort
+ */
+void insertionSort(int arr[], size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        int x = arr[i];
+        size_t j = i;
+        while (j > 0 && arr[j - 1] > x) {
+            arr[j] = arr[j - 1];
+            j--;
+        }
+        arr[j] = x;
+    }
+}
+
+/*
+ * Fill decision with the input statistics and the chosen strategy
+ */
+void sortAutoInspect(const int arr[], size_t n, SortDecision *decision) {
+    memset(decision, 0, sizeof(*decision));
+    decision->n = n;
+    if (n == 0) {
+        decision->strategy = SORT_STRATEGY_SMALL;
+        return;
+    }
+
+    int minVal = arr[0], maxVal = arr[0];
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i] < minVal) minVal = arr[i];
+        if (arr[i] > maxVal) maxVal = arr[i];
+    }
+    decision->min = minVal;
+    decision->max = maxVal;
+    long long range = (long long)maxVal - minVal + 1;
+
+    // Sample evenly spaced positions: their pairs and their keys
+    int samples = n - 1 < AUTO_SAMPLE ? (int)(n - 1) : AUTO_SAMPLE;
+    int keys[AUTO_SAMPLE];
+    int ascending = 0, descending = 0;
+    for (int s = 0; s < samples; s++) {
+        size_t i = (size_t)s * ((n - 1) / (size_t)samples);
+        if (arr[i] <= arr[i + 1]) ascending++;
+        if (arr[i] > arr[i + 1]) descending++;
+        keys[s] = arr[i];
+    }
+
+    insertionSort(keys, (size_t)samples);
+    int distinct = samples > 0 ? 1 : 0;
+    for (int s = 1; s < samples; s++) {
+        if (keys[s] != keys[s - 1]) distinct++;
+    }
+
+    decision->sample_size = samples;
+    decision->sample_distinct = distinct;
+    decision->ascending = samples ? (double)ascending / samples : 1.0;
+    decision->descending = samples ? (double)descending / samples : 0.0;
+    // A break in the dominant direction starts a new run (TimSort also
+    // takes descending runs, so a reversed array is a single run)
+    double breaks = decision->descending < decision->ascending ? decision->descending
+                                                               : decision->ascending;
+    decision->estimated_runs = 1.0 + breaks * (double)(n - 1);
+
+    const SortTuning *tuning = sortTuning();
+    if (n <= (size_t)tuning->small_sort_max) {
+        decision->strategy = SORT_STRATEGY_SMALL;
+    } else if ((unsigned long long)range <= n) {
+        decision->strategy = SORT_STRATEGY_COUNTING;
+    } else if (decision->ascending >= AUTO_PRESORTED || decision->descending >= AUTO_PRESORTED) {
+        decision->strategy = SORT_STRATEGY_TIMSORT;
+    } else if (distinct * AUTO_DUPLICATES <= samples) {
+        decision->strategy = SORT_STRATEGY_QUICK3;
+    } else if (n >= (size_t)tuning->radix_min_n) {
+        decision->strategy = SORT_STRATEGY_RADIX;
+    } else {
+        decision->strategy = SORT_STRATEGY_QUICK;
+    }
+}
+
+/*
+ * Sort arr[0..n) with the strategy sortAutoInspect picks;
+ * decision may be NULL when the caller does not want the report
+ */
+void sortAuto(int arr[], size_t n, SortDecision *decision) {
+    SortDecision local;
+    if (!decision) decision = &local;
+    sortAutoInspect(arr, n, decision);
+
+    switch (decision->strategy) {
+        case SORT_STRATEGY_SMALL:
+            insertionSort(arr, n);
+            break;
+        case SORT_STRATEGY_COUNTING:
+            // The parallel variant redoes the min/max pass, so only use it
+            // when there are threads to share the work
+            if ((sortThreadCount() > 1 ? countingSortParallel(arr, n)
+                                       : countingSortRange(arr, n, decision->min, decision->max)) != 0) {
+                radixSortLSD(arr, n);
+            }
+            break;
+        case SORT_STRATEGY_TIMSORT:
+            timSort(arr, n);
+            break;
+        case SORT_STRATEGY_QUICK3:
+            quickSort3Way(arr, 0, (ptrdiff_t)n - 1);
+            break;
+        case SORT_STRATEGY_RADIX:
+            radixSortLSD(arr, n);
+            break;
+        case SORT_STRATEGY_QUICK:
+            simdSort32((int32_t *)arr, n);
+            break;
+    }
+}
+
+void printSortDecision(const SortDecision *decision) {
+    printf("  sortAuto chose %s: n=%zu, range [%d, %d], %.0f%% of sampled pairs ascending "
+           "(~%.0f runs), %d distinct of %d sampled keys\n",
+           sortStrategyName(decision->strategy), decision->n, decision->min, decision->max,
+           decision->ascending * 100.0, decision->estimated_runs,
+           decision->sample_distinct, decision->sample_size);
+}
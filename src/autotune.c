@@ -0,0 +1,227 @@
+/*
+ * Autotuning (`sort_test tune`)
+ *
+ * Sweeps every field of SortTuning with the benchmark harness and keeps
+ * the fastest value:
+ *   radix_bits      radix_lsd at n keys with 8, 11 and 16-bit digits
+ *   parallel_grain  merge at n keys for a few grains (needs 2+ threads)
+ *   radix_min_n     smallest 1-2-5 size from which radix_lsd keeps beating
+ *                   the vectorized quick sort
+ *   small_sort_max  largest size at which insertion sort still beats the
+ *                   vectorized quick sort, timed over many consecutive
+ *                   small arrays so each run is long enough to measure
+ * A candidate's score is the sum of its medians over the tuning
+ * generators; every candidate sorts the same inputs.
+ */
+
+#include "../include/sorting.h"
+#include <limits.h>
+
+#define TUNE_CHUNKED_N (1 << 16)   // Keys per run in the small-sort sweep
+#define TUNE_MAX_GENS 4
+
+static const char *tune_generators[TUNE_MAX_GENS] = {"random", "wide", "zipf", "runs"};
+
+void tuneConfigDefaults(TuneConfig *cfg) {
+    benchConfigDefaults(&cfg->bench);
+    cfg->bench.warmup_runs = 1;
+    cfg->bench.min_runs = 3;
+    cfg->bench.min_time_ms = 50.0;
+    cfg->n = 1000000;
+    cfg->only_gen = NULL;
+}
+
+// ============================================================
+// SWEEP HELPERS
+// ============================================================
+
+static size_t tune_chunk = 1;   // Array length for the chunked sorts below
+
+static void insertionChunks(int arr[], size_t n) {
+    for (size_t off = 0; off < n; off += tune_chunk) {
+        insertionSort(arr + off, n - off < tune_chunk ? n - off : tune_chunk);
+    }
+}
+
+static void quickChunks(int arr[], size_t n) {
+    for (size_t off = 0; off < n; off += tune_chunk) {
+        size_t len = n - off < tune_chunk ? n - off : tune_chunk;
+        simdSort32((int32_t *)(arr + off), len);
+    }
+}
+
+static void radixLsd(int arr[], size_t n) {
+    radixSortLSD(arr, n);
+}
+
+static void quickSimd(int arr[], size_t n) {
+    simdSort32((int32_t *)arr, n);
+}
+
+static void mergeParallel(int arr[], size_t n) {
+    parallelMergeSort(arr, n);
+}
+
+typedef struct {
+    const TuneConfig *cfg;
+    const InputGenerator *gens[TUNE_MAX_GENS];
+    int gen_count;
+    int *inputs[TUNE_MAX_GENS];   // One input per generator, regenerated per size
+    int *work;
+    size_t n;                     // Size the inputs currently hold
+} TuneContext;
+
+static void tuneGenerate(TuneContext *ctx, size_t n) {
+    ctx->n = n;
+    for (int g = 0; g < ctx->gen_count; g++) ctx->gens[g]->generate(ctx->inputs[g], n);
+}
+
+/*
+ * Sum over the tuning generators of alg's median time at ctx->n keys;
+ * check is 0 for the chunked sorts, which leave the array unsorted
+ */
+static double tuneScore(TuneContext *ctx, const char *name, SortFunction sort, int check) {
+    SortAlgorithm alg = {name, sort, 0};
+    double total = 0.0;
+    for (int g = 0; g < ctx->gen_count; g++) {
+        BenchResult res = benchMeasure(&alg, ctx->gens[g]->name, ctx->inputs[g], ctx->work,
+                                       ctx->n, &ctx->cfg->bench);
+        if (check && !res.passed) printf("  Warning: %s did not sort %s\n", name, res.generator);
+        total += res.median_ms;
+        benchFreeResults(&res, 1);
+    }
+    return total;
+}
+
+// ============================================================
+// SWEEPS
+// ============================================================
+
+static void tuneRadixBits(TuneContext *ctx, SortTuning *best) {
+    static const int candidates[] = {8, 11, 16};
+    double best_ms = 0.0;
+
+    printf("radix_bits (radix_lsd, n=%zu)\n", ctx->n);
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        SortTuning t = *best;
+        t.radix_bits = candidates[i];
+        setSortTuning(&t);
+        double ms = tuneScore(ctx, "radix_lsd", radixLsd, 1);
+        printf("  %-8d %12.4f ms\n", candidates[i], ms);
+        if (i == 0 || ms < best_ms) {
+            best_ms = ms;
+            best->radix_bits = candidates[i];
+        }
+    }
+    setSortTuning(best);
+}
+
+static void tuneParallelGrain(TuneContext *ctx, SortTuning *best) {
+    static const size_t candidates[] = {1 << 12, 1 << 14, 1 << 16, 1 << 18};
+    double best_ms = 0.0;
+
+    printf("parallel_grain (merge, n=%zu, %d threads)\n", ctx->n, sortThreadCount());
+    if (sortThreadCount() < 2) {
+        printf("  skipped: one thread, keeping %zu\n", best->parallel_grain);
+        return;
+    }
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        SortTuning t = *best;
+        t.parallel_grain = candidates[i];
+        setSortTuning(&t);
+        double ms = tuneScore(ctx, "merge", mergeParallel, 1);
+        printf("  %-8zu %12.4f ms\n", candidates[i], ms);
+        if (i == 0 || ms < best_ms) {
+            best_ms = ms;
+            best->parallel_grain = candidates[i];
+        }
+    }
+    setSortTuning(best);
+}
+
+static void tuneRadixCrossover(TuneContext *ctx, SortTuning *best) {
+    printf("radix_min_n (radix_lsd vs simd quick sort)\n");
+    printf("  %-10s %12s %12s\n", "n", "radix (ms)", "quick (ms)");
+
+    // Smallest size from which radix won at every larger size
+    int crossover = INT_MAX;
+    size_t size = 64;
+    for (int step = 0; size <= ctx->cfg->n; step++) {
+        tuneGenerate(ctx, size);
+        double radix = tuneScore(ctx, "radix_lsd", radixLsd, 1);
+        double quick = tuneScore(ctx, "simd", quickSimd, 1);
+        printf("  %-10zu %12.4f %12.4f\n", size, radix, quick);
+
+        if (radix < quick) {
+            if (crossover == INT_MAX) crossover = size < INT_MAX ? (int)size : INT_MAX - 1;
+        } else {
+            crossover = INT_MAX;
+        }
+        size = step % 3 == 1 ? size / 2 * 5 : size * 2;   // 1-2-5 steps
+    }
+    best->radix_min_n = crossover;
+    setSortTuning(best);
+}
+
+static void tuneSmallSort(TuneContext *ctx, SortTuning *best) {
+    static const int candidates[] = {4, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+
+    printf("small_sort_max (insertion vs simd quick sort, %d keys per run)\n", TUNE_CHUNKED_N);
+    printf("  %-10s %12s %12s\n", "size", "insert (ms)", "quick (ms)");
+    tuneGenerate(ctx, TUNE_CHUNKED_N);
+
+    int threshold = 1;
+    for (size_t i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++) {
+        tune_chunk = (size_t)candidates[i];
+        double insertion = tuneScore(ctx, "insertion", insertionChunks, 0);
+        double quick = tuneScore(ctx, "simd", quickChunks, 0);
+        printf("  %-10d %12.4f %12.4f\n", candidates[i], insertion, quick);
+        if (insertion <= quick) threshold = candidates[i];
+    }
+    best->small_sort_max = threshold;
+    setSortTuning(best);
+}
+
+/*
+ * Run all sweeps starting from the defaults; best receives the winners
+ * and becomes the active tuning. Returns 0 on success, -1 on bad input
+ * or allocation failure.
+ */
+int autotune(const TuneConfig *cfg, SortTuning *best) {
+    TuneContext ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.cfg = cfg;
+
+    if (cfg->only_gen) {
+        ctx.gens[ctx.gen_count] = findInputGenerator(cfg->only_gen);
+        if (!ctx.gens[ctx.gen_count]) return -1;
+        ctx.gen_count++;
+    } else {
+        for (int g = 0; g < TUNE_MAX_GENS; g++) {
+            ctx.gens[ctx.gen_count++] = findInputGenerator(tune_generators[g]);
+        }
+    }
+
+    size_t capacity = cfg->n > TUNE_CHUNKED_N ? cfg->n : TUNE_CHUNKED_N;
+    int ok = cfg->n > 0;
+    for (int g = 0; g < ctx.gen_count && ok; g++) {
+        ctx.inputs[g] = (int *)sortBufferAlloc(capacity * sizeof(int));
+        ok = ctx.inputs[g] != NULL;
+    }
+    ctx.work = (int *)sortBufferAlloc(capacity * sizeof(int));
+
+    if (ok && ctx.work) {
+        sortTuningDefaults(best);
+        setSortTuning(best);
+
+        tuneGenerate(&ctx, cfg->n);
+        tuneRadixBits(&ctx, best);
+        tuneParallelGrain(&ctx, best);
+        tuneRadixCrossover(&ctx, best);
+        tuneSmallSort(&ctx, best);
+    }
+
+    for (int g = 0; g < ctx.gen_count; g++) sortBufferFree(ctx.inputs[g]);
+    sortBufferFree(ctx.work);
+    return ok && ctx.work ? 0 : -1;
+}
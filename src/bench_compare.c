@@ -0,0 +1,376 @@
+/*
+ * Benchmark Regression Comparison
+ *
+ * Re-measures every cell (algorithm, generator, n) found in a baseline
+ * results file and decides per cell whether the new run is slower, faster
+ * or indistinguishable:
+ *
+ *   - Baseline with raw samples (bench/matrix --samples output):
+ *     two-sided Mann-Whitney U test on the two sets of run times
+ *   - Baseline with one value per cell (summary CSV from bench/matrix, or
+ *     the wide legacy CSV such as output/benchmark_results.csv):
+ *     bootstrap confidence interval of the new median against that value
+ *
+ * A cell only counts as a regression or improvement when the difference is
+ * both statistically significant and larger than the relative threshold,
+ * so tiny but real differences do not fail the gate.
+ *
+ * Baselines written by bench/matrix record each input's seed, and the
+ * inputs are regenerated from it, so both sides sort the same keys. The
+ * legacy CSV has no seed column; its cells get fresh inputs.
+ */
+
+#include <math.h>
+#include "../include/sorting.h"
+
+#define BOOTSTRAP_RESAMPLES 2000
+
+typedef struct {
+    char algorithm[32];
+    char generator[32];
+    size_t n;
+    uint64_t seed;
+    int has_seed;
+    double *samples;
+    int count;
+    int capacity;
+} BaselineCell;
+
+typedef struct {
+    BaselineCell *cells;
+    int count;
+    int capacity;
+    int has_samples;   // 1 if cells hold raw runs, 0 if one value per cell
+    int has_seeds;     // 1 if cells record their input's seed
+} Baseline;
+
+void compareConfigDefaults(CompareConfig *cfg) {
+    benchConfigDefaults(&cfg->bench);
+    cfg->bench.min_runs = 10;
+    cfg->threshold = 0.05;
+    cfg->alpha = 0.01;
+    cfg->only_algo = NULL;
+}
+
+// ============================================================
+// BASELINE PARSING
+// ============================================================
+
+// The cell for (alg, gen, n), added if new; NULL if memory runs out
+static BaselineCell *findOrAddCell(Baseline *b, const char *alg, const char *gen, size_t n) {
+    for (int i = 0; i < b->count; i++) {
+        BaselineCell *c = &b->cells[i];
+        if (c->n == n && strcmp(c->algorithm, alg) == 0 && strcmp(c->generator, gen) == 0) return c;
+    }
+    if (b->count == b->capacity) {
+        int capacity = b->capacity ? b->capacity * 2 : 64;
+        BaselineCell *cells = (BaselineCell *)realloc(b->cells, capacity * sizeof(BaselineCell));
+        if (!cells) return NULL;
+        b->cells = cells;
+        b->capacity = capacity;
+    }
+    BaselineCell *c = &b->cells[b->count++];
+    memset(c, 0, sizeof(*c));
+    snprintf(c->algorithm, sizeof(c->algorithm), "%s", alg);
+    snprintf(c->generator, sizeof(c->generator), "%s", gen);
+    c->n = n;
+    return c;
+}
+
+// 0, or -1 if memory runs out (c is then unchanged)
+static int addSample(BaselineCell *c, double value) {
+    if (!c) return -1;
+    if (c->count == c->capacity) {
+        int capacity = c->capacity ? c->capacity * 2 : 16;
+        double *samples = (double *)realloc(c->samples, capacity * sizeof(double));
+        if (!samples) return -1;
+        c->samples = samples;
+        c->capacity = capacity;
+    }
+    c->samples[c->count++] = value;
+    return 0;
+}
+
+// Split a CSV line in place (no quoting in our files); returns field count
+static int splitCsv(char *line, char *fields[], int maxFields) {
+    int count = 0;
+    line[strcspn(line, "\r\n")] = '\0';
+    char *p = line;
+    while (count < maxFields) {
+        fields[count++] = p;
+        char *comma = strchr(p, ',');
+        if (!comma) break;
+        *comma = '\0';
+        p = comma + 1;
+    }
+    return count;
+}
+
+static int columnIndex(char *header[], int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(header[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+static int loadBaseline(const char *path, Baseline *b) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    
+    char headerLine[1024], line[1024];
+    char *header[32], *fields[32];
+    if (!fgets(headerLine, sizeof(headerLine), f)) {
+        fclose(f);
+        return -1;
+    }
+    int columns = splitCsv(headerLine, header, 32);
+    
+    int wide = strcmp(header[0], "n") == 0;
+    int algCol = columnIndex(header, columns, "algorithm");
+    int genCol = columnIndex(header, columns, "generator");
+    int nCol = columnIndex(header, columns, "n");
+    int valueCol = columnIndex(header, columns, "sample_ms");
+    int seedCol = columnIndex(header, columns, "seed");
+    b->has_samples = valueCol >= 0;
+    b->has_seeds = seedCol >= 0;
+    if (valueCol < 0) valueCol = columnIndex(header, columns, "median_ms");
+    
+    if (!wide && (algCol < 0 || genCol < 0 || nCol < 0 || valueCol < 0)) {
+        fclose(f);
+        return -1;
+    }
+    
+    int status = 0;
+    while (status == 0 && fgets(line, sizeof(line), f)) {
+        int count = splitCsv(line, fields, 32);
+        if (count < 2) continue;
+        
+        if (wide) {
+            // Legacy layout: n followed by one column per algorithm, all on
+            // random input; memory columns are not algorithm names
+            size_t n = strtoull(fields[0], NULL, 10);
+            for (int i = 1; i < count && i < columns && status == 0; i++) {
+                if (findSortAlgorithm(header[i])) {
+                    status = addSample(findOrAddCell(b, header[i], "random", n), atof(fields[i]));
+                }
+            }
+        } else if (count > algCol && count > genCol && count > nCol && count > valueCol) {
+            BaselineCell *c = findOrAddCell(b, fields[algCol], fields[genCol],
+                                            strtoull(fields[nCol], NULL, 10));
+            status = addSample(c, atof(fields[valueCol]));
+            if (status == 0 && seedCol >= 0 && count > seedCol && !c->has_seed) {
+                c->seed = strtoull(fields[seedCol], NULL, 10);
+                c->has_seed = 1;
+            }
+        }
+    }
+    
+    fclose(f);
+    return status;
+}
+
+static void freeBaseline(Baseline *b) {
+    for (int i = 0; i < b->count; i++) free(b->cells[i].samples);
+    free(b->cells);
+}
+
+// ============================================================
+// STATISTICS
+// ============================================================
+
+typedef struct {
+    double value;
+    int group;
+} RankedValue;
+
+static int compareRanked(const void *a, const void *b) {
+    double x = ((const RankedValue *)a)->value;
+    double y = ((const RankedValue *)b)->value;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Two-sided Mann-Whitney U test (normal approximation with tie and
+ * continuity correction). Returns the p-value for "both samples come from
+ * the same distribution", or -1 if memory runs out.
+ */
+double mannWhitneyP(const double a[], int na, const double b[], int nb) {
+    int total = na + nb;
+    RankedValue *all = (RankedValue *)malloc(total * sizeof(RankedValue));
+    if (!all) return -1.0;
+    for (int i = 0; i < na; i++) all[i] = (RankedValue){a[i], 0};
+    for (int i = 0; i < nb; i++) all[na + i] = (RankedValue){b[i], 1};
+    qsort(all, total, sizeof(RankedValue), compareRanked);
+    
+    double rankSumA = 0.0, tieTerm = 0.0;
+    for (int i = 0; i < total; ) {
+        int j = i;
+        while (j + 1 < total && all[j + 1].value == all[i].value) j++;
+        double rank = (i + j) / 2.0 + 1.0;   // Average rank of the tie group
+        for (int k = i; k <= j; k++) {
+            if (all[k].group == 0) rankSumA += rank;
+        }
+        double t = j - i + 1;
+        tieTerm += t * t * t - t;
+        i = j + 1;
+    }
+    free(all);
+    
+    double u = rankSumA - na * (na + 1) / 2.0;
+    double mean = na * (double)nb / 2.0;
+    double var = na * (double)nb / 12.0 * ((total + 1) - tieTerm / ((double)total * (total - 1)));
+    if (var <= 0.0) return 1.0;
+    
+    double diff = fabs(u - mean) - 0.5;
+    if (diff < 0.0) diff = 0.0;
+    return erfc(diff / sqrt(var) / sqrt(2.0));
+}
+
+static int compareDoubleAsc(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static double medianOf(double values[], int count) {
+    qsort(values, count, sizeof(double), compareDoubleAsc);
+    return count % 2 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+/*
+ * Percentile bootstrap confidence interval of the median
+ * A fixed-seed generator keeps the verdict reproducible for the same samples
+ * Returns 0, or -1 if memory runs out
+ */
+int bootstrapMedianCI(const double samples[], int count, double confidence,
+                      double *lo, double *hi) {
+    double *medians = (double *)malloc(BOOTSTRAP_RESAMPLES * sizeof(double));
+    double *resample = (double *)malloc(count * sizeof(double));
+    if (!medians || !resample) {
+        free(resample);
+        free(medians);
+        return -1;
+    }
+    unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    
+    for (int r = 0; r < BOOTSTRAP_RESAMPLES; r++) {
+        for (int i = 0; i < count; i++) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            resample[i] = samples[state % count];
+        }
+        medians[r] = medianOf(resample, count);
+    }
+    qsort(medians, BOOTSTRAP_RESAMPLES, sizeof(double), compareDoubleAsc);
+    
+    double tail = (1.0 - confidence) / 2.0;
+    *lo = medians[(int)(tail * (BOOTSTRAP_RESAMPLES - 1))];
+    *hi = medians[(int)((1.0 - tail) * (BOOTSTRAP_RESAMPLES - 1))];
+    free(resample);
+    free(medians);
+    return 0;
+}
+
+// ============================================================
+// COMPARISON
+// ============================================================
+
+/*
+ * Compare a fresh run against the baseline file
+ * Returns the number of significant regressions, -1 if the baseline
+ * cannot be read, or -2 if memory runs out during the comparison
+ */
+int benchCompare(const char *baselinePath, const CompareConfig *cfg) {
+    Baseline base;
+    memset(&base, 0, sizeof(base));
+    if (loadBaseline(baselinePath, &base) != 0) {
+        freeBaseline(&base);
+        return -1;
+    }
+    
+    printf("Comparing against %s (%d cells, %s), threshold %.1f%%, alpha %.3f\n",
+           baselinePath, base.count,
+           base.has_samples ? "Mann-Whitney U on raw samples" : "bootstrap CI of the median",
+           cfg->threshold * 100.0, cfg->alpha);
+    printf("%s\n\n", base.has_seeds ? "Inputs regenerated from the baseline's seeds"
+                                     : "No seeds in the baseline: inputs are generated afresh");
+    printf("  %-11s %-11s %8s %12s %12s %9s %21s  %s\n", "Algorithm", "Generator", "n",
+           "Base (ms)", "New (ms)", "Change", base.has_samples ? "p-value" : "CI (ms)", "Verdict");
+    
+    int regressions = 0, improvements = 0, skipped = 0, failed = 0;
+    int *input = NULL, *work = NULL;
+    size_t allocated = 0;
+    
+    for (int i = 0; i < base.count && !failed; i++) {
+        BaselineCell *cell = &base.cells[i];
+        const SortAlgorithm *alg = findSortAlgorithm(cell->algorithm);
+        const InputGenerator *gen = findInputGenerator(cell->generator);
+        if (cfg->only_algo && strcmp(cfg->only_algo, cell->algorithm) != 0) continue;
+        if (!alg || !gen || cell->n == 0) {
+            skipped++;
+            continue;
+        }
+        
+        if (cell->n > allocated) {
+            sortBufferFree(input);
+            sortBufferFree(work);
+            input = (int *)sortBufferAlloc(cell->n * sizeof(int));
+            work = (int *)sortBufferAlloc(cell->n * sizeof(int));
+            allocated = cell->n;
+            if (!input || !work) {
+                failed = 1;
+                break;
+            }
+        }
+        if (cell->has_seed) setInputSeed(cell->seed);
+        gen->generate(input, cell->n);
+        BenchResult res = benchMeasure(alg, gen->name, input, work, cell->n, &cfg->bench);
+        if (!res.samples) {
+            failed = 1;
+            break;
+        }
+        
+        double baseMedian = medianOf(cell->samples, cell->count);
+        double change = res.median_ms / baseMedian - 1.0;
+        int slower = 0, faster = 0;
+        char detail[32];
+        
+        if (base.has_samples && cell->count > 1) {
+            double p = mannWhitneyP(cell->samples, cell->count, res.samples, res.runs);
+            if (p < 0.0) failed = 1;
+            slower = p < cfg->alpha && change > cfg->threshold;
+            faster = p < cfg->alpha && change < -cfg->threshold;
+            snprintf(detail, sizeof(detail), "%.2e", p);
+        } else {
+            double lo = 0.0, hi = 0.0;
+            if (bootstrapMedianCI(res.samples, res.runs, 1.0 - cfg->alpha, &lo, &hi) != 0) failed = 1;
+            slower = lo > baseMedian * (1.0 + cfg->threshold);
+            faster = hi < baseMedian * (1.0 - cfg->threshold);
+            snprintf(detail, sizeof(detail), "[%.4f, %.4f]", lo, hi);
+        }
+        if (failed) {
+            benchFreeResults(&res, 1);
+            break;
+        }
+        
+        if (slower) regressions++;
+        if (faster) improvements++;
+        printf("  %-11s %-11s %8zu %12.4f %12.4f %+8.1f%% %21s  %s\n",
+               cell->algorithm, cell->generator, cell->n, baseMedian, res.median_ms,
+               change * 100.0, detail,
+               slower ? "REGRESSION" : faster ? "improved" : "same");
+        fflush(stdout);
+        benchFreeResults(&res, 1);
+    }
+    
+    sortBufferFree(input);
+    sortBufferFree(work);
+    freeBaseline(&base);
+    if (failed) return -2;
+    
+    printf("\n%d regression(s), %d improvement(s)", regressions, improvements);
+    if (skipped) printf(", %d cell(s) skipped (unknown algorithm or generator)", skipped);
+    printf("\n");
+    return regressions;
+}
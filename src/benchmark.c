@@ -0,0 +1,461 @@
+/*
+ * Benchmark Harness
+ *
+ * Measures every algorithm with a monotonic clock instead of clock():
+ *   1. The process is pinned to one CPU so migrations do not add noise
+ *   2. A few untimed warm-up runs fill caches and fault in the pages
+ *   3. The sort is repeated on a fresh copy of the same input until enough
+ *      time has been measured (adaptive repetition count), so fast sorts on
+ *      small inputs get hundreds of samples and slow ones only a few
+ *   4. min / median / p90 / mean / stddev summarize the samples
+ *
+ * Only the sort itself is timed: copying the input back before each run is
+ * outside the measured interval.
+ *
+ * benchMatrix() sweeps algorithms x generators x sizes in-process. Each input
+ * is generated once and shared by all algorithms, and an algorithm drops out
+ * of a generator's sweep once it hits its size cap or the time budget.
+ */
+
+#define _GNU_SOURCE
+#include <sched.h>
+#include <math.h>
+#include "../include/sorting.h"
+
+// ============================================================
+// UNIFORM (arr, n) ENTRY POINTS
+// ============================================================
+
+static void quickSortAll(int arr[], size_t n) {
+    quickSort(arr, 0, (ptrdiff_t)n - 1);
+}
+
+static void quickSort3WayAll(int arr[], size_t n) {
+    quickSort3Way(arr, 0, (ptrdiff_t)n - 1);
+}
+
+static void autoSortAll(int arr[], size_t n) {
+    sortAuto(arr, n, NULL);
+}
+
+static void countingSortAll(int arr[], size_t n) {
+    // Key ranges past the engine's limit go to radix sort instead
+    if (countingSortParallel(arr, n) != 0) radixSortLSD(arr, n);
+}
+
+static void simdSortAll(int arr[], size_t n) {
+    simdSort32((int32_t *)arr, n);
+}
+
+static void mergeSortAll(int arr[], size_t n) {
+    parallelMergeSort(arr, n);
+}
+
+static int maxValue(const int arr[], size_t n) {
+    int maxVal = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (arr[i] > maxVal) maxVal = arr[i];
+    }
+    return maxVal;
+}
+
+// Radix Sort processes as many decimal digits as the largest value has
+static void radixSortAll(int arr[], size_t n) {
+    int digits = 1;
+    for (int v = maxValue(arr, n); v >= 10; v /= 10) digits++;
+    radixSort(arr, n, digits);
+}
+
+static void bucketSortAll(int arr[], size_t n) {
+    bucketSortInt(arr, n, maxValue(arr, n));
+}
+
+// max_n caps the quadratic sorts: beyond it a single run takes minutes
+const SortAlgorithm sort_algorithms[] = {
+    {"bubble",     bubbleSort,    100000},
+    {"bubble_opt", bubbleSortOpt, 100000},
+    {"gnome",      gnomeSort,     100000},
+    {"radix",      radixSortAll,  0},
+    {"radix_lsd",  radixSortLSD,  0},
+    {"quick",      quickSortAll,  0},
+    {"heap",       heapSort,      0},
+    {"bucket",     bucketSortAll, 0},
+    {"merge",      mergeSortAll,  0},
+    {"simd",       simdSortAll,   0},
+    {"quick3",     quickSort3WayAll, 0},
+    {"timsort",    timSort,       0},
+    {"auto",       autoSortAll,   0},
+    {"counting",   countingSortAll, 0},
+    {"odd_even",   oddEvenSort,   100000},
+    {"odd_even_par", parallelOddEvenSort, 0},
+};
+const int sort_algorithm_count = sizeof(sort_algorithms) / sizeof(sort_algorithms[0]);
+
+// String engines, for the newline-delimited file mode and `sort_test strings`
+const StringSortAlgorithm string_algorithms[] = {
+    {"multikey", stringSortMultikey},
+    {"msd",      stringSortMSD},
+    {"qsort",    stringSortQsort},
+};
+const int string_algorithm_count = sizeof(string_algorithms) / sizeof(string_algorithms[0]);
+
+// ============================================================
+// INPUT GENERATORS
+// ============================================================
+
+// The five shapes of runAllTestCases
+static void genRandom(int arr[], size_t n)      { generateRandomArray(arr, n, 10000); }
+static void genSorted(int arr[], size_t n)      { generateSortedArray(arr, n); }
+static void genReverse(int arr[], size_t n)     { generateReverseSortedArray(arr, n); }
+static void genNearly(int arr[], size_t n)      { generateNearlySortedArray(arr, n, n / 20); }
+static void genDuplicates(int arr[], size_t n)  { generateDuplicatesArray(arr, n, 10); }
+// Adversarial and production-like shapes
+static void genZipf(int arr[], size_t n)        { generateZipfArray(arr, n, 10000, 1.1); }
+static void genExponential(int arr[], size_t n) { generateExponentialArray(arr, n, 1000.0); }
+static void genOrganPipe(int arr[], size_t n)   { generateOrganPipeArray(arr, n); }
+static void genSawtooth(int arr[], size_t n)    { generateSawtoothArray(arr, n, 1000); }
+static void genRuns(int arr[], size_t n)        { generateRandomRunsArray(arr, n, 1000, 1000000); }
+static void genAllEqual(int arr[], size_t n)    { generateAllEqualArray(arr, n, 42); }
+static void genWide(int arr[], size_t n)        { generateWideKeysArray(arr, n); }
+static void genAntiQuick(int arr[], size_t n)   { generateAntiQuicksortArray(arr, n); }
+
+const InputGenerator input_generators[] = {
+    {"random",      genRandom},
+    {"sorted",      genSorted},
+    {"reverse",     genReverse},
+    {"nearly",      genNearly},
+    {"duplicates",  genDuplicates},
+    {"zipf",        genZipf},
+    {"exponential", genExponential},
+    {"organ_pipe",  genOrganPipe},
+    {"sawtooth",    genSawtooth},
+    {"runs",        genRuns},
+    {"all_equal",   genAllEqual},
+    {"wide",        genWide},
+    {"antiqsort",   genAntiQuick},
+};
+const int input_generator_count = sizeof(input_generators) / sizeof(input_generators[0]);
+
+const SortAlgorithm *findSortAlgorithm(const char *name) {
+    for (int i = 0; i < sort_algorithm_count; i++) {
+        if (strcmp(sort_algorithms[i].name, name) == 0) return &sort_algorithms[i];
+    }
+    return NULL;
+}
+
+const InputGenerator *findInputGenerator(const char *name) {
+    for (int i = 0; i < input_generator_count; i++) {
+        if (strcmp(input_generators[i].name, name) == 0) return &input_generators[i];
+    }
+    return NULL;
+}
+
+/*
+ * Generate one benchmark input from a seed of its own, drawn from the run's
+ * seed stream. Returns that seed: setInputSeed(seed) before the same
+ * generator call reproduces the input (benchCompare does)
+ */
+uint64_t benchGenerateInput(const InputGenerator *gen, int arr[], size_t n) {
+    uint64_t seed = nextInputSeed();
+    setInputSeed(seed);
+    gen->generate(arr, n);
+    return seed;
+}
+
+const StringSortAlgorithm *findStringSortAlgorithm(const char *name) {
+    for (int i = 0; i < string_algorithm_count; i++) {
+        if (strcmp(string_algorithms[i].name, name) == 0) return &string_algorithms[i];
+    }
+    return NULL;
+}
+
+// ============================================================
+// MEASUREMENT
+// ============================================================
+
+void benchConfigDefaults(BenchConfig *cfg) {
+    cfg->warmup_runs = 2;
+    cfg->min_runs = 5;
+    cfg->max_runs = 1000;
+    cfg->min_time_ms = 200.0;
+    cfg->pin_cpu = -1;
+}
+
+/*
+ * Pin the calling process to one CPU
+ * cpu < 0 pins to the CPU the process is currently running on
+ * Returns the CPU used, or -1 if affinity could not be set
+ */
+int benchPinCpu(int cpu) {
+    if (cpu < 0) cpu = sched_getcpu();
+    if (cpu < 0) return -1;
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) return -1;
+    return cpu;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Linear interpolation between closest ranks (q in [0, 1])
+static double percentile(const double sorted[], int count, double q) {
+    double pos = q * (count - 1);
+    int lo = (int)pos;
+    if (lo >= count - 1) return sorted[count - 1];
+    return sorted[lo] + (pos - lo) * (sorted[lo + 1] - sorted[lo]);
+}
+
+void benchSummarize(BenchResult *res, double samples[], int count) {
+    res->runs = count;
+    if (count <= 0) return;
+    qsort(samples, count, sizeof(double), compareDouble);
+    
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) sum += samples[i];
+    double mean = sum / count;
+    double var = 0.0;
+    for (int i = 0; i < count; i++) var += (samples[i] - mean) * (samples[i] - mean);
+    
+    res->min_ms = samples[0];
+    res->median_ms = percentile(samples, count, 0.5);
+    res->p90_ms = percentile(samples, count, 0.9);
+    res->mean_ms = mean;
+    res->stddev_ms = count > 1 ? sqrt(var / (count - 1)) : 0.0;
+}
+
+/*
+ * Benchmark one algorithm on one input
+ * input is never modified; every run sorts a fresh copy in work
+ * The sorted run times are kept in res.samples (release with benchFreeResults)
+ */
+BenchResult benchMeasure(const SortAlgorithm *alg, const char *generator,
+                         const int input[], int *work, size_t n, const BenchConfig *cfg) {
+    BenchResult res;
+    memset(&res, 0, sizeof(res));
+    res.algorithm = alg->name;
+    res.generator = generator;
+    res.n = n;
+    res.passed = 1;
+    
+    for (int i = 0; i < cfg->warmup_runs; i++) {
+        copyArray((int *)input, work, n);
+        alg->sort(work, n);
+    }
+    
+    // At least one timed run, whatever the configuration says
+    int maxRuns = cfg->max_runs > 1 ? cfg->max_runs : 1;
+    int minRuns = cfg->min_runs < maxRuns ? cfg->min_runs : maxRuns;
+    double *samples = (double *)malloc((size_t)maxRuns * sizeof(double));
+    if (!samples) {
+        res.passed = 0;
+        return res;
+    }
+    int count = 0;
+    double total = 0.0;
+    
+    while (count < maxRuns && (count < minRuns || total < cfg->min_time_ms)) {
+        copyArray((int *)input, work, n);
+        reset_counters();
+        double start = now_ms();
+        alg->sort(work, n);
+        double elapsed = now_ms() - start;
+        
+        samples[count++] = elapsed;
+        total += elapsed;
+        if (memory_peak > res.peak_bytes) res.peak_bytes = memory_peak;
+        if (!isSorted(work, n)) res.passed = 0;
+    }
+    
+    benchSummarize(&res, samples, count);
+    res.samples = samples;
+    return res;
+}
+
+// ============================================================
+// BENCHMARK MATRIX
+// ============================================================
+
+void matrixConfigDefaults(MatrixConfig *cfg) {
+    benchConfigDefaults(&cfg->bench);
+    cfg->bench.warmup_runs = 1;
+    cfg->bench.min_runs = 3;
+    cfg->bench.min_time_ms = 100.0;
+    cfg->min_n = 100;
+    cfg->max_n = 1000000;
+    cfg->budget_ms = 1000.0;
+    cfg->only_algo = NULL;
+    cfg->only_gen = NULL;
+}
+
+// Sizes follow a 1-2-5 sequence: 100, 200, 500, 1000, ...
+static long long nextMatrixSize(long long n) {
+    long long decade = 1;
+    while (decade * 10 <= n) decade *= 10;
+    long long lead = n / decade;
+    if (lead < 2) return 2 * decade;
+    if (lead < 5) return 5 * decade;
+    return 10 * decade;
+}
+
+/*
+ * Predict the median at size n from the last two cells of the same sweep.
+ * The growth exponent is measured rather than assumed, so Quick Sort on
+ * sorted input is recognized as quadratic even though it is O(n log n)
+ * on average.
+ */
+static double predictTime(const double ns[2], const double ms[2], int known, double n) {
+    if (known == 0) return 0.0;
+    double exponent = 1.0;
+    if (known == 2 && ms[0] > 0.01 && ms[1] > ms[0]) {
+        exponent = log(ms[1] / ms[0]) / log(ns[1] / ns[0]);
+        if (exponent < 1.0) exponent = 1.0;
+        if (exponent > 3.0) exponent = 3.0;
+    }
+    return ms[known - 1] * pow(n / ns[known - 1], exponent);
+}
+
+int benchMatrix(const MatrixConfig *cfg, FILE *csv, FILE *samplesCsv,
+                BenchResult **resultsOut, int *countOut) {
+    int capacity = 64;
+    int count = 0;
+    BenchResult *results = (BenchResult *)malloc(capacity * sizeof(BenchResult));
+    int *input = (int *)sortBufferAlloc((size_t)cfg->max_n * sizeof(int));
+    int *work = (int *)sortBufferAlloc((size_t)cfg->max_n * sizeof(int));
+    if (!results || !input || !work) {
+        free(results); sortBufferFree(input); sortBufferFree(work);
+        return -1;
+    }
+    
+    int full = 0;   // The results array could not grow: stop, keep the rest
+    for (int g = 0; g < input_generator_count && !full; g++) {
+        const InputGenerator *gen = &input_generators[g];
+        if (cfg->only_gen && strcmp(cfg->only_gen, gen->name) != 0) continue;
+        
+        // Per-algorithm state for this generator's sweep
+        int retired[sort_algorithm_count];
+        int known[sort_algorithm_count];
+        double lastN[sort_algorithm_count][2];
+        double lastMs[sort_algorithm_count][2];
+        memset(known, 0, sizeof(known));
+        for (int a = 0; a < sort_algorithm_count; a++) {
+            retired[a] = cfg->only_algo && strcmp(cfg->only_algo, sort_algorithms[a].name) != 0;
+        }
+        
+        for (long long n = cfg->min_n; n <= cfg->max_n && !full; n = nextMatrixSize(n)) {
+            int active = 0;
+            for (int a = 0; a < sort_algorithm_count; a++) {
+                if (!retired[a]) active++;
+            }
+            if (active == 0) break;
+            
+            // One input per (generator, n), shared by every algorithm
+            uint64_t inputSeed = benchGenerateInput(gen, input, (size_t)n);
+            
+            for (int a = 0; a < sort_algorithm_count; a++) {
+                const SortAlgorithm *alg = &sort_algorithms[a];
+                if (retired[a]) continue;
+                
+                double predicted = predictTime(lastN[a], lastMs[a], known[a], (double)n);
+                if ((alg->max_n > 0 && n > alg->max_n) || predicted > cfg->budget_ms) {
+                    printf("  %-11s %-11s %11lld  dropped (%s)\n", alg->name, gen->name, n,
+                           predicted > cfg->budget_ms ? "time budget" : "size cap");
+                    retired[a] = 1;
+                    continue;
+                }
+                
+                BenchResult res = benchMeasure(alg, gen->name, input, work, (size_t)n, &cfg->bench);
+                res.input_seed = inputSeed;
+                printf("  %-11s %-11s %11lld %6d %12.4f %12.4f %12.4f %4s\n",
+                       res.algorithm, res.generator, n, res.runs, res.min_ms,
+                       res.median_ms, res.p90_ms, res.passed ? "PASS" : "FAIL");
+                fflush(stdout);
+                if (csv) benchWriteCsvRow(csv, &res);
+                if (samplesCsv) benchWriteSamplesCsvRows(samplesCsv, &res);
+                
+                if (count == capacity) {
+                    BenchResult *grown = (BenchResult *)realloc(results, capacity * 2 * sizeof(BenchResult));
+                    if (!grown) {
+                        // Keep what was measured: the caller reports it
+                        printf("  Out of memory for more results, stopping the matrix\n");
+                        benchFreeResults(&res, 1);
+                        full = 1;
+                        break;
+                    }
+                    results = grown;
+                    capacity *= 2;
+                }
+                results[count++] = res;
+                
+                if (known[a] == 2) {
+                    lastN[a][0] = lastN[a][1];
+                    lastMs[a][0] = lastMs[a][1];
+                    known[a] = 1;
+                }
+                lastN[a][known[a]] = (double)n;
+                lastMs[a][known[a]] = res.median_ms;
+                known[a]++;
+                if (res.median_ms > cfg->budget_ms) retired[a] = 1;
+            }
+        }
+    }
+    
+    sortBufferFree(input);
+    sortBufferFree(work);
+    *resultsOut = results;
+    *countOut = count;
+    return 0;
+}
+
+// ============================================================
+// OUTPUT
+// ============================================================
+
+void benchWriteCsvHeader(FILE *f) {
+    fprintf(f, "algorithm,generator,n,runs,min_ms,median_ms,p90_ms,mean_ms,stddev_ms,peak_bytes,passed,seed\n");
+}
+
+void benchWriteCsvRow(FILE *f, const BenchResult *res) {
+    fprintf(f, "%s,%s,%zu,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%zu,%d,%llu\n",
+            res->algorithm, res->generator, res->n, res->runs,
+            res->min_ms, res->median_ms, res->p90_ms, res->mean_ms, res->stddev_ms,
+            res->peak_bytes, res->passed, (unsigned long long)res->input_seed);
+}
+
+// One row per timed run, the format benchCompare() prefers as a baseline
+void benchWriteSamplesCsvHeader(FILE *f) {
+    fprintf(f, "algorithm,generator,n,sample_ms,seed\n");
+}
+
+void benchWriteSamplesCsvRows(FILE *f, const BenchResult *res) {
+    for (int i = 0; i < res->runs; i++) {
+        fprintf(f, "%s,%s,%zu,%.6f,%llu\n", res->algorithm, res->generator, res->n, res->samples[i],
+                (unsigned long long)res->input_seed);
+    }
+}
+
+void benchFreeResults(BenchResult results[], int count) {
+    for (int i = 0; i < count; i++) {
+        free(results[i].samples);
+        results[i].samples = NULL;
+    }
+}
+
+void benchWriteJson(FILE *f, const BenchResult results[], int count) {
+    fprintf(f, "[\n");
+    for (int i = 0; i < count; i++) {
+        const BenchResult *r = &results[i];
+        fprintf(f, "  {\"algorithm\": \"%s\", \"generator\": \"%s\", \"n\": %zu, \"runs\": %d, "
+                   "\"min_ms\": %.6f, \"median_ms\": %.6f, \"p90_ms\": %.6f, \"mean_ms\": %.6f, "
+                   "\"stddev_ms\": %.6f, \"peak_bytes\": %zu, \"passed\": %s}%s\n",
+                r->algorithm, r->generator, r->n, r->runs,
+                r->min_ms, r->median_ms, r->p90_ms, r->mean_ms, r->stddev_ms,
+                r->peak_bytes, r->passed ? "true" : "false", i + 1 < count ? "," : "");
+    }
+    fprintf(f, "]\n");
+}
@@ -10,9 +10,28 @@
  *   Best Case: O(n) - when array is already sorted
  *   Worst Case: O(n²)
  *   Space: O(1)
+ * 
+ * Odd-Even Transposition Sort (bubble sort without the serial chain):
+ *   Alternates a phase over the pairs (0,1), (2,3), ... with a phase over
+ *   (1,2), (3,4), ...; the pairs of a phase are disjoint, so each phase
+ *   is a single vector min/max pass. Stops after an even and an odd
+ *   phase that changed nothing.
+ *   Best Case: O(n), Worst Case: O(n²) - one phase per position an
+ *   element has to travel
+ *   Space: O(1)
+ * 
+ * Parallel Odd-Even Sort (Baudet-Stevenson block merge-split):
+ *   Blocks of about sqrt(n) keys are sorted in parallel with the phase
+ *   kernel, then neighbouring blocks merge-split (lower half left, upper
+ *   half right) in alternating even/odd rounds, one thread per group of
+ *   pairs. At most one round per block, fewer on nearly sorted input.
+ *   Worst Case: O(n sqrt(n)) work, Space: O(n)
  */
 
 #include "../include/sorting.h"
+#include <immintrin.h>
+
+#define ODD_EVEN_MIN_BLOCK 256   // Smallest block of the parallel variant
 
 // Utility swap function
 void swap(int *a, int *b) {
@@ -26,12 +45,12 @@ void swap(int *a, int *b) {
  * Repeatedly steps through the list, compares adjacent elements
  * and swaps them if they are in the wrong order.
  */
-void bubbleSort(int arr[], int n) {
+void bubbleSort(int arr[], size_t n) {
     int change = 1;
     
     while (change) {
         change = 0;
-        for (int i = 0; i < n - 1; i++) {
+        for (size_t i = 0; i + 1 < n; i++) {
             if (arr[i] > arr[i + 1]) {
                 swap(&arr[i], &arr[i + 1]);
                 change = 1;
@@ -45,13 +64,13 @@ void bubbleSort(int arr[], int n) {
  * After the i-th traversal, the last i elements are in their final places.
  * The traversal can stop one index before the previous one.
  */
-void bubbleSortOpt(int arr[], int n) {
-    int m = n - 1;
+void bubbleSortOpt(int arr[], size_t n) {
+    size_t m = n > 0 ? n - 1 : 0;
     int change = 1;
     
-    while (change) {
+    while (change && m > 0) {
         change = 0;
-        for (int i = 0; i < m; i++) {
+        for (size_t i = 0; i < m; i++) {
             if (arr[i] > arr[i + 1]) {
                 swap(&arr[i], &arr[i + 1]);
                 change = 1;
@@ -64,12 +83,12 @@ void bubbleSortOpt(int arr[], int n) {
 /*
  * Bubble Sort with counters for analysis
  */
-void bubbleSortCounted(int arr[], int n) {
+void bubbleSortCounted(int arr[], size_t n) {
     int change = 1;
     
     while (change) {
         change = 0;
-        for (int i = 0; i < n - 1; i++) {
+        for (size_t i = 0; i + 1 < n; i++) {
             if (compare_counted(arr[i], arr[i + 1])) {
                 swap_counted(&arr[i], &arr[i + 1]);
                 change = 1;
@@ -77,3 +96,197 @@ void bubbleSortCounted(int arr[], int n) {
         }
     }
 }
+
+// ============================================================
+// ODD-EVEN TRANSPOSITION SORT
+// ============================================================
+
+// One phase: compare-exchange the pairs (i, i + 1) for i = start,
+// start + 2, ... below n; returns nonzero if any pair was swapped
+typedef int (*OddEvenPhase)(int a[], size_t start, size_t n);
+
+static int oddEvenPhaseScalar(int a[], size_t start, size_t n) {
+    int changed = 0;
+    for (size_t i = start; i + 1 < n; i += 2) {
+        int x = a[i], y = a[i + 1];
+        changed |= y < x;
+        a[i] = y < x ? y : x;
+        a[i + 1] = y < x ? x : y;
+    }
+    return changed;
+}
+
+/*
+ * Vector phases: a register of keys starting at a pair boundary holds
+ * whole pairs, so swapping neighbouring lanes lines every key up with its
+ * partner; min goes to the even lanes and max to the odd ones
+ */
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+static int oddEvenPhaseAvx2(int a[], size_t start, size_t n) {
+    __m256i diff = _mm256_setzero_si256();
+    size_t i = start;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i y = _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+        __m256i r = _mm256_blend_epi32(_mm256_min_epi32(x, y), _mm256_max_epi32(x, y), 0xAA);
+        diff = _mm256_or_si256(diff, _mm256_xor_si256(r, x));
+        _mm256_storeu_si256((__m256i *)(a + i), r);
+    }
+    int changed = !_mm256_testz_si256(diff, diff);
+    return changed | oddEvenPhaseScalar(a, i, n);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+static int oddEvenPhaseAvx512(int a[], size_t start, size_t n) {
+    __m512i diff = _mm512_setzero_si512();
+    size_t i = start;
+    for (; i + 16 <= n; i += 16) {
+        __m512i x = _mm512_loadu_si512((const void *)(a + i));
+        __m512i y = _mm512_shuffle_epi32(x, _MM_PERM_CDAB);
+        __m512i r = _mm512_mask_blend_epi32(0xAAAA, _mm512_min_epi32(x, y), _mm512_max_epi32(x, y));
+        diff = _mm512_or_si512(diff, _mm512_xor_si512(r, x));
+        _mm512_storeu_si512((void *)(a + i), r);
+    }
+    int changed = _mm512_test_epi32_mask(diff, diff) != 0;
+    return changed | oddEvenPhaseScalar(a, i, n);
+}
+
+#pragma GCC pop_options
+
+// Widest phase kernel the CPU runs (follows SORT_ISA, see simd_sort.c)
+static OddEvenPhase oddEvenKernel(void) {
+    const char *isa = simdSortIsa();
+    if (strcmp(isa, "avx512") == 0) return oddEvenPhaseAvx512;
+    if (strcmp(isa, "avx2") == 0) return oddEvenPhaseAvx2;
+    return oddEvenPhaseScalar;
+}
+
+static void oddEvenRun(OddEvenPhase phase, int arr[], size_t n) {
+    int changed;
+    do {
+        changed = phase(arr, 0, n);
+        changed |= phase(arr, 1, n);
+    } while (changed);
+}
+
+/*
+ * Odd-Even Transposition Sort
+ * Vectorized phases on the calling thread
+ */
+void oddEvenSort(int arr[], size_t n) {
+    oddEvenRun(oddEvenKernel(), arr, n);
+}
+
+typedef struct {
+    int *arr;
+    int *scratch;
+    size_t n;
+    size_t block;
+    size_t first;          // Left block of the round's first pair (0 or 1)
+    OddEvenPhase phase;
+    int *changed;          // One flag per worker
+} OddEvenJob;
+
+static void oddEvenBlockBody(size_t begin, size_t end, int worker, void *ctx) {
+    OddEvenJob *job = (OddEvenJob *)ctx;
+    (void)worker;
+    for (size_t b = begin; b < end; b++) {
+        size_t lo = b * job->block;
+        size_t len = job->n - lo < job->block ? job->n - lo : job->block;
+        oddEvenRun(job->phase, job->arr + lo, len);
+    }
+}
+
+/*
+ * Merge-split of the sorted neighbours a[0..nl) and a[nl..nl+nr): the
+ * smallest nl keys end up on the left. Only the overlap is merged: the
+ * left prefix not above a[nl] and the right suffix not below a[nl-1]
+ * are already in place.
+ */
+static void mergeSplit(int a[], size_t nl, size_t nr, int scratch[]) {
+    int *right = a + nl;
+    size_t lo = 0, hi = nl;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (a[mid] <= right[0]) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t s = lo;
+    lo = 0;
+    hi = nr;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (right[mid] < a[nl - 1]) lo = mid + 1;
+        else hi = mid;
+    }
+    size_t e = lo;
+    
+    size_t i = s, j = 0, k = 0;
+    while (i < nl && j < e) scratch[k++] = right[j] < a[i] ? right[j++] : a[i++];
+    while (i < nl) scratch[k++] = a[i++];
+    while (j < e) scratch[k++] = right[j++];
+    memcpy(a + s, scratch, k * sizeof(int));
+}
+
+static void oddEvenMergeBody(size_t begin, size_t end, int worker, void *ctx) {
+    OddEvenJob *job = (OddEvenJob *)ctx;
+    for (size_t p = begin; p < end; p++) {
+        size_t lo = (job->first + 2 * p) * job->block;
+        size_t mid = lo + job->block;
+        size_t hi = job->n - mid < job->block ? job->n : mid + job->block;
+        if (job->arr[mid - 1] <= job->arr[mid]) continue;
+        mergeSplit(job->arr + lo, mid - lo, hi - mid, job->scratch + lo);
+        job->changed[worker] = 1;
+    }
+}
+
+/*
+ * Parallel Odd-Even Sort
+ * Falls back to oddEvenSort for small arrays or when memory runs out
+ */
+void parallelOddEvenSort(int arr[], size_t n) {
+    size_t block = ODD_EVEN_MIN_BLOCK;
+    while (block * block < n) block *= 2;
+    size_t blocks = (n + block - 1) / block;
+    if (blocks < 2) {
+        oddEvenSort(arr, n);
+        return;
+    }
+    
+    int workers = sortThreadCount();
+    OddEvenJob job = {arr, (int *)sort_malloc(n * sizeof(int)), n, block, 0, oddEvenKernel(),
+                      (int *)sort_calloc((size_t)workers, sizeof(int))};
+    if (!job.scratch || !job.changed) {
+        sort_free(job.scratch);
+        sort_free(job.changed);
+        oddEvenSort(arr, n);
+        return;
+    }
+    
+    size_t grain = sortTuning()->parallel_grain;
+    size_t blockGrain = grain / block > 0 ? grain / block : 1;
+    size_t pairGrain = grain / (2 * block) > 0 ? grain / (2 * block) : 1;
+    parallelFor(blocks, blockGrain, oddEvenBlockBody, &job);
+    
+    // Blocks rounds always suffice; two quiet rounds in a row (one even,
+    // one odd) mean every boundary is already in order
+    int quiet = 0;
+    for (size_t round = 0; round < blocks && quiet < 2; round++) {
+        job.first = round % 2;
+        memset(job.changed, 0, (size_t)workers * sizeof(int));
+        parallelFor((blocks - job.first) / 2, pairGrain, oddEvenMergeBody, &job);
+        
+        int changed = 0;
+        for (int w = 0; w < workers; w++) changed |= job.changed[w];
+        quiet = changed ? 0 : quiet + 1;
+    }
+    
+    sort_free(job.changed);
+    sort_free(job.scratch);
+}
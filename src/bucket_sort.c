@@ -17,16 +17,17 @@
 #include "../include/sorting.h"
 
 // Node structure for linked list bucket
+// (double holds every int exactly, so bucketSortInt loses no precision)
 typedef struct Node {
-    float value;
+    double value;
     struct Node *next;
 } Node;
 
 /*
  * Create a new node
  */
-Node* createNode(float value) {
-    Node *newNode = (Node *)malloc(sizeof(Node));
+Node* createNode(double value) {
+    Node *newNode = (Node *)sort_malloc(sizeof(Node));
     newNode->value = value;
     newNode->next = NULL;
     return newNode;
@@ -35,7 +36,7 @@ Node* createNode(float value) {
 /*
  * Insert node in sorted order (insertion sort within bucket)
  */
-Node* insertSorted(Node *head, float value) {
+Node* insertSorted(Node *head, double value) {
     Node *newNode = createNode(value);
     
     // If list is empty or new value should be first
@@ -59,63 +60,69 @@ Node* insertSorted(Node *head, float value) {
 /*
  * Bucket Sort for floating point numbers in [0, 1)
  */
-void bucketSort(float arr[], int n) {
+void bucketSort(float arr[], size_t n) {
     // Create n empty buckets
-    Node **buckets = (Node **)calloc(n, sizeof(Node *));
+    Node **buckets = (Node **)sort_calloc(n, sizeof(Node *));
     
     // Put elements into respective buckets
-    for (int i = 0; i < n; i++) {
-        int bucketIndex = (int)(n * arr[i]);
+    for (size_t i = 0; i < n; i++) {
+        size_t bucketIndex = (size_t)((double)n * arr[i]);
         // Handle edge case where arr[i] == 1.0
         if (bucketIndex >= n) bucketIndex = n - 1;
         buckets[bucketIndex] = insertSorted(buckets[bucketIndex], arr[i]);
     }
     
     // Concatenate all buckets into arr
-    int index = 0;
-    for (int i = 0; i < n; i++) {
+    size_t index = 0;
+    for (size_t i = 0; i < n; i++) {
         Node *current = buckets[i];
         while (current != NULL) {
             arr[index++] = current->value;
             Node *temp = current;
             current = current->next;
-            free(temp);
+            sort_free(temp);
         }
     }
     
-    free(buckets);
+    sort_free(buckets);
 }
 
 /*
  * Bucket Sort for integers
  * Normalizes integers to [0, 1) range and uses the same algorithm
  */
-void bucketSortInt(int arr[], int n, int maxVal) {
-    if (n <= 0 || maxVal <= 0) return;
+void bucketSortInt(int arr[], size_t n, int maxVal) {
+    if (n == 0 || maxVal <= 0) return;
     
     // Create n empty buckets
-    Node **buckets = (Node **)calloc(n, sizeof(Node *));
+    Node **buckets = (Node **)sort_calloc(n, sizeof(Node *));
     
     // Put elements into respective buckets
-    for (int i = 0; i < n; i++) {
-        // Normalize to [0, n) range
-        int bucketIndex = (int)((long long)arr[i] * n / (maxVal + 1));
+    for (size_t i = 0; i < n; i++) {
+        // Normalize to [0, n) range; arr[i] * n can exceed 64 bits once n
+        // passes 2^32, so scale in double (exact enough to pick a bucket)
+        size_t bucketIndex = arr[i] <= 0 ? 0
+                           : (size_t)((double)arr[i] * (double)n / (maxVal + 1.0));
         if (bucketIndex >= n) bucketIndex = n - 1;
-        if (bucketIndex < 0) bucketIndex = 0;
-        buckets[bucketIndex] = insertSorted(buckets[bucketIndex], (float)arr[i]);
+        buckets[bucketIndex] = insertSorted(buckets[bucketIndex], arr[i]);
     }
     
     // Concatenate all buckets into arr
-    int index = 0;
-    for (int i = 0; i < n; i++) {
+    TRACE_BUCKET_RUN();
+    size_t index = 0;
+    for (size_t i = 0; i < n; i++) {
         Node *current = buckets[i];
+#ifdef SORT_TRACE
+        size_t start = index;
+#endif
         while (current != NULL) {
             arr[index++] = (int)current->value;
             Node *temp = current;
             current = current->next;
-            free(temp);
+            sort_free(temp);
         }
+        TRACE_BUCKET_OCCUPANCY((long long)(index - start));
     }
     
-    free(buckets);
+    sort_free(buckets);
 }
@@ -0,0 +1,252 @@
+/*
+ * Adversarial and Realistic Input Distributions
+ *
+ * Extra input shapes for the benchmark suite, beyond the five basic cases:
+ *   - Zipf / exponential skew: a few keys dominate (production-like)
+ *   - Organ pipe (0 1 2 .. k .. 2 1 0) and sawtooth (repeated ascending
+ *     ramps): structured inputs that break naive pivot choices
+ *   - Runs of random lengths: concatenated sorted runs (log-merged data)
+ *   - All equal: a single key
+ *   - Wide keys: the full non-negative int range, and full 64-bit keys
+ *   - Anti-quicksort: McIlroy's adversary, which builds a worst case for
+ *     whatever comparison-based quicksort it is run against
+ *
+ * Random shapes use the seeded streams of random.c.
+ */
+
+#include <math.h>
+#include <limits.h>
+#include "../include/sorting.h"
+
+// ============================================================
+// SKEWED DISTRIBUTIONS
+// ============================================================
+
+typedef struct {
+    int *arr;
+    const double *cdf;   // cdf[k] = P(key <= k)
+    int numKeys;
+} ZipfFill;
+
+static void fillZipf(SortRng *rng, size_t begin, size_t end, void *ctx) {
+    ZipfFill *z = (ZipfFill *)ctx;
+    for (size_t i = begin; i < end; i++) {
+        double u = rngUniform(rng);
+        // Smallest key whose cumulative probability exceeds u
+        int lo = 0, hi = z->numKeys - 1;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            if (z->cdf[mid] > u) hi = mid;
+            else lo = mid + 1;
+        }
+        z->arr[i] = lo;
+    }
+}
+
+/*
+ * Zipf distribution over keys 0..numKeys-1: P(k) proportional to 1/(k+1)^s
+ * Key 0 is the most frequent
+ */
+void generateZipfArray(int arr[], size_t n, int numKeys, double s) {
+    if (numKeys <= 0) numKeys = 1;
+    double *cdf = (double *)malloc((size_t)numKeys * sizeof(double));
+    double sum = 0.0;
+    for (int k = 0; k < numKeys; k++) {
+        sum += 1.0 / pow(k + 1, s);
+        cdf[k] = sum;
+    }
+    for (int k = 0; k < numKeys; k++) cdf[k] /= sum;
+    
+    ZipfFill z = {arr, cdf, numKeys};
+    parallelFillStreams(n, nextInputSeed(), fillZipf, &z);
+    free(cdf);
+}
+
+typedef struct {
+    int *arr;
+    double mean;
+} ExponentialFill;
+
+static void fillExponential(SortRng *rng, size_t begin, size_t end, void *ctx) {
+    ExponentialFill *e = (ExponentialFill *)ctx;
+    for (size_t i = begin; i < end; i++) {
+        double v = -e->mean * log(1.0 - rngUniform(rng));
+        e->arr[i] = v >= INT_MAX ? INT_MAX : (int)v;
+    }
+}
+
+// Exponentially distributed non-negative values with the given mean
+void generateExponentialArray(int arr[], size_t n, double mean) {
+    ExponentialFill e = {arr, mean};
+    parallelFillStreams(n, nextInputSeed(), fillExponential, &e);
+}
+
+// ============================================================
+// STRUCTURED DISTRIBUTIONS
+// ============================================================
+
+// 0 1 2 ... peak ... 2 1 0
+void generateOrganPipeArray(int arr[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = sequenceKey(i < n - i ? i : n - 1 - i, n);
+    }
+}
+
+// Repeated ascending ramps 0..period-1
+void generateSawtoothArray(int arr[], size_t n, int period) {
+    if (period <= 0) period = 1;
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = (int)(i % (size_t)period);
+    }
+}
+
+/*
+ * Ascending runs of random lengths (1..maxRunLength), each starting at a
+ * random value below maxVal, like the concatenation of sorted log segments
+ */
+void generateRandomRunsArray(int arr[], size_t n, int maxRunLength, int maxVal) {
+    SortRng rng;
+    rngSeed(&rng, nextInputSeed());
+    size_t i = 0;
+    while (i < n) {
+        size_t len = 1 + (size_t)rngBounded(&rng, maxRunLength);
+        if (len > n - i) len = n - i;
+        int value = (int)rngBounded(&rng, maxVal);
+        for (size_t j = 0; j < len; j++) {
+            arr[i + j] = value;
+            if (value < maxVal - 1) value += (int)rngBounded(&rng, 3);
+        }
+        i += len;
+    }
+}
+
+void generateAllEqualArray(int arr[], size_t n, int value) {
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = value;
+    }
+}
+
+// Uniform over the full non-negative int range (10 decimal digits)
+void generateWideKeysArray(int arr[], size_t n) {
+    fillRandomRange(arr, n, 0, INT_MAX, nextInputSeed());
+}
+
+// Uniform over the full signed 64-bit range
+void generateWideKeys64(int64_t arr[], size_t n) {
+    fillRandomRange64(arr, n, INT64_MIN, INT64_MAX, nextInputSeed());
+}
+
+// ============================================================
+// MCILROY'S ANTI-QUICKSORT ADVERSARY
+// ============================================================
+
+/*
+ * "A Killer Adversary for Quicksort" (McIlroy, 1999)
+ * The target sorts an array of indices through cmp. Every item starts as
+ * "gas" (value not decided yet). Whenever two gas items are compared, one
+ * of them is frozen to the next smallest solid value, choosing the item
+ * that looks like the pivot candidate. The values the sort observed are
+ * then a consistent input on which it does its worst-case work.
+ *
+ * The comparator is not reentrant: run one adversary at a time.
+ */
+static int *adv_val;
+static int adv_gas;
+static int adv_nsolid;
+static int adv_candidate;
+
+static int adversaryCompare(const void *px, const void *py) {
+    int x = *(const int *)px;
+    int y = *(const int *)py;
+    
+    if (adv_val[x] == adv_gas && adv_val[y] == adv_gas) {
+        if (x == adv_candidate) adv_val[x] = adv_nsolid++;
+        else adv_val[y] = adv_nsolid++;
+    }
+    if (adv_val[x] == adv_gas) adv_candidate = x;
+    else if (adv_val[y] == adv_gas) adv_candidate = y;
+    
+    return (adv_val[x] > adv_val[y]) - (adv_val[x] < adv_val[y]);
+}
+
+/*
+ * Build in arr the worst-case input for sorter, which must sort n ints
+ * (item indices) through the qsort-style comparator it is given.
+ * Items are int indices, so n is capped at INT_MAX; the target's
+ * quadratic work makes anything near that size impractical anyway.
+ */
+void antiqsort(int arr[], size_t n, ComparatorSort sorter) {
+    if (n > (size_t)INT_MAX) n = INT_MAX;
+    int *items = (int *)malloc(n * sizeof(int));
+    if (!items) {
+        // No room to run the adversary: ascending order is the fallback
+        for (size_t i = 0; i < n; i++) arr[i] = (int)i;
+        return;
+    }
+    adv_val = arr;
+    adv_gas = (int)n - 1;
+    adv_nsolid = 0;
+    adv_candidate = 0;
+    for (int i = 0; i < (int)n; i++) {
+        items[i] = i;
+        adv_val[i] = adv_gas;
+    }
+    
+    sorter(items, n, sizeof(int), adversaryCompare);
+    free(items);
+    adv_val = NULL;
+}
+
+/*
+ * Comparator-driven mirror of quickSort()/partition(): Lomuto scheme with
+ * the last element as pivot, so the adversary can watch its comparisons
+ */
+static void lomutoQuickSortCmp(int *items, ptrdiff_t p, ptrdiff_t r, int (*cmp)(const void *, const void *)) {
+    while (p < r) {
+        ptrdiff_t i = p - 1;
+        for (ptrdiff_t j = p; j < r; j++) {
+            if (cmp(&items[j], &items[r]) <= 0) {
+                i++;
+                int t = items[i]; items[i] = items[j]; items[j] = t;
+            }
+        }
+        int t = items[i + 1]; items[i + 1] = items[r]; items[r] = t;
+        ptrdiff_t q = i + 1;
+        // Recurse on the smaller side so deep worst cases do not blow the stack
+        if (q - p < r - q) {
+            lomutoQuickSortCmp(items, p, q - 1, cmp);
+            p = q + 1;
+        } else {
+            lomutoQuickSortCmp(items, q + 1, r, cmp);
+            r = q - 1;
+        }
+    }
+}
+
+void quickSortComparator(void *base, size_t n, size_t size, int (*cmp)(const void *, const void *)) {
+    (void)size;
+    lomutoQuickSortCmp((int *)base, 0, (ptrdiff_t)n - 1, cmp);
+}
+
+/*
+ * Worst case for the repository's quickSort(). Running the adversary costs
+ * as much as the quadratic sort it defeats (about 20 s at n = 1e5), so it
+ * only runs up to ANTIQSORT_ADVERSARY_MAX. Against this Lomuto/last-pivot
+ * quicksort its answer always has the same shape,
+ *   0, 2, 3, ..., n-3, n-1, n-2, 1   (n >= 4)
+ * so larger inputs are built from that shape directly, in O(n).
+ */
+#define ANTIQSORT_ADVERSARY_MAX 4096
+
+void generateAntiQuicksortArray(int arr[], size_t n) {
+    if (n <= ANTIQSORT_ADVERSARY_MAX) {
+        antiqsort(arr, n, quickSortComparator);
+        return;
+    }
+    if (n > (size_t)INT_MAX) n = INT_MAX;
+    arr[0] = 0;
+    for (size_t i = 1; i < n - 3; i++) arr[i] = (int)i + 1;
+    arr[n - 3] = (int)n - 1;
+    arr[n - 2] = (int)n - 2;
+    arr[n - 1] = 1;
+}
@@ -0,0 +1,435 @@
+/*
+ * External Merge Sort
+ *
+ * Sorts a file of raw int32 values (host byte order, little-endian on x86)
+ * that can be much larger than RAM:
+ *
+ * 1. Run generation: read the input in chunks that fit the memory budget,
+ *    sort each chunk in memory with the binary LSD radix sort, and spill
+ *    it to a temporary run file
+ * 2. Merge: k-way merge the sorted runs with a loser tree. If
+ *    there are more runs than buffers fit in memory, intermediate passes
+ *    merge groups of runs until one final pass can produce the output
+ *
+ * All file transfers go through a background I/O thread and every stream
+ * is double-buffered: while the CPU sorts or merges one buffer, the I/O
+ * thread fills or drains the other one.
+ *
+ * Complexity: O(n log k) comparisons for the merge, 2 × (1 + passes) × n
+ * elements of I/O.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include <limits.h>
+#include <sys/resource.h>
+#include "../include/sorting.h"
+
+#define MIN_MERGE_BUFFER (64 * 1024)   // Elements per merge buffer, at least
+#define RESERVED_FDS 8                 // stdio, the output files and some slack
+
+void externalSortConfigDefaults(ExternalSortConfig *cfg) {
+    const char *tmp = getenv("TMPDIR");
+    cfg->memory_bytes = (size_t)256 << 20;
+    cfg->temp_dir = tmp ? tmp : "/tmp";
+}
+
+// ============================================================
+// BACKGROUND I/O THREAD
+// ============================================================
+
+typedef struct IoRequest {
+    FILE *file;
+    void *buffer;
+    size_t bytes;          // Requested
+    size_t done_bytes;     // Actually transferred
+    int is_write;
+    int close_after;       // fclose(file) once the transfer is done
+    int pending;           // Submitted and not waited for yet
+    int done;
+    int error;
+    struct IoRequest *next;
+} IoRequest;
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    IoRequest *head;
+    IoRequest *tail;
+    int stop;
+} IoThread;
+
+// Requests are served strictly in submission order
+static void *ioThreadMain(void *arg) {
+    IoThread *io = (IoThread *)arg;
+    for (;;) {
+        pthread_mutex_lock(&io->lock);
+        while (!io->head && !io->stop) pthread_cond_wait(&io->cond, &io->lock);
+        if (!io->head) {
+            pthread_mutex_unlock(&io->lock);
+            return NULL;
+        }
+        IoRequest *req = io->head;
+        io->head = req->next;
+        if (!io->head) io->tail = NULL;
+        pthread_mutex_unlock(&io->lock);
+        
+        if (req->is_write) {
+            req->done_bytes = fwrite(req->buffer, 1, req->bytes, req->file);
+            req->error = req->done_bytes != req->bytes;
+        } else {
+            req->done_bytes = fread(req->buffer, 1, req->bytes, req->file);
+            req->error = ferror(req->file) != 0;
+        }
+        if (req->close_after && fclose(req->file) != 0) req->error = 1;
+        
+        pthread_mutex_lock(&io->lock);
+        req->done = 1;
+        pthread_cond_broadcast(&io->cond);
+        pthread_mutex_unlock(&io->lock);
+    }
+}
+
+static int ioStart(IoThread *io) {
+    memset(io, 0, sizeof(*io));
+    pthread_mutex_init(&io->lock, NULL);
+    pthread_cond_init(&io->cond, NULL);
+    return pthread_create(&io->thread, NULL, ioThreadMain, io) == 0 ? 0 : -1;
+}
+
+static void ioStop(IoThread *io) {
+    pthread_mutex_lock(&io->lock);
+    io->stop = 1;
+    pthread_cond_broadcast(&io->cond);
+    pthread_mutex_unlock(&io->lock);
+    pthread_join(io->thread, NULL);
+    pthread_cond_destroy(&io->cond);
+    pthread_mutex_destroy(&io->lock);
+}
+
+static void ioSubmit(IoThread *io, IoRequest *req, FILE *file, void *buffer,
+                     size_t bytes, int isWrite, int closeAfter) {
+    req->file = file;
+    req->buffer = buffer;
+    req->bytes = bytes;
+    req->done_bytes = 0;
+    req->is_write = isWrite;
+    req->close_after = closeAfter;
+    req->pending = 1;
+    req->done = 0;
+    req->error = 0;
+    req->next = NULL;
+    
+    pthread_mutex_lock(&io->lock);
+    if (io->tail) io->tail->next = req;
+    else io->head = req;
+    io->tail = req;
+    pthread_cond_signal(&io->cond);
+    pthread_mutex_unlock(&io->lock);
+}
+
+// Wait for a request (no-op if it is not pending); returns its error flag
+static int ioWait(IoThread *io, IoRequest *req) {
+    if (!req->pending) return 0;
+    pthread_mutex_lock(&io->lock);
+    while (!req->done) pthread_cond_wait(&io->cond, &io->lock);
+    pthread_mutex_unlock(&io->lock);
+    req->pending = 0;
+    return req->error;
+}
+
+// ============================================================
+// RUN FILES
+// ============================================================
+
+typedef struct {
+    char **paths;
+    int count;
+    int capacity;
+} RunList;
+
+// Name the next run file of a pass; returns NULL if memory runs out
+static char *addRunPath(RunList *runs, const char *dir, int pass) {
+    if (runs->count == runs->capacity) {
+        int capacity = runs->capacity ? runs->capacity * 2 : 16;
+        char **grown = (char **)realloc(runs->paths, capacity * sizeof(char *));
+        if (!grown) return NULL;
+        runs->paths = grown;
+        runs->capacity = capacity;
+    }
+    size_t len = strlen(dir) + 64;
+    char *path = (char *)malloc(len);
+    if (!path) return NULL;
+    snprintf(path, len, "%s/extsort_%ld_%d_%d.run", dir, (long)getpid(), pass, runs->count);
+    runs->paths[runs->count++] = path;
+    return path;
+}
+
+static void freeRuns(RunList *runs, int removeFiles) {
+    for (int i = 0; i < runs->count; i++) {
+        if (removeFiles) unlink(runs->paths[i]);
+        free(runs->paths[i]);
+    }
+    free(runs->paths);
+    memset(runs, 0, sizeof(*runs));
+}
+
+/*
+ * Phase 1: cut the input into sorted runs
+ * Three rotating chunk buffers let the next chunk be read and the previous
+ * run be written while the current chunk is sorted
+ */
+static int generateRuns(IoThread *io, FILE *in, const ExternalSortConfig *cfg,
+                        RunList *runs, ExternalSortStats *stats) {
+    size_t chunk = cfg->memory_bytes / (4 * sizeof(int));   // 3 buffers + scratch
+    if (chunk < 1024) chunk = 1024;
+    
+    int *buf[3], *scratch = (int *)malloc(chunk * sizeof(int));
+    IoRequest readReq[3], writeReq[3];
+    memset(readReq, 0, sizeof(readReq));
+    memset(writeReq, 0, sizeof(writeReq));
+    for (int i = 0; i < 3; i++) buf[i] = (int *)malloc(chunk * sizeof(int));
+    if (!buf[0] || !buf[1] || !buf[2] || !scratch) {
+        for (int i = 0; i < 3; i++) free(buf[i]);
+        free(scratch);
+        return -1;
+    }
+    
+    int status = 0;
+    ioSubmit(io, &readReq[0], in, buf[0], chunk * sizeof(int), 0, 0);
+    for (int k = 0; ; k++) {
+        int b = k % 3, next = (k + 1) % 3;
+        if (ioWait(io, &readReq[b]) || readReq[b].done_bytes % sizeof(int) != 0) {
+            status = -1;
+            break;
+        }
+        size_t n = readReq[b].done_bytes / sizeof(int);
+        if (n == 0) break;
+        
+        // Read ahead into the buffer whose run write (chunk k-2) must finish first
+        if (ioWait(io, &writeReq[next])) {
+            status = -1;
+            break;
+        }
+        ioSubmit(io, &readReq[next], in, buf[next], chunk * sizeof(int), 0, 0);
+        
+        radixSortLSDBuffered(buf[b], scratch, n);
+        
+        const char *runPath = addRunPath(runs, cfg->temp_dir, 0);
+        FILE *run = runPath ? fopen(runPath, "wb") : NULL;
+        if (!run) {
+            status = -1;
+            break;
+        }
+        ioSubmit(io, &writeReq[b], run, buf[b], n * sizeof(int), 1, 1);
+        stats->elements += n;
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        if (ioWait(io, &readReq[i]) || ioWait(io, &writeReq[i])) status = -1;
+        free(buf[i]);
+    }
+    free(scratch);
+    stats->runs = runs->count;
+    return status;
+}
+
+// ============================================================
+// K-WAY MERGE
+// ============================================================
+
+typedef struct {
+    FILE *file;
+    int *buf[2];
+    IoRequest req[2];
+    int cur;          // Buffer being consumed
+    size_t pos;
+    size_t len;
+} RunReader;
+
+typedef struct {
+    FILE *file;
+    int *buf[2];
+    IoRequest req[2];
+    int cur;          // Buffer being filled
+    size_t len;
+    size_t capacity;
+} RunWriter;
+
+// Move to the other buffer and queue a refill of the drained one
+static int readerAdvanceBuffer(IoThread *io, RunReader *r, size_t capacity) {
+    int drained = r->cur;
+    r->cur ^= 1;
+    if (ioWait(io, &r->req[r->cur])) return -1;
+    r->len = r->req[r->cur].done_bytes / sizeof(int);
+    r->pos = 0;
+    if (r->len > 0) {
+        ioSubmit(io, &r->req[drained], r->file, r->buf[drained], capacity * sizeof(int), 0, 0);
+    }
+    return 0;
+}
+
+static int writerFlush(IoThread *io, RunWriter *w) {
+    if (w->len == 0) return 0;
+    ioSubmit(io, &w->req[w->cur], w->file, w->buf[w->cur], w->len * sizeof(int), 1, 0);
+    w->cur ^= 1;
+    w->len = 0;
+    return ioWait(io, &w->req[w->cur]);   // The other buffer must be free again
+}
+
+/*
+ * Merge k run files into out with a loser tree over the run heads
+ * Each run and the output get two buffers of bufElems ints
+ */
+static int mergeRunFiles(IoThread *io, char *paths[], int k, FILE *out, size_t bufElems) {
+    RunReader *readers = (RunReader *)calloc(k, sizeof(RunReader));
+    int *heads = (int *)calloc(k, sizeof(int));
+    int *empty = (int *)calloc(k, sizeof(int));
+    RunWriter w;
+    memset(&w, 0, sizeof(w));
+    w.file = out;
+    w.capacity = bufElems;
+    w.buf[0] = (int *)malloc(bufElems * sizeof(int));
+    w.buf[1] = (int *)malloc(bufElems * sizeof(int));
+    int status = (readers && heads && empty && w.buf[0] && w.buf[1]) ? 0 : -1;
+    
+    for (int i = 0; i < k && status == 0; i++) {
+        RunReader *r = &readers[i];
+        r->file = fopen(paths[i], "rb");
+        r->buf[0] = (int *)malloc(bufElems * sizeof(int));
+        r->buf[1] = (int *)malloc(bufElems * sizeof(int));
+        if (!r->file || !r->buf[0] || !r->buf[1]) {
+            status = -1;
+            break;
+        }
+        // Start with buffer 0; advancing to it queues the read of buffer 1
+        ioSubmit(io, &r->req[0], r->file, r->buf[0], bufElems * sizeof(int), 0, 0);
+        r->cur = 1;
+        if (readerAdvanceBuffer(io, r, bufElems) != 0) status = -1;
+        empty[i] = r->len == 0;
+        if (r->len > 0) heads[i] = r->buf[r->cur][0];
+    }
+    
+    LoserTree lt;
+    if (status == 0 && loserTreeInit(&lt, k, heads, empty) == 0) {
+        for (int run; status == 0 && (run = loserTreeWinner(&lt)) >= 0; ) {
+            RunReader *r = &readers[run];
+            w.buf[w.cur][w.len++] = r->buf[r->cur][r->pos++];
+            if (w.len == w.capacity && writerFlush(io, &w) != 0) status = -1;
+            
+            if (r->pos == r->len && readerAdvanceBuffer(io, r, bufElems) != 0) status = -1;
+            if (r->len == 0) loserTreeExhaust(&lt);
+            else loserTreeReplace(&lt, r->buf[r->cur][r->pos]);
+        }
+        loserTreeFree(&lt);
+    } else {
+        status = -1;
+    }
+    if (status == 0 && writerFlush(io, &w) != 0) status = -1;
+    
+    for (int i = 0; i < 2; i++) {
+        if (ioWait(io, &w.req[i])) status = -1;
+        free(w.buf[i]);
+    }
+    for (int i = 0; readers && i < k; i++) {
+        for (int b = 0; b < 2; b++) {
+            ioWait(io, &readers[i].req[b]);
+            free(readers[i].buf[b]);
+        }
+        if (readers[i].file) fclose(readers[i].file);
+    }
+    free(readers);
+    free(heads);
+    free(empty);
+    return status;
+}
+
+// Run files one merge may hold open under RLIMIT_NOFILE (INT_MAX if unlimited)
+static int openRunLimit(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY) return INT_MAX;
+    if (rl.rlim_cur > (rlim_t)INT_MAX) return INT_MAX;
+    return (int)rl.rlim_cur - RESERVED_FDS;
+}
+
+/*
+ * Phase 2: merge passes until one pass can write the output
+ * With fan-in F, every intermediate pass divides the run count by F.
+ * F is bounded by the memory budget and by the open file limit, since a
+ * merge keeps all of its input runs open at once
+ */
+static int mergeAllRuns(IoThread *io, RunList *runs, FILE *out,
+                        const ExternalSortConfig *cfg, ExternalSortStats *stats) {
+    size_t budget = cfg->memory_bytes / sizeof(int);
+    int fanIn = (int)(budget / (2 * MIN_MERGE_BUFFER)) - 1;
+    int fileLimit = openRunLimit();
+    if (fanIn > fileLimit) fanIn = fileLimit;
+    if (fanIn < 2) fanIn = 2;
+    
+    for (int pass = 1; runs->count > fanIn; pass++) {
+        RunList next;
+        memset(&next, 0, sizeof(next));
+        for (int first = 0; first < runs->count; first += fanIn) {
+            int k = runs->count - first < fanIn ? runs->count - first : fanIn;
+            const char *mergedPath = addRunPath(&next, cfg->temp_dir, pass);
+            FILE *merged = mergedPath ? fopen(mergedPath, "wb") : NULL;
+            int status = merged ? mergeRunFiles(io, runs->paths + first, k, merged,
+                                                budget / (2 * (k + 1))) : -1;
+            if (merged && fclose(merged) != 0) status = -1;
+            if (status != 0) {
+                freeRuns(&next, 1);
+                return -1;
+            }
+        }
+        freeRuns(runs, 1);
+        *runs = next;
+        stats->merge_passes++;
+    }
+    
+    stats->merge_passes++;
+    return mergeRunFiles(io, runs->paths, runs->count, out,
+                         budget / (2 * (runs->count + 1)));
+}
+
+/*
+ * Sort inPath into outPath within cfg->memory_bytes of buffers
+ * Returns 0 on success, -1 on any I/O or allocation failure
+ */
+int externalSort(const char *inPath, const char *outPath,
+                 const ExternalSortConfig *cfg, ExternalSortStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    FILE *in = fopen(inPath, "rb");
+    if (!in) return -1;
+    FILE *out = fopen(outPath, "wb");
+    if (!out) {
+        fclose(in);
+        return -1;
+    }
+    
+    IoThread io;
+    if (ioStart(&io) != 0) {
+        fclose(in);
+        fclose(out);
+        return -1;
+    }
+    
+    RunList runs;
+    memset(&runs, 0, sizeof(runs));
+    
+    double start = now_ms();
+    int status = generateRuns(&io, in, cfg, &runs, stats);
+    stats->run_ms = now_ms() - start;
+    fclose(in);
+    
+    if (status == 0 && runs.count > 0) {
+        start = now_ms();
+        status = mergeAllRuns(&io, &runs, out, cfg, stats);
+        stats->merge_ms = now_ms() - start;
+    }
+    
+    ioStop(&io);
+    freeRuns(&runs, 1);
+    if (fclose(out) != 0) status = -1;
+    return status;
+}
@@ -0,0 +1,205 @@
+/*
+ * Memory-Mapped File Sorting
+ *
+ * Sorts a raw file of little-endian int32 or int64 values without parsing
+ * or copying it into the process: the file is mapped with mmap(MAP_SHARED)
+ * and the algorithm works directly on the mapping, so the page cache is
+ * the array and the kernel writes the sorted pages back.
+ *
+ * With an output path, the input is first duplicated by the kernel
+ * (copy_file_range, no user-space copy) and the copy is sorted in place,
+ * leaving the input untouched.
+ *
+ * The default engines (simd for int32 and int64) sort in place, so the
+ * mapping is the only copy of the data. radix_lsd is faster on large
+ * files but allocates an n-element scratch buffer on the heap.
+ *
+ * madvise hints: none while sorting (partitioning jumps around the
+ * mapping), MADV_SEQUENTIAL for the read-ahead of the verify pass, and
+ * MADV_HUGEPAGE to ask for transparent huge pages (only honored by some
+ * file systems, e.g. tmpfs).
+ *
+ * Text files of newline-delimited keys (lines) take the same path: the
+ * lines are sorted as SortString records pointing into the mapping, and
+ * the sorted text is then written back over it. A last line without a
+ * newline gets one, and the file's last newline is dropped instead, so the
+ * size does not change.
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "../include/sorting.h"
+
+void fileSortConfigDefaults(FileSortConfig *cfg) {
+    cfg->element_size = 4;
+    cfg->lines = 0;
+    cfg->algorithm = "simd";
+    cfg->verify = 1;
+    cfg->advise_sequential = 1;
+    cfg->advise_hugepage = 0;
+}
+
+// Duplicate the whole of inFd into outFd inside the kernel
+static int copyFileContents(int inFd, int outFd, off_t size) {
+    off_t done = 0;
+    while (done < size) {
+        ssize_t n = copy_file_range(inFd, NULL, outFd, NULL, (size_t)(size - done), 0);
+        if (n > 0) {
+            done += n;
+            continue;
+        }
+        if (n == 0 || (errno != ENOSYS && errno != EXDEV && errno != EOPNOTSUPP)) return -1;
+        
+        // Not supported between these file systems: plain read/write loop
+        char buf[1 << 16];
+        if (lseek(inFd, done, SEEK_SET) < 0 || lseek(outFd, done, SEEK_SET) < 0) return -1;
+        ssize_t got;
+        while ((got = read(inFd, buf, sizeof(buf))) > 0) {
+            if (write(outFd, buf, (size_t)got) != got) return -1;
+            done += got;
+        }
+        return got < 0 ? -1 : 0;
+    }
+    return 0;
+}
+
+static int isSortedWide(const int64_t arr[], size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i - 1] > arr[i]) return 0;
+    }
+    return 1;
+}
+
+/*
+ * Sort the lines of the mapped text with alg and write them back
+ * Returns 0, or -1 if memory runs out (the text is then unchanged)
+ */
+static int sortLines(char *text, size_t bytes, const StringSortAlgorithm *alg, FileSortStats *stats) {
+    double start = now_ms();
+    size_t n = 0;
+    for (const char *p = text, *end = text + bytes; p < end; n++) {
+        const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+        p = nl ? nl + 1 : end;
+    }
+    SortString *strs = (SortString *)sortBufferAlloc(n * sizeof(SortString));
+    char *out = (char *)sortBufferAlloc(bytes);
+    if (!strs || !out) {
+        sortBufferFree(strs);
+        sortBufferFree(out);
+        return -1;
+    }
+    const char *p = text, *end = text + bytes;
+    for (size_t i = 0; i < n; i++) {
+        const char *nl = (const char *)memchr(p, '\n', (size_t)(end - p));
+        strs[i].ptr = p;
+        strs[i].len = (size_t)((nl ? nl : end) - p);
+        p = nl ? nl + 1 : end;
+    }
+    stats->elements = n;
+    stats->lines_ms = now_ms() - start;
+    
+    start = now_ms();
+    int status = alg->sort(strs, n);
+    stats->sort_ms = now_ms() - start;
+    
+    if (status == 0) {
+        start = now_ms();
+        size_t o = 0;
+        for (size_t i = 0; i < n; i++) {
+            memcpy(out + o, strs[i].ptr, strs[i].len);
+            o += strs[i].len;
+            if (o < bytes) out[o++] = '\n';
+        }
+        memcpy(text, out, bytes);
+        stats->lines_ms += now_ms() - start;
+    }
+    sortBufferFree(strs);
+    sortBufferFree(out);
+    return status;
+}
+
+/*
+ * Sort inPath in place, or into outPath when it is not NULL
+ * Returns 0 on success, -1 on failure (errno describes system errors)
+ */
+int mmapSortFile(const char *inPath, const char *outPath,
+                 const FileSortConfig *cfg, FileSortStats *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->sorted = 1;
+    const SortAlgorithm *alg = NULL;
+    const StringSortAlgorithm *stringAlg = NULL;
+    size_t elemSize = cfg->lines ? 1 : (size_t)cfg->element_size;
+    if (cfg->lines) {
+        stringAlg = findStringSortAlgorithm(cfg->algorithm);
+        if (!stringAlg) return -1;
+    } else if (cfg->element_size == 4) {
+        alg = findSortAlgorithm(cfg->algorithm);
+        if (!alg) return -1;
+    } else if (cfg->element_size != 8) {
+        return -1;
+    }
+    
+    int fd = open(inPath, outPath ? O_RDONLY : O_RDWR);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size % elemSize != 0) {
+        close(fd);
+        return -1;
+    }
+    
+    if (outPath) {
+        int outFd = open(outPath, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        double start = now_ms();
+        if (outFd < 0 || copyFileContents(fd, outFd, st.st_size) != 0) {
+            if (outFd >= 0) close(outFd);
+            close(fd);
+            return -1;
+        }
+        stats->copy_ms = now_ms() - start;
+        close(fd);
+        fd = outFd;
+    }
+    
+    size_t bytes = (size_t)st.st_size;
+    stats->elements = bytes / elemSize;
+    if (bytes == 0) {
+        close(fd);
+        return 0;
+    }
+    
+    void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);   // The mapping keeps the file referenced
+    if (map == MAP_FAILED) return -1;
+    
+    if (cfg->advise_hugepage) stats->hugepage_ok = madvise(map, bytes, MADV_HUGEPAGE) == 0;
+    
+    if (stringAlg) {
+        int status = sortLines((char *)map, bytes, stringAlg, stats);
+        return munmap(map, bytes) == 0 ? status : -1;
+    }
+    
+    double start = now_ms();
+    if (alg) {
+        alg->sort((int *)map, stats->elements);
+    } else if (strcmp(cfg->algorithm, "radix_lsd") == 0) {
+        radixSortLSD64((int64_t *)map, stats->elements);
+    } else {
+        simdSort64((int64_t *)map, stats->elements);
+    }
+    stats->sort_ms = now_ms() - start;
+    
+    // The verify pass is the one front-to-back read: let read-ahead run
+    if (cfg->verify) {
+        if (cfg->advise_sequential) madvise(map, bytes, MADV_SEQUENTIAL);
+        start = now_ms();
+        stats->sorted = alg ? isSorted((int *)map, stats->elements)
+                            : isSortedWide((const int64_t *)map, stats->elements);
+        stats->verify_ms = now_ms() - start;
+    }
+    
+    return munmap(map, bytes) == 0 ? 0 : -1;
+}
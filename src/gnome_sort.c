@@ -14,8 +14,9 @@
 
 #include "../include/sorting.h"
 
-void gnomeSort(int arr[], int n) {
-    int index = 0;
+void gnomeSort(int arr[], size_t n) {
+    if (n < 2) return;
+    size_t index = 0;
     
     while (index < n) {
         if (index == 0) {
@@ -36,8 +37,9 @@ void gnomeSort(int arr[], int n) {
 /*
  * Gnome Sort with counters for analysis
  */
-void gnomeSortCounted(int arr[], int n) {
-    int index = 0;
+void gnomeSortCounted(int arr[], size_t n) {
+    if (n < 2) return;
+    size_t index = 0;
     
     while (index < n) {
         if (index == 0) {
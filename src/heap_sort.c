@@ -26,10 +26,10 @@
  * n is the size of the heap
  * Maintains the max-heap property
  */
-void heapify(int arr[], int n, int i) {
-    int largest = i;      // Initialize largest as root
-    int left = 2 * i + 1; // Left child
-    int right = 2 * i + 2; // Right child
+void heapify(int arr[], size_t n, size_t i) {
+    size_t largest = i;      // Initialize largest as root
+    size_t left = 2 * i + 1; // Left child
+    size_t right = 2 * i + 2; // Right child
     
     // If left child is larger than root
     if (left < n && arr[left] > arr[largest]) {
@@ -54,9 +54,9 @@ void heapify(int arr[], int n, int i) {
  * Build a max-heap from an unsorted array
  * Start from the last non-leaf node and heapify all nodes
  */
-void buildMaxHeap(int arr[], int n) {
+void buildMaxHeap(int arr[], size_t n) {
     // Start from last non-leaf node
-    for (int i = n / 2 - 1; i >= 0; i--) {
+    for (size_t i = n / 2; i-- > 0;) {
         heapify(arr, n, i);
     }
 }
@@ -66,12 +66,12 @@ void buildMaxHeap(int arr[], int n) {
  * 1. Build max-heap
  * 2. Extract max (swap with last), reduce heap size, heapify root
  */
-void heapSort(int arr[], int n) {
+void heapSort(int arr[], size_t n) {
     // Build max-heap
     buildMaxHeap(arr, n);
     
     // Extract elements from heap one by one
-    for (int i = n - 1; i > 0; i--) {
+    for (size_t i = n; i-- > 1;) {
         // Move current root (maximum) to end
         swap(&arr[0], &arr[i]);
         
@@ -80,13 +80,36 @@ void heapSort(int arr[], int n) {
     }
 }
 
+/*
+ * Top-k selection: move the k smallest keys, in ascending order, to
+ * arr[0..k); the rest of arr keeps the other keys in no particular order.
+ * A max-heap of the best k so far sits at the front: every later key
+ * smaller than its root is swapped in, so the array stays a permutation.
+ * O(n log k) time, O(1) space.
+ */
+void heapTopK(int arr[], size_t n, size_t k) {
+    if (k == 0) return;
+    if (k >= n) {
+        heapSort(arr, n);
+        return;
+    }
+    buildMaxHeap(arr, k);
+    for (size_t i = k; i < n; i++) {
+        if (arr[i] < arr[0]) {
+            swap(&arr[0], &arr[i]);
+            heapify(arr, k, 0);
+        }
+    }
+    heapSort(arr, k);
+}
+
 /*
  * Heapify with counters
  */
-static void heapifyCounted(int arr[], int n, int i) {
-    int largest = i;
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
+static void heapifyCounted(int arr[], size_t n, size_t i) {
+    size_t largest = i;
+    size_t left = 2 * i + 1;
+    size_t right = 2 * i + 2;
     
     if (left < n) {
         comparison_count++;
@@ -111,15 +134,224 @@ static void heapifyCounted(int arr[], int n, int i) {
 /*
  * Heap Sort with counters for analysis
  */
-void heapSortCounted(int arr[], int n) {
+void heapSortCounted(int arr[], size_t n) {
     // Build max-heap with counting
-    for (int i = n / 2 - 1; i >= 0; i--) {
+    for (size_t i = n / 2; i-- > 0;) {
         heapifyCounted(arr, n, i);
     }
     
     // Extract elements
-    for (int i = n - 1; i > 0; i--) {
+    for (size_t i = n; i-- > 1;) {
         swap_counted(&arr[0], &arr[i]);
         heapifyCounted(arr, i, 0);
     }
 }
+
+/*
+ * Loser Tree (Tournament Tree) for k-way merging
+ *
+ * Each of the k runs is a leaf. Internal node t (1 <= t < k) stores the
+ * run that LOST the match played at t; tree[0] stores the overall winner,
+ * i.e. the run with the smallest current key. Leaf i sits at position
+ * k + i, so its first match is at (k + i) / 2.
+ *
+ * After the winner's run advances, only the matches on its leaf-to-root
+ * path are replayed: ceil(log2 k) comparisons per output element, against
+ * about 2 log2 k for a binary heap's sift-down. Each match is a single
+ * branch-free comparison.
+ *
+ * Exhausted runs behave like +infinity. Equal keys are won by the lower
+ * run index, so the merge is stable with respect to run order.
+ */
+
+// 1 if run a should come out before run b
+static inline int loserTreeBeats(const LoserTree *lt, int a, int b) {
+    int ka = lt->keys[a], kb = lt->keys[b];
+    return (!lt->done[a]) & (lt->done[b] | (ka < kb) | ((ka == kb) & (a < b)));
+}
+
+int loserTreeInit(LoserTree *lt, int k, const int keys[], const int exhausted[]) {
+    lt->k = k;
+    lt->tree = (int *)sort_malloc(k * sizeof(int));
+    lt->keys = (int *)sort_malloc(k * sizeof(int));
+    lt->done = (int *)sort_malloc(k * sizeof(int));
+    int *winners = (int *)sort_malloc(2 * k * sizeof(int));
+    if (!lt->tree || !lt->keys || !lt->done || !winners) {
+        sort_free(winners);
+        loserTreeFree(lt);
+        return -1;
+    }
+    
+    for (int i = 0; i < k; i++) {
+        lt->keys[i] = keys[i];
+        lt->done[i] = exhausted ? exhausted[i] != 0 : 0;
+        winners[k + i] = i;
+    }
+    // Play every match bottom-up: losers stay, winners move up
+    for (int t = k - 1; t >= 1; t--) {
+        int a = winners[2 * t], b = winners[2 * t + 1];
+        int aWins = loserTreeBeats(lt, a, b);
+        winners[t] = aWins ? a : b;
+        lt->tree[t] = aWins ? b : a;
+    }
+    lt->tree[0] = k > 1 ? winners[1] : 0;
+    sort_free(winners);
+    return 0;
+}
+
+// Run holding the smallest key, or -1 once every run is exhausted
+int loserTreeWinner(const LoserTree *lt) {
+    int w = lt->tree[0];
+    return lt->done[w] ? -1 : w;
+}
+
+int loserTreeWinnerKey(const LoserTree *lt) {
+    return lt->keys[lt->tree[0]];
+}
+
+// Replay the matches on the winner's path to the root
+static void loserTreeReplay(LoserTree *lt) {
+    int cur = lt->tree[0];
+    for (int t = (lt->k + cur) / 2; t >= 1; t /= 2) {
+        int other = lt->tree[t];
+        int otherWins = loserTreeBeats(lt, other, cur);
+        lt->tree[t] = otherWins ? cur : other;
+        cur = otherWins ? other : cur;
+    }
+    lt->tree[0] = cur;
+}
+
+// The winner's run produced its next key
+void loserTreeReplace(LoserTree *lt, int key) {
+    lt->keys[lt->tree[0]] = key;
+    loserTreeReplay(lt);
+}
+
+// The winner's run has no more keys
+void loserTreeExhaust(LoserTree *lt) {
+    lt->done[lt->tree[0]] = 1;
+    loserTreeReplay(lt);
+}
+
+void loserTreeFree(LoserTree *lt) {
+    sort_free(lt->tree);
+    sort_free(lt->keys);
+    sort_free(lt->done);
+    lt->tree = lt->keys = lt->done = NULL;
+}
+
+/*
+ * Merge k sorted in-memory runs into out (sum of lens elements)
+ * Returns 0, or -1 if memory runs out (out is then incomplete)
+ */
+int mergeKWay(const int *runs[], const size_t lens[], int k, int out[]) {
+    if (k <= 0) return 0;
+    int *heads = (int *)sort_malloc(k * sizeof(int));
+    int *empty = (int *)sort_malloc(k * sizeof(int));
+    size_t *pos = (size_t *)sort_calloc(k, sizeof(size_t));
+    int status = -1;
+    for (int i = 0; heads && empty && pos && i < k; i++) {
+        empty[i] = lens[i] == 0;
+        heads[i] = empty[i] ? 0 : runs[i][0];
+    }
+    
+    LoserTree lt;
+    if (heads && empty && pos && loserTreeInit(&lt, k, heads, empty) == 0) {
+        status = 0;
+        size_t o = 0;
+        for (int w; (w = loserTreeWinner(&lt)) >= 0; ) {
+            out[o++] = loserTreeWinnerKey(&lt);
+            if (++pos[w] < lens[w]) loserTreeReplace(&lt, runs[w][pos[w]]);
+            else loserTreeExhaust(&lt);
+        }
+        loserTreeFree(&lt);
+    }
+    sort_free(pos);
+    sort_free(empty);
+    sort_free(heads);
+    return status;
+}
+
+/*
+ * Streaming merge: next(ctx, run, &value) returns 1 and the run's next
+ * value, 0 when the run is exhausted, or -1 on a read error;
+ * emit(ctx, value) consumes the merged output. Returns the number of
+ * values emitted, or -1 on failure.
+ */
+long long mergeKWayStream(int k, MergeSource next, void *srcCtx, MergeSink emit, void *sinkCtx) {
+    if (k <= 0) return 0;
+    int *heads = (int *)sort_malloc(k * sizeof(int));
+    int *empty = (int *)sort_malloc(k * sizeof(int));
+    int status = heads && empty ? 0 : -1;
+    for (int i = 0; status == 0 && i < k; i++) {
+        heads[i] = 0;
+        int got = next(srcCtx, i, &heads[i]);
+        if (got < 0) status = -1;
+        else empty[i] = !got;
+    }
+    
+    LoserTree lt;
+    long long emitted = -1;
+    if (status == 0 && loserTreeInit(&lt, k, heads, empty) == 0) {
+        emitted = 0;
+        for (int w; (w = loserTreeWinner(&lt)) >= 0; ) {
+            if (emit(sinkCtx, loserTreeWinnerKey(&lt)) != 0) {
+                emitted = -1;
+                break;
+            }
+            emitted++;
+            int value;
+            int got = next(srcCtx, w, &value);
+            if (got < 0) {
+                emitted = -1;
+                break;
+            }
+            if (got) loserTreeReplace(&lt, value);
+            else loserTreeExhaust(&lt);
+        }
+        loserTreeFree(&lt);
+    }
+    sort_free(empty);
+    sort_free(heads);
+    return emitted;
+}
+
+// File variant: sources are stdio streams of raw int32 values. A read
+// error or a trailing partial value fails the merge instead of ending the run
+static int nextFromFile(void *ctx, int run, int *value) {
+    FILE **files = (FILE **)ctx;
+    size_t got = fread(value, 1, sizeof(int), files[run]);
+    if (got == sizeof(int)) return 1;
+    return got == 0 && !ferror(files[run]) ? 0 : -1;
+}
+
+static int emitToFile(void *ctx, int value) {
+    return fwrite(&value, sizeof(int), 1, (FILE *)ctx) == 1 ? 0 : -1;
+}
+
+/*
+ * Merge k sorted raw int32 files into outPath
+ * Returns the number of values written, or -1 on failure
+ */
+long long mergeKWayFiles(const char *paths[], int k, const char *outPath) {
+    FILE **files = (FILE **)calloc(k > 0 ? k : 1, sizeof(FILE *));
+    FILE *out = fopen(outPath, "wb");
+    long long written = out && files ? 0 : -1;
+    
+    for (int i = 0; i < k && written == 0; i++) {
+        files[i] = fopen(paths[i], "rb");
+        if (!files[i]) written = -1;
+        else setvbuf(files[i], NULL, _IOFBF, 1 << 20);
+    }
+    if (written == 0) {
+        setvbuf(out, NULL, _IOFBF, 1 << 20);
+        written = mergeKWayStream(k, nextFromFile, files, emitToFile, out);
+    }
+    
+    for (int i = 0; files && i < k; i++) {
+        if (files[i]) fclose(files[i]);
+    }
+    free(files);
+    if (out && fclose(out) != 0) written = -1;
+    return written;
+}
@@ -10,34 +10,38 @@
  */
 
 #include "../include/sorting.h"
+#include <limits.h>
+#include <sys/stat.h>
 
 // Time measurement
-double measureTime(void (*sortFunc)(int[], int), int arr[], int n) {
-    clock_t start = clock();
+// Each helper resets the counters first, so memory_peak afterwards holds the
+// extra bytes allocated by that single sort.
+double measureTime(void (*sortFunc)(int[], size_t), int arr[], size_t n) {
+    reset_counters();
+    double start = now_ms();
     sortFunc(arr, n);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    return now_ms() - start;
 }
 
-double measureTimeQuick(int arr[], int n) {
-    clock_t start = clock();
-    quickSort(arr, 0, n - 1);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+double measureTimeQuick(int arr[], size_t n) {
+    reset_counters();
+    double start = now_ms();
+    quickSort(arr, 0, (ptrdiff_t)n - 1);
+    return now_ms() - start;
 }
 
-double measureTimeRadix(int arr[], int n, int k) {
-    clock_t start = clock();
+double measureTimeRadix(int arr[], size_t n, int k) {
+    reset_counters();
+    double start = now_ms();
     radixSort(arr, n, k);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    return now_ms() - start;
 }
 
-double measureTimeBucket(int arr[], int n, int maxVal) {
-    clock_t start = clock();
+double measureTimeBucket(int arr[], size_t n, int maxVal) {
+    reset_counters();
+    double start = now_ms();
     bucketSortInt(arr, n, maxVal);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    return now_ms() - start;
 }
 
 // Run algorithm with counters
@@ -45,68 +49,102 @@ typedef struct {
     double time_ms;
     long long comparisons;
     long long swaps;
+    size_t peak_bytes;   // Extra memory allocated at peak (memory_peak)
 } AlgorithmStats;
 
-AlgorithmStats runBubbleCounted(int arr[], int n) {
+AlgorithmStats runBubbleCounted(int arr[], size_t n) {
     AlgorithmStats stats;
     reset_counters();
-    clock_t start = clock();
+    double start = now_ms();
     bubbleSortCounted(arr, n);
-    clock_t end = clock();
-    stats.time_ms = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    stats.time_ms = now_ms() - start;
     stats.comparisons = comparison_count;
     stats.swaps = swap_count;
+    stats.peak_bytes = memory_peak;
     return stats;
 }
 
-AlgorithmStats runGnomeCounted(int arr[], int n) {
+AlgorithmStats runGnomeCounted(int arr[], size_t n) {
     AlgorithmStats stats;
     reset_counters();
-    clock_t start = clock();
+    double start = now_ms();
     gnomeSortCounted(arr, n);
-    clock_t end = clock();
-    stats.time_ms = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    stats.time_ms = now_ms() - start;
     stats.comparisons = comparison_count;
     stats.swaps = swap_count;
+    stats.peak_bytes = memory_peak;
     return stats;
 }
 
-AlgorithmStats runQuickCounted(int arr[], int n) {
+AlgorithmStats runQuickCounted(int arr[], size_t n) {
     AlgorithmStats stats;
     reset_counters();
-    clock_t start = clock();
-    quickSortCounted(arr, 0, n - 1);
-    clock_t end = clock();
-    stats.time_ms = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    double start = now_ms();
+    quickSortCounted(arr, 0, (ptrdiff_t)n - 1);
+    stats.time_ms = now_ms() - start;
     stats.comparisons = comparison_count;
     stats.swaps = swap_count;
+    stats.peak_bytes = memory_peak;
     return stats;
 }
 
-AlgorithmStats runHeapCounted(int arr[], int n) {
+AlgorithmStats runHeapCounted(int arr[], size_t n) {
     AlgorithmStats stats;
     reset_counters();
-    clock_t start = clock();
+    double start = now_ms();
     heapSortCounted(arr, n);
-    clock_t end = clock();
-    stats.time_ms = ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    stats.time_ms = now_ms() - start;
     stats.comparisons = comparison_count;
     stats.swaps = swap_count;
+    stats.peak_bytes = memory_peak;
+    return stats;
+}
+
+// Radix and Bucket Sort have no counted variants: they do not compare
+// elements, so only time and memory are reported for them.
+AlgorithmStats runRadixMeasured(int arr[], size_t n, int k) {
+    AlgorithmStats stats;
+    stats.time_ms = measureTimeRadix(arr, n, k);
+    stats.comparisons = 0;
+    stats.swaps = 0;
+    stats.peak_bytes = memory_peak;
+    return stats;
+}
+
+AlgorithmStats runBucketMeasured(int arr[], size_t n, int maxVal) {
+    AlgorithmStats stats;
+    stats.time_ms = measureTimeBucket(arr, n, maxVal);
+    stats.comparisons = 0;
+    stats.swaps = 0;
+    stats.peak_bytes = memory_peak;
+    return stats;
+}
+
+AlgorithmStats runAutoMeasured(int arr[], size_t n, SortDecision *decision) {
+    AlgorithmStats stats;
+    reset_counters();
+    double start = now_ms();
+    sortAuto(arr, n, decision);
+    stats.time_ms = now_ms() - start;
+    stats.comparisons = 0;
+    stats.swaps = 0;
+    stats.peak_bytes = memory_peak;
     return stats;
 }
 
 void printStats(const char* name, AlgorithmStats stats, int passed) {
-    printf("  %-20s %s  Time: %8.3f ms  Comparisons: %10lld  Swaps: %10lld\n",
-           name, passed ? "PASS" : "FAIL", stats.time_ms, stats.comparisons, stats.swaps);
+    printf("  %-20s %s  Time: %8.3f ms  Comparisons: %10lld  Swaps: %10lld  Peak Mem: %10zu B\n",
+           name, passed ? "PASS" : "FAIL", stats.time_ms, stats.comparisons, stats.swaps,
+           stats.peak_bytes);
 }
 
-void runTestCase(const char* testName, int original[], int n) {
+void runTestCase(const char* testName, int original[], size_t n) {
     int *arr = (int *)malloc(n * sizeof(int));
     AlgorithmStats stats;
     
-    printf("\n%s (n=%d)\n", testName, n);
-    printf("  %-20s %-4s  %-18s  %-22s  %-15s\n", "Algorithm", "Test", "Time", "Comparisons", "Swaps");
-    printf("  %s\n", "--------------------------------------------------------------------------------");
+    printf("\n%s (n=%zu)\n", testName, n);
+    printf("  %-20s %-4s  %-18s  %-22s  %-15s  %-12s\n", "Algorithm", "Test", "Time", "Comparisons", "Swaps", "Peak Memory");
+    printf("  %s\n", "------------------------------------------------------------------------------------------------");
     
     // Bubble Sort
     copyArray(original, arr, n);
@@ -128,10 +166,35 @@ void runTestCase(const char* testName, int original[], int n) {
     stats = runHeapCounted(arr, n);
     printStats("Heap Sort", stats, isSorted(arr, n));
     
+    // Radix and Bucket Sort need the value range of the test case
+    int maxVal = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (original[i] > maxVal) maxVal = original[i];
+    }
+    int digits = 1;
+    for (int v = maxVal; v >= 10; v /= 10) digits++;
+    
+    // Radix Sort
+    copyArray(original, arr, n);
+    stats = runRadixMeasured(arr, n, digits);
+    printStats("Radix Sort", stats, isSorted(arr, n));
+    
+    // Bucket Sort
+    copyArray(original, arr, n);
+    stats = runBucketMeasured(arr, n, maxVal);
+    printStats("Bucket Sort", stats, isSorted(arr, n));
+    
+    // Automatic selection, with the reason for its choice
+    SortDecision decision;
+    copyArray(original, arr, n);
+    stats = runAutoMeasured(arr, n, &decision);
+    printStats("Auto Sort", stats, isSorted(arr, n));
+    printSortDecision(&decision);
+    
     free(arr);
 }
 
-void runAllTestCases(int n) {
+void runAllTestCases(size_t n) {
     int *arr = (int *)malloc(n * sizeof(int));
     
     printf("\n");
@@ -181,15 +244,1261 @@ void printUsageGuide(void) {
     printf("\n");
     printf("Stability Matters? Use: Bubble Sort, Gnome Sort, Radix Sort, or Bucket Sort\n");
     printf("Memory Limited?    Use: Heap Sort (O(1) extra space)\n");
-    printf("Unknown Data?      Use: Quick Sort or Heap Sort\n");
+    printf("Unknown Data?      Use: sortAuto() (samples the input, see 'analysis')\n");
+}
+
+/*
+ * --pages off|thp|hugetlb and --first-touch on|off, shared by the benchmark
+ * commands (see memory.c); 1 if argv[*i] was one of them, 0 if not, -1 on
+ * a bad value
+ */
+static int parseMemoryOption(int argc, char *argv[], int *i, SortMemoryPolicy *policy) {
+    if (*i + 1 >= argc) return 0;
+    if (strcmp(argv[*i], "--pages") == 0) {
+        if (parseSortPageMode(argv[++*i], &policy->pages) == 0) return 1;
+        printf("Unknown page mode: %s (off, thp or hugetlb)\n", argv[*i]);
+        return -1;
+    }
+    if (strcmp(argv[*i], "--first-touch") == 0) {
+        policy->first_touch = strcmp(argv[++*i], "on") == 0;
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Statistical benchmark: every algorithm on every input shape at size n
+ * Usage: ./sort_test bench [n] [--csv file] [--json file] [--samples file]
+ *        [--cpu k] [--warmup k] [--min-time ms] [--max-runs k] [--algo name] [--gen name]
+ *        [--pages off|thp|hugetlb] [--first-touch on|off]
+ */
+void printGeneratorNames(void) {
+    printf("Available generators:");
+    for (int i = 0; i < input_generator_count; i++) printf(" %s", input_generators[i].name);
+    printf("\nAvailable algorithms:");
+    for (int i = 0; i < sort_algorithm_count; i++) printf(" %s", sort_algorithms[i].name);
+    printf("\nAvailable string algorithms (--lines):");
+    for (int i = 0; i < string_algorithm_count; i++) printf(" %s", string_algorithms[i].name);
+    printf("\n");
+}
+
+int runBenchmarkSuite(int argc, char *argv[]) {
+    size_t n = 1000;
+    const char *csvPath = "output/bench.csv";
+    const char *jsonPath = "output/bench.json";
+    const char *samplesPath = NULL;
+    const char *onlyAlgo = NULL;
+    const char *onlyGen = NULL;
+    BenchConfig cfg;
+    benchConfigDefaults(&cfg);
+    SortMemoryPolicy memory = *sortMemoryPolicy();
+    
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        int memoryOption = parseMemoryOption(argc, argv, &i, &memory);
+        if (memoryOption < 0) return 1;
+        if (memoryOption > 0) continue;
+        if (strcmp(argv[i], "--csv") == 0 && hasValue) csvPath = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && hasValue) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--samples") == 0 && hasValue) samplesPath = argv[++i];
+        else if (strcmp(argv[i], "--cpu") == 0 && hasValue) cfg.pin_cpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && hasValue) cfg.warmup_runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && hasValue) cfg.min_time_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-runs") == 0 && hasValue) cfg.max_runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--algo") == 0 && hasValue) onlyAlgo = argv[++i];
+        else if (strcmp(argv[i], "--gen") == 0 && hasValue) onlyGen = argv[++i];
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown benchmark option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (n == 0 || cfg.max_runs < cfg.min_runs || cfg.min_runs <= 0) {
+        printf("Invalid benchmark parameters\n");
+        return 1;
+    }
+    if ((onlyAlgo && !findSortAlgorithm(onlyAlgo)) || (onlyGen && !findInputGenerator(onlyGen))) {
+        printf("Unknown algorithm or generator name\n");
+        printGeneratorNames();
+        return 1;
+    }
+    
+    setSortMemoryPolicy(&memory);
+    int cpu = benchPinCpu(cfg.pin_cpu);
+    if (cpu < 0) printf("Warning: could not pin to a CPU, results may be noisier\n");
+    
+    int *input = (int *)sortBufferAlloc(n * sizeof(int));
+    int *work = (int *)sortBufferAlloc(n * sizeof(int));
+    BenchResult *results = (BenchResult *)malloc(sort_algorithm_count * input_generator_count * sizeof(BenchResult));
+    FILE *csv = fopen(csvPath, "w");
+    if (!input || !work || !results || !csv) {
+        printf("Could not allocate buffers or open %s\n", csvPath);
+        sortBufferFree(input); sortBufferFree(work); free(results);
+        if (csv) fclose(csv);
+        return 1;
+    }
+    benchWriteCsvHeader(csv);
+    FILE *samplesCsv = samplesPath ? fopen(samplesPath, "w") : NULL;
+    if (samplesCsv) benchWriteSamplesCsvHeader(samplesCsv);
+    
+    printf("Benchmark n=%zu, seed=%llu, cpu=%d, warm-up=%d, runs=%d..%d, min time=%.0f ms, "
+           "pages=%s, first touch %s\n\n",
+           n, (unsigned long long)getSortSeed(), cpu, cfg.warmup_runs, cfg.min_runs, cfg.max_runs, cfg.min_time_ms,
+           sortPageModeName(memory.pages), memory.first_touch ? "on" : "off");
+    printf("  %-11s %-11s %6s %12s %12s %12s %12s %4s\n",
+           "Algorithm", "Generator", "Runs", "Min (ms)", "Median (ms)", "P90 (ms)", "Stddev", "Test");
+    
+    int count = 0;
+    for (int g = 0; g < input_generator_count; g++) {
+        if (onlyGen && strcmp(onlyGen, input_generators[g].name) != 0) continue;
+        uint64_t inputSeed = benchGenerateInput(&input_generators[g], input, n);
+        
+        for (int a = 0; a < sort_algorithm_count; a++) {
+            if (onlyAlgo && strcmp(onlyAlgo, sort_algorithms[a].name) != 0) continue;
+            BenchResult res = benchMeasure(&sort_algorithms[a], input_generators[g].name,
+                                           input, work, n, &cfg);
+            res.input_seed = inputSeed;
+            printf("  %-11s %-11s %6d %12.4f %12.4f %12.4f %12.4f %4s\n",
+                   res.algorithm, res.generator, res.runs, res.min_ms, res.median_ms,
+                   res.p90_ms, res.stddev_ms, res.passed ? "PASS" : "FAIL");
+            benchWriteCsvRow(csv, &res);
+            if (samplesCsv) benchWriteSamplesCsvRows(samplesCsv, &res);
+            results[count++] = res;
+        }
+    }
+    fclose(csv);
+    if (samplesCsv) fclose(samplesCsv);
+    
+    FILE *json = fopen(jsonPath, "w");
+    if (json) {
+        benchWriteJson(json, results, count);
+        fclose(json);
+    }
+    printf("\nResults saved to %s and %s\n", csvPath, json ? jsonPath : "(JSON not written)");
+    
+    benchFreeResults(results, count);
+    sortBufferFree(input);
+    sortBufferFree(work);
+    free(results);
+    return 0;
+}
+
+/*
+ * In-process benchmark matrix: algorithms x generators x sizes
+ * Usage: ./sort_test matrix [--min-n n] [--max-n n] [--budget ms] [--csv file]
+ *        [--json file] [--samples file] [--cpu k] [--min-time ms] [--algo name] [--gen name]
+ *        [--pages off|thp|hugetlb] [--first-touch on|off]
+ */
+int runBenchmarkMatrix(int argc, char *argv[]) {
+    const char *csvPath = "output/benchmark_matrix.csv";
+    const char *jsonPath = "output/benchmark_matrix.json";
+    const char *samplesPath = NULL;
+    MatrixConfig cfg;
+    matrixConfigDefaults(&cfg);
+    SortMemoryPolicy memory = *sortMemoryPolicy();
+    
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        int memoryOption = parseMemoryOption(argc, argv, &i, &memory);
+        if (memoryOption < 0) return 1;
+        if (memoryOption > 0) continue;
+        if (strcmp(argv[i], "--min-n") == 0 && hasValue) cfg.min_n = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--max-n") == 0 && hasValue) cfg.max_n = atoll(argv[++i]);
+        else if (strcmp(argv[i], "--budget") == 0 && hasValue) cfg.budget_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0 && hasValue) csvPath = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && hasValue) jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--samples") == 0 && hasValue) samplesPath = argv[++i];
+        else if (strcmp(argv[i], "--cpu") == 0 && hasValue) cfg.bench.pin_cpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && hasValue) cfg.bench.min_time_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--algo") == 0 && hasValue) cfg.only_algo = argv[++i];
+        else if (strcmp(argv[i], "--gen") == 0 && hasValue) cfg.only_gen = argv[++i];
+        else {
+            printf("Unknown matrix option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (cfg.min_n <= 0 || cfg.max_n < cfg.min_n) {
+        printf("Sizes must satisfy 0 < min-n <= max-n\n");
+        return 1;
+    }
+    if ((cfg.only_algo && !findSortAlgorithm(cfg.only_algo)) ||
+        (cfg.only_gen && !findInputGenerator(cfg.only_gen))) {
+        printf("Unknown algorithm or generator name\n");
+        printGeneratorNames();
+        return 1;
+    }
+    
+    FILE *csv = fopen(csvPath, "w");
+    if (!csv) {
+        printf("Could not open %s\n", csvPath);
+        return 1;
+    }
+    benchWriteCsvHeader(csv);
+    FILE *samplesCsv = samplesPath ? fopen(samplesPath, "w") : NULL;
+    if (samplesCsv) benchWriteSamplesCsvHeader(samplesCsv);
+    
+    setSortMemoryPolicy(&memory);
+    int cpu = benchPinCpu(cfg.bench.pin_cpu);
+    printf("Benchmark matrix n=%lld..%lld, seed=%llu, budget %.0f ms per cell, cpu=%d, pages=%s, first touch %s\n\n",
+           cfg.min_n, cfg.max_n, (unsigned long long)getSortSeed(), cfg.budget_ms, cpu,
+           sortPageModeName(memory.pages), memory.first_touch ? "on" : "off");
+    printf("  %-11s %-11s %11s %6s %12s %12s %12s %4s\n",
+           "Algorithm", "Generator", "n", "Runs", "Min (ms)", "Median (ms)", "P90 (ms)", "Test");
+    
+    BenchResult *results = NULL;
+    int count = 0;
+    int status = benchMatrix(&cfg, csv, samplesCsv, &results, &count);
+    fclose(csv);
+    if (samplesCsv) fclose(samplesCsv);
+    if (status != 0) {
+        printf("Could not allocate buffers for n=%lld\n", cfg.max_n);
+        return 1;
+    }
+    
+    FILE *json = fopen(jsonPath, "w");
+    if (json) {
+        benchWriteJson(json, results, count);
+        fclose(json);
+    }
+    printf("\n%d cells saved to %s and %s\n", count, csvPath, json ? jsonPath : "(JSON not written)");
+    
+    benchFreeResults(results, count);
+    free(results);
+    return 0;
+}
+
+/*
+ * Performance gate: re-run the cells of a baseline file and test each one
+ * Usage: ./sort_test compare <baseline.csv> [--threshold pct] [--alpha a]
+ *        [--min-time ms] [--min-runs k] [--cpu k] [--algo name]
+ * Exits with 1 when at least one cell got significantly slower
+ */
+int runBenchmarkCompare(int argc, char *argv[]) {
+    if (argc < 1) {
+        printf("Usage: ./sort_test compare <baseline.csv> [options]\n");
+        return 2;
+    }
+    const char *baselinePath = argv[0];
+    CompareConfig cfg;
+    compareConfigDefaults(&cfg);
+    
+    for (int i = 1; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--threshold") == 0 && hasValue) cfg.threshold = atof(argv[++i]) / 100.0;
+        else if (strcmp(argv[i], "--alpha") == 0 && hasValue) cfg.alpha = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && hasValue) cfg.bench.min_time_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-runs") == 0 && hasValue) cfg.bench.min_runs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cpu") == 0 && hasValue) cfg.bench.pin_cpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--algo") == 0 && hasValue) cfg.only_algo = argv[++i];
+        else {
+            printf("Unknown compare option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (cfg.bench.min_runs < 2 || cfg.bench.max_runs < cfg.bench.min_runs) {
+        printf("At least 2 runs per cell are needed for a statistical test\n");
+        return 2;
+    }
+    
+    benchPinCpu(cfg.bench.pin_cpu);
+    int regressions = benchCompare(baselinePath, &cfg);
+    if (regressions == -1) {
+        printf("Could not read baseline %s\n", baselinePath);
+        return 2;
+    }
+    if (regressions < 0) {
+        printf("\nComparison aborted: out of memory\n");
+        return 2;
+    }
+    return regressions > 0 ? 1 : 0;
+}
+
+/*
+ * Write n generated values to a raw binary file
+ * Usage: ./sort_test generate <file> <n> [--gen name] [--int64 | --lines]
+ *        [--prefix text]   (--lines: one decimal key per line after the prefix)
+ * int32 files use the registered generators; large files are produced in
+ * blocks, so structured shapes (sorted, ...) restart every block.
+ * --int64 writes uniformly random keys over the full 64-bit range.
+ */
+int runGenerateFile(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: ./sort_test generate <file> <n> [--gen name] [--int64 | --lines] [--prefix text]\n");
+        return 1;
+    }
+    const char *path = argv[0];
+    long long n = atoll(argv[1]);
+    const InputGenerator *gen = findInputGenerator("random");
+    int wide = 0, lines = 0;
+    const char *prefix = "";
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--gen") == 0 && i + 1 < argc) gen = findInputGenerator(argv[++i]);
+        else if (strcmp(argv[i], "--int64") == 0) wide = 1;
+        else if (strcmp(argv[i], "--lines") == 0) lines = 1;
+        else if (strcmp(argv[i], "--prefix") == 0 && i + 1 < argc) prefix = argv[++i];
+    }
+    if (!gen || n < 0) {
+        printGeneratorNames();
+        return 1;
+    }
+    
+    const long long block = 1 << 24;
+    size_t elemSize = wide ? sizeof(int64_t) : sizeof(int);
+    // An empty file needs no block buffer
+    void *buf = n > 0 ? malloc((n < block ? n : block) * elemSize) : NULL;
+    FILE *f = fopen(path, "wb");
+    if ((n > 0 && !buf) || !f) {
+        printf("Could not create %s\n", path);
+        free(buf);
+        if (f) fclose(f);
+        return 1;
+    }
+    for (long long done = 0; done < n; done += block) {
+        size_t count = (size_t)(n - done < block ? n - done : block);
+        if (wide) generateWideKeys64((int64_t *)buf, count);
+        else gen->generate((int *)buf, count);
+        int failed = 0;
+        if (lines) {
+            for (size_t i = 0; i < count && !failed; i++) {
+                failed = fprintf(f, "%s%d\n", prefix, ((int *)buf)[i]) < 0;
+            }
+        } else {
+            failed = fwrite(buf, elemSize, count, f) != count;
+        }
+        if (failed) {
+            printf("Write to %s failed\n", path);
+            fclose(f);
+            free(buf);
+            return 1;
+        }
+    }
+    free(buf);
+    if (fclose(f) != 0) return 1;
+    printf("Wrote %lld %s %s to %s\n", n, wide ? "wide int64" : gen->name, lines ? "lines" : "values", path);
+    return 0;
+}
+
+// Check that the lines of a text file are in order (compareSortStrings)
+static int verifyLinesFile(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        printf("Could not open %s\n", path);
+        return 1;
+    }
+    char *line = NULL, *last = NULL;
+    size_t lineCap = 0, lastCap = 0;
+    SortString prev = {NULL, 0};
+    long long total = 0;
+    int sorted = 1;
+    ssize_t got;
+    while (sorted && (got = getline(&line, &lineCap, f)) > 0) {
+        SortString cur = {line, (size_t)got - (line[got - 1] == '\n')};
+        if (total > 0 && compareSortStrings(&prev, &cur) > 0) sorted = 0;
+        // Keep this line as the previous one: swap the two buffers
+        char *t = last; last = line; line = t;
+        size_t c = lastCap; lastCap = lineCap; lineCap = c;
+        prev.ptr = last;
+        prev.len = cur.len;
+        total++;
+    }
+    fclose(f);
+    free(line);
+    free(last);
+    printf("%s: %lld lines checked, %s\n", path, total, sorted ? "SORTED" : "NOT SORTED");
+    return sorted ? 0 : 1;
+}
+
+// Stream through a raw int32 (or --int64, or --lines text) file and check
+// that it is sorted
+int runVerifyFile(int argc, char *argv[]) {
+    if (argc < 1) {
+        printf("Usage: ./sort_test verify <file> [--int64 | --lines]\n");
+        return 1;
+    }
+    if (argc > 1 && strcmp(argv[1], "--lines") == 0) return verifyLinesFile(argv[0]);
+    int wide = argc > 1 && strcmp(argv[1], "--int64") == 0;
+    FILE *f = fopen(argv[0], "rb");
+    if (!f) {
+        printf("Could not open %s\n", argv[0]);
+        return 1;
+    }
+    enum { BLOCK = 1 << 20 };
+    size_t elemSize = wide ? sizeof(int64_t) : sizeof(int);
+    // fread would drop a trailing partial element: report it instead
+    struct stat st;
+    if (fstat(fileno(f), &st) == 0 && st.st_size % elemSize != 0) {
+        printf("%s: size %lld is not a multiple of %zu bytes\n",
+               argv[0], (long long)st.st_size, elemSize);
+        fclose(f);
+        return 1;
+    }
+    char *buf = (char *)malloc(BLOCK * elemSize);
+    if (!buf) {
+        printf("Could not allocate a %zu byte read buffer\n", (size_t)BLOCK * elemSize);
+        fclose(f);
+        return 1;
+    }
+    long long total = 0;
+    int64_t last = INT64_MIN;
+    int sorted = 1;
+    size_t got;
+    while (sorted && (got = fread(buf, elemSize, BLOCK, f)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            int64_t v = wide ? ((int64_t *)buf)[i] : ((int *)buf)[i];
+            if (v < last) {
+                sorted = 0;
+                break;
+            }
+            last = v;
+        }
+        total += got;
+    }
+    fclose(f);
+    free(buf);
+    printf("%s: %lld values checked, %s\n", argv[0], total, sorted ? "SORTED" : "NOT SORTED");
+    return sorted ? 0 : 1;
+}
+
+/*
+ * Sort a raw little-endian file (or with --lines a text file, line by
+ * line) in place through mmap
+ * Usage: ./sort_test file <in> [out] [--int64 | --lines] [--algo name]
+ *        [--hugepage] [--no-sequential] [--no-verify]
+ */
+int runFileSort(int argc, char *argv[]) {
+    if (argc < 1) {
+        printf("Usage: ./sort_test file <in> [out] [--int64 | --lines] [--algo name] [--hugepage] [--no-sequential] [--no-verify]\n");
+        return 1;
+    }
+    const char *outPath = NULL;
+    const char *algoName = NULL;
+    FileSortConfig cfg;
+    fileSortConfigDefaults(&cfg);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--int64") == 0) cfg.element_size = 8;
+        else if (strcmp(argv[i], "--lines") == 0) cfg.lines = 1;
+        else if (strcmp(argv[i], "--algo") == 0 && i + 1 < argc) algoName = argv[++i];
+        else if (strcmp(argv[i], "--hugepage") == 0) cfg.advise_hugepage = 1;
+        else if (strcmp(argv[i], "--no-sequential") == 0) cfg.advise_sequential = 0;
+        else if (strcmp(argv[i], "--no-verify") == 0) cfg.verify = 0;
+        else if (argv[i][0] != '-' && !outPath) outPath = argv[i];
+        else {
+            printf("Unknown file sort option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (algoName) cfg.algorithm = algoName;
+    else if (cfg.lines) cfg.algorithm = "msd";
+    if (cfg.lines ? !findStringSortAlgorithm(cfg.algorithm)
+                  : cfg.element_size == 4 && !findSortAlgorithm(cfg.algorithm)) {
+        printGeneratorNames();
+        return 1;
+    }
+    
+    FileSortStats stats;
+    if (mmapSortFile(argv[0], outPath, &cfg, &stats) != 0) {
+        perror("File sort failed");
+        return 1;
+    }
+    if (cfg.lines) {
+        printf("Sorted %zu lines in %s with %s: copy %.1f ms, split and join %.1f ms, sort %.1f ms\n",
+               stats.elements, outPath ? outPath : argv[0], cfg.algorithm,
+               stats.copy_ms, stats.lines_ms, stats.sort_ms);
+        return 0;
+    }
+    printf("Sorted %zu %s values in %s with %s: copy %.1f ms, sort %.1f ms%s\n",
+           stats.elements, cfg.element_size == 8 ? "int64" : "int32",
+           outPath ? outPath : argv[0], cfg.algorithm, stats.copy_ms, stats.sort_ms,
+           cfg.advise_hugepage ? (stats.hugepage_ok ? " (huge pages advised)" : " (huge pages refused)") : "");
+    if (cfg.verify) printf("Verify pass %.1f ms: %s\n", stats.verify_ms, stats.sorted ? "SORTED" : "NOT SORTED");
+    return stats.sorted ? 0 : 1;
+}
+
+/*
+ * Sort a raw int32 file that may not fit in memory
+ * Usage: ./sort_test external <in> <out> [--mem MB] [--tmp dir]
+ */
+int runExternalSort(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: ./sort_test external <in> <out> [--mem MB] [--tmp dir]\n");
+        return 1;
+    }
+    ExternalSortConfig cfg;
+    externalSortConfigDefaults(&cfg);
+    for (int i = 2; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--mem") == 0 && hasValue) cfg.memory_bytes = (size_t)atoll(argv[++i]) << 20;
+        else if (strcmp(argv[i], "--tmp") == 0 && hasValue) cfg.temp_dir = argv[++i];
+        else {
+            printf("Unknown external sort option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    ExternalSortStats stats;
+    double start = now_ms();
+    if (externalSort(argv[0], argv[1], &cfg, &stats) != 0) {
+        printf("External sort of %s failed\n", argv[0]);
+        return 1;
+    }
+    printf("Sorted %zu values: %d runs (%.1f ms), %d merge pass(es) (%.1f ms), total %.1f ms\n",
+           stats.elements, stats.runs, stats.run_ms, stats.merge_passes, stats.merge_ms,
+           now_ms() - start);
+    return 0;
+}
+
+/*
+ * Merge pre-sorted raw int32 shards without re-sorting them
+ * Usage: ./sort_test merge <out> <shard1> <shard2> ...
+ */
+int runMergeFiles(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: ./sort_test merge <out> <shard1> [shard2 ...]\n");
+        return 1;
+    }
+    double start = now_ms();
+    long long written = mergeKWayFiles((const char **)(argv + 1), argc - 1, argv[0]);
+    if (written < 0) {
+        printf("Merge into %s failed\n", argv[0]);
+        return 1;
+    }
+    printf("Merged %d shards, %lld values into %s in %.1f ms\n",
+           argc - 1, written, argv[0], now_ms() - start);
+    return 0;
+}
+
+/*
+ * Measure this machine's thresholds and save them as the tuning profile
+ * Usage: ./sort_test tune [--n keys] [--gen name] [--out file]
+ *        [--cpu k] [--min-time ms] [--max-runs k]
+ */
+int runTune(int argc, char *argv[]) {
+    const char *outPath = sortTuningPath();
+    TuneConfig cfg;
+    tuneConfigDefaults(&cfg);
+    
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--n") == 0 && hasValue) cfg.n = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--gen") == 0 && hasValue) cfg.only_gen = argv[++i];
+        else if (strcmp(argv[i], "--out") == 0 && hasValue) outPath = argv[++i];
+        else if (strcmp(argv[i], "--cpu") == 0 && hasValue) cfg.bench.pin_cpu = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && hasValue) cfg.bench.min_time_ms = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-runs") == 0 && hasValue) cfg.bench.max_runs = atoi(argv[++i]);
+        else {
+            printf("Unknown tune option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (cfg.n == 0 || cfg.bench.max_runs < cfg.bench.min_runs) {
+        printf("Invalid tune parameters\n");
+        return 1;
+    }
+    if (cfg.only_gen && !findInputGenerator(cfg.only_gen)) {
+        printf("Unknown generator name\n");
+        printGeneratorNames();
+        return 1;
+    }
+    
+    if (benchPinCpu(cfg.bench.pin_cpu) < 0) printf("Warning: could not pin to a CPU, results may be noisier\n");
+    printf("Tuning with n=%zu, seed=%llu\n\n", cfg.n, (unsigned long long)getSortSeed());
+    
+    SortTuning best;
+    if (autotune(&cfg, &best) != 0) {
+        printf("Tuning failed (out of memory?)\n");
+        return 1;
+    }
+    
+    printf("\nBest: small_sort_max=%d radix_bits=%d parallel_grain=%zu radix_min_n=%d\n",
+           best.small_sort_max, best.radix_bits, best.parallel_grain, best.radix_min_n);
+    if (sortTuningSave(outPath, &best) != 0) {
+        printf("Could not write %s\n", outPath);
+        return 1;
+    }
+    printf("Profile saved to %s\n", outPath);
+    return 0;
+}
+
+/*
+ * Segmented batch sort against one quickSort call per segment
+ * Usage: ./sort_test segmented [segments] [--min len] [--max len]
+ * Segment lengths are uniform in [min, max] (default 8..2000)
+ */
+int runSegmented(int argc, char *argv[]) {
+    size_t segments = 100000;
+    size_t minLen = 8, maxLen = 2000;
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--min") == 0 && hasValue) minLen = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--max") == 0 && hasValue) maxLen = strtoull(argv[++i], NULL, 10);
+        else if (argv[i][0] != '-') segments = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown segmented option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (segments == 0 || maxLen < minLen) {
+        printf("Invalid segmented parameters\n");
+        return 1;
+    }
+    
+    size_t *offsets = (size_t *)malloc((segments + 1) * sizeof(size_t));
+    if (!offsets) return 1;
+    SortRng rng;
+    rngSeed(&rng, nextInputSeed());
+    offsets[0] = 0;
+    for (size_t s = 0; s < segments; s++) {
+        offsets[s + 1] = offsets[s] + minLen + (size_t)rngBounded(&rng, maxLen - minLen + 1);
+    }
+    size_t total = offsets[segments];
+    if (total == 0) {
+        printf("All %zu segments are empty: nothing to sort\n", segments);
+        free(offsets);
+        return 0;
+    }
+    int *original = (int *)malloc(total * sizeof(int));
+    int *keys = (int *)malloc(total * sizeof(int));
+    if (!original || !keys) {
+        printf("Could not allocate %zu keys\n", total);
+        free(offsets); free(original); free(keys);
+        return 1;
+    }
+    generateWideKeysArray(original, total);
+    
+    printf("Segmented sort: %zu segments of %zu..%zu keys (%zu keys), %d threads, seed=%llu\n\n",
+           segments, minLen, maxLen, total, sortThreadCount(), (unsigned long long)getSortSeed());
+    
+    copyArray(original, keys, total);
+    double start = now_ms();
+    for (size_t s = 0; s < segments; s++) {
+        quickSort(keys + offsets[s], 0, (ptrdiff_t)(offsets[s + 1] - offsets[s]) - 1);
+    }
+    double loopMs = now_ms() - start;
+    
+    copyArray(original, keys, total);
+    start = now_ms();
+    int status = segmentedSort(keys, offsets, segments);
+    double segmentedMs = now_ms() - start;
+    
+    int passed = status == 0;
+    for (size_t s = 0; s < segments && passed; s++) {
+        passed = isSorted(keys + offsets[s], offsets[s + 1] - offsets[s]);
+    }
+    printf("  %-24s %12.3f ms\n", "quickSort per segment", loopMs);
+    printf("  %-24s %12.3f ms  %s (%.1fx)\n", "segmentedSort", segmentedMs,
+           passed ? "PASS" : "FAIL", segmentedMs > 0 ? loopMs / segmentedMs : 0.0);
+    
+    free(offsets);
+    free(original);
+    free(keys);
+    return passed ? 0 : 1;
+}
+
+/*
+ * Generate -> sort -> verify for a batch of jobs, first one step after
+ * another, then through the asynchronous pipeline
+ * Usage: ./sort_test pipeline [n] [--jobs k] [--algo name] [--gen name]
+ *        [--depth d] [--cancel k]   (cancel every k-th job right after submitting it)
+ */
+static void countCompletion(SortJob *job, void *ctx) {
+    (void)job;
+    __atomic_add_fetch((int *)ctx, 1, __ATOMIC_RELAXED);
+}
+
+int runPipeline(int argc, char *argv[]) {
+    size_t n = 1000000;
+    size_t jobs = 20;
+    int depth = 0;
+    size_t cancelEvery = 0;
+    const char *algoName = "auto";
+    const char *genName = NULL;
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--jobs") == 0 && hasValue) jobs = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--algo") == 0 && hasValue) algoName = argv[++i];
+        else if (strcmp(argv[i], "--gen") == 0 && hasValue) genName = argv[++i];
+        else if (strcmp(argv[i], "--depth") == 0 && hasValue) depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--cancel") == 0 && hasValue) cancelEvery = strtoull(argv[++i], NULL, 10);
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown pipeline option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    const SortAlgorithm *alg = findSortAlgorithm(algoName);
+    const InputGenerator *onlyGen = genName ? findInputGenerator(genName) : NULL;
+    if (!alg || (genName && !onlyGen) || jobs == 0) {
+        printGeneratorNames();
+        return 1;
+    }
+    if (n == 0) {
+        printf("Pipeline jobs need at least one key\n");
+        return 1;
+    }
+    // Without --gen, jobs cycle through the five shapes of runAllTestCases
+    #define PIPELINE_SHAPES 5
+    const InputGenerator *genOf[PIPELINE_SHAPES];
+    for (int g = 0; g < PIPELINE_SHAPES; g++) genOf[g] = onlyGen ? onlyGen : &input_generators[g];
+    
+    printf("Pipeline: %zu %s jobs of %zu keys, %s input, seed=%llu\n\n", jobs, alg->name, n,
+           onlyGen ? onlyGen->name : "random/sorted/reverse/nearly/duplicates",
+           (unsigned long long)getSortSeed());
+    
+    // One step after another, as the benchmark drivers do
+    int *input = (int *)malloc(n * sizeof(int));
+    int *work = (int *)malloc(n * sizeof(int));
+    if (!input || !work) {
+        printf("Could not allocate two arrays of %zu elements\n", n);
+        free(input); free(work);
+        return 1;
+    }
+    int sequentialPassed = 1;
+    double start = now_ms();
+    for (size_t j = 0; j < jobs; j++) {
+        genOf[j % PIPELINE_SHAPES]->generate(input, n);
+        copyArray(input, work, n);
+        alg->sort(work, n);
+        if (!isSorted(work, n)) sequentialPassed = 0;
+    }
+    double sequentialMs = now_ms() - start;
+    free(input);
+    free(work);
+    
+    SortPipeline *pipeline = sortPipelineCreate(depth);
+    SortJob **handles = (SortJob **)calloc(jobs, sizeof(SortJob *));
+    if (!pipeline || !handles) {
+        sortPipelineDestroy(pipeline);
+        free(handles);
+        return 1;
+    }
+    int completions = 0;
+    size_t done = 0, cancelled = 0, failed = 0;
+    int passed = 1;
+    double stageMs[3] = {0.0, 0.0, 0.0};
+    start = now_ms();
+    for (size_t j = 0; j < jobs; j++) {
+        SortJobSpec spec = {alg->sort, genOf[j % PIPELINE_SHAPES]->generate, NULL, n, 0,
+                            countCompletion, &completions};
+        handles[j] = sortPipelineSubmit(pipeline, &spec);
+        if (!handles[j]) failed++;
+        else if (cancelEvery && j % cancelEvery == cancelEvery - 1) sortJobCancel(handles[j]);
+    }
+    for (size_t j = 0; j < jobs; j++) {
+        if (!handles[j]) continue;
+        SortJobResult res;
+        sortJobWait(handles[j], &res);
+        if (res.state == SORT_JOB_DONE) {
+            done++;
+            if (!res.passed) passed = 0;
+            stageMs[0] += res.generate_ms;
+            stageMs[1] += res.sort_ms;
+            stageMs[2] += res.verify_ms;
+        } else if (res.state == SORT_JOB_CANCELLED) {
+            cancelled++;
+        } else {
+            failed++;
+        }
+        sortJobRelease(handles[j]);
+    }
+    sortPipelineDrain(pipeline);
+    double pipelinedMs = now_ms() - start;
+    sortPipelineDestroy(pipeline);
+    free(handles);
+    
+    printf("  %-12s %12.3f ms  %8.2f jobs/s  %s\n", "sequential", sequentialMs,
+           sequentialMs > 0 ? jobs * 1000.0 / sequentialMs : 0.0, sequentialPassed ? "PASS" : "FAIL");
+    printf("  %-12s %12.3f ms  %8.2f jobs/s  %s", "pipelined", pipelinedMs,
+           pipelinedMs > 0 ? done * 1000.0 / pipelinedMs : 0.0, passed ? "PASS" : "FAIL");
+    if (done == jobs && pipelinedMs > 0) printf(" (%.2fx)", sequentialMs / pipelinedMs);
+    printf("\n");
+    printf("  stage time: generate %.1f ms, sort %.1f ms, verify %.1f ms\n",
+           stageMs[0], stageMs[1], stageMs[2]);
+    printf("  %zu done, %zu cancelled, %zu failed, %d completion callbacks\n",
+           done, cancelled, failed, completions);
+    return passed && sequentialPassed && failed == 0 && (size_t)completions == done + cancelled ? 0 : 1;
+}
+
+/*
+ * The same sort under every memory policy: page mode x first touch. Both
+ * the driver's arrays and the algorithm's scratch buffers follow the policy
+ * Usage: ./sort_test memory [n] [--algo name] [--gen name] [--max-runs k]
+ */
+int runMemoryComparison(int argc, char *argv[]) {
+    size_t n = 10000000;
+    const char *algoName = "radix_lsd";
+    const char *genName = "random";
+    BenchConfig cfg;
+    benchConfigDefaults(&cfg);
+    cfg.min_time_ms = 0.0;
+    cfg.max_runs = 5;
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--algo") == 0 && hasValue) algoName = argv[++i];
+        else if (strcmp(argv[i], "--gen") == 0 && hasValue) genName = argv[++i];
+        else if (strcmp(argv[i], "--max-runs") == 0 && hasValue) cfg.max_runs = atoi(argv[++i]);
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown memory option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    const SortAlgorithm *alg = findSortAlgorithm(algoName);
+    const InputGenerator *gen = findInputGenerator(genName);
+    if (!alg || !gen || n == 0 || cfg.max_runs < cfg.min_runs) {
+        printGeneratorNames();
+        return 1;
+    }
+    
+    const SortMemoryPolicy saved = *sortMemoryPolicy();
+    printf("Memory policies: %s on %zu %s keys, %d threads, hugetlb pool %s, seed=%llu\n\n",
+           alg->name, n, gen->name, sortThreadCount(),
+           sortHugetlbAvailable() ? "available" : "empty (hugetlb falls back to thp)",
+           (unsigned long long)getSortSeed());
+    printf("  %-8s %-12s %12s %12s %12s %8s  %s\n",
+           "Pages", "First touch", "Min (ms)", "Median (ms)", "P90 (ms)", "Speedup", "Test");
+    
+    int passed = 1;
+    double baseline = 0.0;
+    for (int mode = SORT_PAGES_NORMAL; mode <= SORT_PAGES_HUGETLB; mode++) {
+        for (int touch = 0; touch <= 1; touch++) {
+            SortMemoryPolicy policy = saved;
+            policy.pages = (SortPageMode)mode;
+            policy.first_touch = touch;
+            setSortMemoryPolicy(&policy);
+            
+            int *input = (int *)sortBufferAlloc(n * sizeof(int));
+            int *work = (int *)sortBufferAlloc(n * sizeof(int));
+            if (!input || !work) {
+                printf("Could not allocate two arrays of %zu elements\n", n);
+                sortBufferFree(input);
+                sortBufferFree(work);
+                setSortMemoryPolicy(&saved);
+                return 1;
+            }
+            // Every policy sorts the same keys
+            setSortSeed(getSortSeed());
+            gen->generate(input, n);
+            BenchResult res = benchMeasure(alg, gen->name, input, work, n, &cfg);
+            if (baseline == 0.0) baseline = res.median_ms;
+            printf("  %-8s %-12s %12.4f %12.4f %12.4f %7.2fx  %s\n",
+                   sortPageModeName(policy.pages), touch ? "on" : "off", res.min_ms,
+                   res.median_ms, res.p90_ms, res.median_ms > 0 ? baseline / res.median_ms : 0.0,
+                   res.passed ? "PASS" : "FAIL");
+            fflush(stdout);
+            if (!res.passed) passed = 0;
+            benchFreeResults(&res, 1);
+            sortBufferFree(input);
+            sortBufferFree(work);
+        }
+    }
+    setSortMemoryPolicy(&saved);
+    return passed ? 0 : 1;
+}
+
+/*
+ * Fused grouping (sortUnique, sortRunLengths, sortDistinctCount) against
+ * sortAuto followed by a separate sweep over the sorted keys
+ * Usage: ./sort_test group [n] [--gen name] [--runs k]
+ */
+static size_t sweepRuns(int arr[], size_t n, size_t counts[], int compact) {
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i > 0 && arr[i] == arr[i - 1]) {
+            if (counts) counts[m - 1]++;
+            continue;
+        }
+        if (counts) counts[m] = 1;
+        if (compact) arr[m] = arr[i];
+        m++;
+    }
+    return m;
+}
+
+int runGroup(int argc, char *argv[]) {
+    size_t n = 10000000;
+    const char *genName = "duplicates";
+    int runs = 5;
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--gen") == 0 && hasValue) genName = argv[++i];
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue) runs = atoi(argv[++i]);
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown group option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    const InputGenerator *gen = findInputGenerator(genName);
+    if (!gen || n == 0 || runs < 1) {
+        printGeneratorNames();
+        return 1;
+    }
+    
+    int *original = (int *)sortBufferAlloc(n * sizeof(int));
+    int *keys = (int *)sortBufferAlloc(n * sizeof(int));
+    int *expected = (int *)sortBufferAlloc(n * sizeof(int));
+    int *unique = (int *)sortBufferAlloc(n * sizeof(int));
+    size_t *counts = (size_t *)sortBufferAlloc(n * sizeof(size_t));
+    size_t *expectedCounts = (size_t *)sortBufferAlloc(n * sizeof(size_t));
+    if (!original || !keys || !expected || !unique || !counts || !expectedCounts) {
+        printf("Could not allocate the arrays for %zu keys\n", n);
+        sortBufferFree(original); sortBufferFree(keys); sortBufferFree(expected);
+        sortBufferFree(unique); sortBufferFree(counts); sortBufferFree(expectedCounts);
+        return 1;
+    }
+    gen->generate(original, n);
+    
+    // Reference: the sorted keys and their runs
+    copyArray(original, expected, n);
+    sortAuto(expected, n, NULL);
+    copyArray(expected, unique, n);
+    size_t distinct = sweepRuns(unique, n, expectedCounts, 1);
+    
+    printf("Fused grouping: %zu %s keys, %zu distinct, best of %d runs, seed=%llu\n\n",
+           n, gen->name, distinct, runs, (unsigned long long)getSortSeed());
+    printf("  %-18s %16s %16s %8s  %s\n", "Operation", "Sort+sweep (ms)", "Fused (ms)", "Speedup", "Test");
+    
+    const char *names[] = {"sortUnique", "sortRunLengths", "sortDistinctCount"};
+    int passed = 1;
+    for (int op = 0; op < 3; op++) {
+        double separateMs = 0.0, fusedMs = 0.0;
+        int ok = 1;
+        for (int r = 0; r < runs; r++) {
+            copyArray(original, keys, n);
+            double start = now_ms();
+            sortAuto(keys, n, NULL);
+            sweepRuns(keys, n, op == 1 ? counts : NULL, op != 2);
+            double ms = now_ms() - start;
+            if (r == 0 || ms < separateMs) separateMs = ms;
+            
+            copyArray(original, keys, n);
+            start = now_ms();
+            size_t m = op == 0 ? sortUnique(keys, n)
+                     : op == 1 ? sortRunLengths(keys, n, counts)
+                               : sortDistinctCount(keys, n);
+            ms = now_ms() - start;
+            if (r == 0 || ms < fusedMs) fusedMs = ms;
+            
+            // The distinct keys in keys[0..m), or all n keys sorted for the count
+            if (m != distinct ||
+                memcmp(keys, op == 2 ? expected : unique, (op == 2 ? n : m) * sizeof(int)) != 0 ||
+                (op == 1 && memcmp(counts, expectedCounts, m * sizeof(size_t)) != 0)) ok = 0;
+        }
+        printf("  %-18s %16.3f %16.3f %7.2fx  %s\n", names[op], separateMs, fusedMs,
+               fusedMs > 0 ? separateMs / fusedMs : 0.0, ok ? "PASS" : "FAIL");
+        fflush(stdout);
+        if (!ok) passed = 0;
+    }
+    
+    sortBufferFree(original);
+    sortBufferFree(keys);
+    sortBufferFree(expected);
+    sortBufferFree(unique);
+    sortBufferFree(counts);
+    sortBufferFree(expectedCounts);
+    return passed ? 0 : 1;
+}
+
+/*
+ * Keys arriving in batches: append + quickSort of the whole array after
+ * every batch, against the sorted container (one main array, and leveled)
+ * Usage: ./sort_test container [n] [--batch k] [--buffer b] [--queries q]
+ */
+int runContainer(int argc, char *argv[]) {
+    size_t n = 100000, batch = 1000, queries = 100000;
+    SortedContainerConfig cfg;
+    sortedContainerConfigDefaults(&cfg);
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--batch") == 0 && hasValue) batch = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--buffer") == 0 && hasValue) cfg.buffer_keys = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--queries") == 0 && hasValue) queries = strtoull(argv[++i], NULL, 10);
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown container option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (n == 0 || batch == 0) {
+        printf("Invalid container parameters\n");
+        return 1;
+    }
+    
+    int *input = (int *)malloc(n * sizeof(int));
+    int *sorted = (int *)malloc(n * sizeof(int));
+    int *range = (int *)malloc(n * sizeof(int));
+    if (!input || !sorted || !range) {
+        printf("Could not allocate the arrays for %zu keys\n", n);
+        free(input); free(sorted); free(range);
+        return 1;
+    }
+    generateWideKeysArray(input, n);
+    
+    printf("Sorted container: %zu keys in batches of %zu, buffer %zu, %zu queries, seed=%llu\n\n",
+           n, batch, cfg.buffer_keys, queries, (unsigned long long)getSortSeed());
+    printf("  %-22s %14s %6s %14s  %s\n", "Structure", "Inserts (ms)", "Runs", "Queries (ms)", "Test");
+    
+    // What callers do today: the reference result too
+    double start = now_ms();
+    for (size_t done = 0; done < n; ) {
+        size_t take = n - done < batch ? n - done : batch;
+        copyArray(input + done, sorted + done, take);
+        done += take;
+        quickSort(sorted, 0, (ptrdiff_t)done - 1);
+    }
+    printf("  %-22s %14.3f %6s %14s  %s\n", "append + quickSort", now_ms() - start, "1", "-",
+           isSorted(sorted, n) ? "PASS" : "FAIL");
+    
+    int passed = 1;
+    for (int leveled = 0; leveled <= 1; leveled++) {
+        cfg.leveled = leveled;
+        SortedContainer *sc = sortedContainerCreate(&cfg);
+        if (!sc) {
+            passed = 0;
+            break;
+        }
+        int ok = 1;
+        start = now_ms();
+        for (size_t done = 0; done < n && ok; done += batch) {
+            size_t take = n - done < batch ? n - done : batch;
+            ok = sortedContainerInsertBatch(sc, input + done, take) == 0;
+        }
+        double insertMs = now_ms() - start;
+        int runs = sortedContainerRuns(sc);
+        
+        // Rank of a present key, and the 16 keys from there on
+        SortRng rng;
+        rngSeed(&rng, getSortSeed());
+        start = now_ms();
+        for (size_t q = 0; q < queries && ok; q++) {
+            size_t at = (size_t)rngBounded(&rng, n);
+            int key = sorted[at];
+            size_t rank = sortedContainerRank(sc, key);
+            size_t end = at + 16 < n ? at + 16 : n - 1;
+            size_t got = sortedContainerRange(sc, key, sorted[end], range, n);
+            ok = sortedContainerContains(sc, key) && sorted[rank] == key &&
+                 (rank == 0 || sorted[rank - 1] < key) && got >= end - rank + 1 &&
+                 memcmp(range, sorted + rank, got * sizeof(int)) == 0;
+        }
+        double queryMs = now_ms() - start;
+        
+        ok = ok && sortedContainerSize(sc) == n &&
+             sortedContainerRange(sc, INT_MIN, INT_MAX, range, n) == n &&
+             memcmp(range, sorted, n * sizeof(int)) == 0;
+        printf("  %-22s %14.3f %6d %14.3f  %s\n", leveled ? "container (leveled)" : "container (one array)",
+               insertMs, runs, queryMs, ok ? "PASS" : "FAIL");
+        fflush(stdout);
+        if (!ok) passed = 0;
+        sortedContainerDestroy(sc);
+    }
+    
+    free(input);
+    free(sorted);
+    free(range);
+    return passed ? 0 : 1;
+}
+
+/*
+ * First m keys in order: a full sortAuto against the lazy sorted iterator,
+ * for a growing m (or just --take m)
+ * Usage: ./sort_test lazy [n] [--gen name] [--take m]
+ */
+int runLazy(int argc, char *argv[]) {
+    size_t n = 10000000, take = 0;
+    const char *genName = "random";
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--gen") == 0 && hasValue) genName = argv[++i];
+        else if (strcmp(argv[i], "--take") == 0 && hasValue) take = strtoull(argv[++i], NULL, 10);
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown lazy option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    const InputGenerator *gen = findInputGenerator(genName);
+    if (!gen || n == 0 || take > n) {
+        printGeneratorNames();
+        return 1;
+    }
+    
+    int *original = (int *)sortBufferAlloc(n * sizeof(int));
+    int *keys = (int *)sortBufferAlloc(n * sizeof(int));
+    int *expected = (int *)sortBufferAlloc(n * sizeof(int));
+    int *page = (int *)sortBufferAlloc(n * sizeof(int));
+    if (!original || !keys || !expected || !page) {
+        printf("Could not allocate the arrays for %zu keys\n", n);
+        sortBufferFree(original); sortBufferFree(keys);
+        sortBufferFree(expected); sortBufferFree(page);
+        return 1;
+    }
+    gen->generate(original, n);
+    
+    copyArray(original, expected, n);
+    double start = now_ms();
+    sortAuto(expected, n, NULL);
+    double fullMs = now_ms() - start;
+    
+    printf("Lazy sorting: first m of %zu %s keys, full sortAuto %.3f ms, seed=%llu\n\n",
+           n, gen->name, fullMs, (unsigned long long)getSortSeed());
+    printf("  %12s %14s %8s  %s\n", "m", "Iterator (ms)", "Speedup", "Test");
+    
+    int passed = 1;
+    for (size_t m = take ? take : 10; ; m *= 10) {
+        if (m > n) m = n;
+        copyArray(original, keys, n);
+        SortedIterator it;
+        if (sortedIteratorInit(&it, keys, n) != 0) {
+            passed = 0;
+            break;
+        }
+        start = now_ms();
+        size_t got = sortedIteratorTake(&it, page, m);
+        double lazyMs = now_ms() - start;
+        sortedIteratorFree(&it);
+        
+        int ok = got == m && memcmp(page, expected, m * sizeof(int)) == 0;
+        printf("  %12zu %14.3f %7.2fx  %s\n", m, lazyMs, lazyMs > 0 ? fullMs / lazyMs : 0.0,
+               ok ? "PASS" : "FAIL");
+        fflush(stdout);
+        if (!ok) passed = 0;
+        if (take || m == n) break;
+    }
+    
+    sortBufferFree(original);
+    sortBufferFree(keys);
+    sortBufferFree(expected);
+    sortBufferFree(page);
+    return passed ? 0 : 1;
+}
+
+/*
+ * String engines on n text keys: a shared prefix of --prefix bytes, then
+ * a decimal key from the generator
+ * Usage: ./sort_test strings [n] [--gen name] [--prefix len] [--runs k]
+ */
+int runStrings(int argc, char *argv[]) {
+    size_t n = 1000000, prefixLen = 0;
+    const char *genName = "random";
+    int runs = 3;
+    for (int i = 0; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--gen") == 0 && hasValue) genName = argv[++i];
+        else if (strcmp(argv[i], "--prefix") == 0 && hasValue) prefixLen = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue) runs = atoi(argv[++i]);
+        else if (argv[i][0] != '-') n = strtoull(argv[i], NULL, 10);
+        else {
+            printf("Unknown strings option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+    const InputGenerator *gen = findInputGenerator(genName);
+    if (!gen || n == 0 || runs < 1) {
+        printGeneratorNames();
+        return 1;
+    }
+    
+    // Keys back to back in one block; 12 bytes hold any int in decimal
+    size_t stride = prefixLen + 12;
+    int *values = (int *)malloc(n * sizeof(int));
+    char *text = (char *)malloc(n * stride);
+    SortString *input = (SortString *)malloc(n * sizeof(SortString));
+    SortString *work = (SortString *)malloc(n * sizeof(SortString));
+    if (!values || !text || !input || !work) {
+        printf("Could not allocate %zu keys\n", n);
+        free(values); free(text); free(input); free(work);
+        return 1;
+    }
+    gen->generate(values, n);
+    static const char path[] = "https://example.org/catalog/items/";
+    for (size_t i = 0; i < n; i++) {
+        char *key = text + i * stride;
+        for (size_t k = 0; k < prefixLen; k++) key[k] = path[k % (sizeof(path) - 1)];
+        input[i].ptr = key;
+        input[i].len = prefixLen + (size_t)snprintf(key + prefixLen, 12, "%d", values[i]);
+    }
+    free(values);
+    
+    printf("String sort: %zu %s keys with a %zu-byte shared prefix, best of %d runs, seed=%llu\n\n",
+           n, gen->name, prefixLen, runs, (unsigned long long)getSortSeed());
+    printf("  %-10s %12s %8s  %s\n", "Algorithm", "Time (ms)", "Speedup", "Test");
+    
+    double baseline = 0.0;
+    int passed = 1;
+    for (int a = string_algorithm_count - 1; a >= 0; a--) {
+        const StringSortAlgorithm *alg = &string_algorithms[a];
+        double best = 0.0;
+        int ok = 1;
+        for (int r = 0; r < runs; r++) {
+            memcpy(work, input, n * sizeof(SortString));
+            double start = now_ms();
+            ok = alg->sort(work, n) == 0 && ok;
+            double ms = now_ms() - start;
+            if (r == 0 || ms < best) best = ms;
+        }
+        // Sorted, and still holding every key once (the pointers differ)
+        uint64_t before = 0, after = 0;
+        for (size_t i = 0; i < n; i++) {
+            before += (uint64_t)(uintptr_t)input[i].ptr * 0x9E3779B97F4A7C15ULL;
+            after += (uint64_t)(uintptr_t)work[i].ptr * 0x9E3779B97F4A7C15ULL;
+        }
+        ok = ok && isSortedStrings(work, n) && before == after;
+        if (strcmp(alg->name, "qsort") == 0) baseline = best;
+        printf("  %-10s %12.3f %7.2fx  %s\n", alg->name, best,
+               best > 0 && baseline > 0 ? baseline / best : 0.0, ok ? "PASS" : "FAIL");
+        fflush(stdout);
+        if (!ok) passed = 0;
+    }
+    
+    free(text);
+    free(input);
+    free(work);
+    return passed ? 0 : 1;
+}
+
+#ifdef SORT_TRACE
+// Dump the collected trace once the run is over
+// (SORT_TRACE_FILE overrides the default location)
+void writeTrace(void) {
+    const char *path = getenv("SORT_TRACE_FILE");
+    if (!path) path = "output/trace.json";
+    if (trace_write_json(path) == 0) {
+        fprintf(stderr, "Trace written to %s\n", path);
+    } else {
+        fprintf(stderr, "Could not write trace to %s\n", path);
+    }
+}
+#endif
+
+/*
+ * Options valid in every mode, removed from argv before mode dispatch:
+ *   --seed N     reproduce the inputs of an earlier run (default: time)
+ *   --threads N  worker threads for parallel code (default: all CPUs)
+ */
+int parseGlobalOptions(int argc, char *argv[]) {
+    uint64_t seed = (uint64_t)time(NULL);
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            setSortThreadCount(atoi(argv[++i]));
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argv[kept] = NULL;
+    setSortSeed(seed);
+    return kept;
 }
 
 int main(int argc, char *argv[]) {
-    int n = 1000;
+    size_t n = 1000;
     int benchmark_mode = 0;
     int analysis_mode = 0;
     int maxVal = 10000;
-    int k = 5;
+    
+    argc = parseGlobalOptions(argc, argv);
     
     if (argc > 1) {
         if (strcmp(argv[1], "stability") == 0) {
@@ -197,19 +1506,53 @@ int main(int argc, char *argv[]) {
             return 0;
         } else if (strcmp(argv[1], "analysis") == 0) {
             analysis_mode = 1;
-            n = (argc > 2) ? atoi(argv[2]) : 1000;
+            n = (argc > 2) ? strtoull(argv[2], NULL, 10) : 1000;
         } else if (strcmp(argv[1], "guide") == 0) {
             printUsageGuide();
             return 0;
+        } else if (strcmp(argv[1], "bench") == 0) {
+            return runBenchmarkSuite(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "matrix") == 0) {
+            return runBenchmarkMatrix(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "compare") == 0) {
+            return runBenchmarkCompare(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "generate") == 0) {
+            return runGenerateFile(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "verify") == 0) {
+            return runVerifyFile(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "file") == 0) {
+            return runFileSort(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "merge") == 0) {
+            return runMergeFiles(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "external") == 0) {
+            return runExternalSort(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "tune") == 0) {
+            return runTune(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "segmented") == 0) {
+            return runSegmented(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "pipeline") == 0) {
+            return runPipeline(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "memory") == 0) {
+            return runMemoryComparison(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "group") == 0) {
+            return runGroup(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "container") == 0) {
+            return runContainer(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "lazy") == 0) {
+            return runLazy(argc - 2, argv + 2);
+        } else if (strcmp(argv[1], "strings") == 0) {
+            return runStrings(argc - 2, argv + 2);
         } else {
-            n = atoi(argv[1]);
+            n = strtoull(argv[1], NULL, 10);
         }
     }
     if (argc > 2 && strcmp(argv[2], "benchmark") == 0) {
         benchmark_mode = 1;
     }
     
-    srand(time(NULL));
+#ifdef SORT_TRACE
+    atexit(writeTrace);
+#endif
     
     if (analysis_mode) {
         runAllTestCases(n);
@@ -221,9 +1564,19 @@ int main(int argc, char *argv[]) {
     // Original benchmark mode
     int *original = (int *)malloc(n * sizeof(int));
     int *arr = (int *)malloc(n * sizeof(int));
+    if (!original || !arr) {
+        printf("Could not allocate two arrays of %zu elements\n", n);
+        free(original);
+        free(arr);
+        return 1;
+    }
     
     generateRandomArray(original, n, maxVal);
     
+    // Radix Sort needs as many decimal digits as the largest key has
+    int k = 1;
+    for (int v = maxVal; v >= 10; v /= 10) k++;
+    
     if (!benchmark_mode) {
         printf("=== Sorting Algorithms Test ===\n\n");
         printf("Original array (first 20 elements): ");
@@ -246,7 +1599,8 @@ int main(int argc, char *argv[]) {
     
     copyArray(original, arr, n);
     double time_radix = measureTimeRadix(arr, n, k);
-    if (!benchmark_mode) printf("Radix Sort: %s (%.3f ms)\n", isSorted(arr, n) ? "PASS" : "FAIL", time_radix);
+    size_t mem_radix = memory_peak;
+    if (!benchmark_mode) printf("Radix Sort: %s (%.3f ms, peak %zu bytes)\n", isSorted(arr, n) ? "PASS" : "FAIL", time_radix, mem_radix);
     
     copyArray(original, arr, n);
     double time_quick = measureTimeQuick(arr, n);
@@ -258,17 +1612,21 @@ int main(int argc, char *argv[]) {
     
     copyArray(original, arr, n);
     double time_bucket = measureTimeBucket(arr, n, maxVal);
-    if (!benchmark_mode) printf("Bucket Sort: %s (%.3f ms)\n", isSorted(arr, n) ? "PASS" : "FAIL", time_bucket);
+    size_t mem_bucket = memory_peak;
+    if (!benchmark_mode) printf("Bucket Sort: %s (%.3f ms, peak %zu bytes)\n", isSorted(arr, n) ? "PASS" : "FAIL", time_bucket, mem_bucket);
     
     if (benchmark_mode) {
-        printf("%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f\n",
+        // In-place algorithms allocate nothing, so only radix and bucket
+        // get a peak-memory column
+        printf("%zu,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%.6f,%zu,%zu\n",
                n, time_bubble, time_bubble_opt, time_gnome, time_radix,
-               time_quick, time_heap, time_bucket);
+               time_quick, time_heap, time_bucket, mem_radix, mem_bucket);
     } else {
         printf("\n=== All tests completed ===\n");
         printf("\nRun './sort_test analysis' for comprehensive analysis\n");
         printf("Run './sort_test stability' for stability demonstration\n");
         printf("Run './sort_test guide' for algorithm selection guide\n");
+        printf("Run './sort_test bench [n]' for repeated, statistically summarized timings\n");
     }
     
     free(original);
@@ -0,0 +1,268 @@
+/*
+ * Sort Server Test Client
+ *
+ * Stands in for the programs that use sort_server: each client thread
+ * opens its own connection and keeps up to `depth` requests in flight,
+ * each on its own memfd payload. Every answer is checked (order and key
+ * checksum), and the round trip is timed on the client side.
+ * Usage: ./sort_client [--socket path] [--clients c] [--jobs j] [--n keys]
+ *                      [--op sort|topk|merge] [--k keys] [--runs r]
+ *                      [--depth d] [--shutdown]
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/sorting.h"
+
+typedef struct {
+    const char *socket_path;
+    int clients;
+    size_t jobs;              // Per client
+    size_t n;
+    SortOp op;
+    size_t k;
+    uint32_t runs;
+    int depth;                // Requests in flight per connection
+} ClientConfig;
+
+typedef struct {
+    int payload;
+    int *keys;
+    uint64_t id;
+    uint64_t checksum;
+    double sent_ms;
+} ClientSlot;
+
+typedef struct {
+    const ClientConfig *cfg;
+    int index;
+    double *latencies;        // Round trips in ms, one per job
+    size_t done;
+    size_t failures;
+    uint64_t batch_sum;       // Sum of the server-reported batch sizes
+    double queue_ms;          // Sum of the server-reported queueing times
+    int error;                // Lost the connection or could not start
+} ClientThread;
+
+static uint64_t keyChecksum(const int keys[], size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += (uint64_t)(uint32_t)keys[i] * 0x9E3779B97F4A7C15ULL;
+    return sum;
+}
+
+static void fillSlot(const ClientConfig *cfg, ClientSlot *slot, uint64_t *runLens, SortRng *rng) {
+    if (cfg->op == SORT_OP_MERGE) {
+        size_t pos = 0;
+        for (uint32_t r = 0; r < cfg->runs; r++) {
+            size_t len = cfg->n / cfg->runs + (r < cfg->n % cfg->runs ? 1 : 0);
+            int value = (int)rngBounded(rng, 1u << 20);
+            for (size_t i = 0; i < len; i++) {
+                slot->keys[pos + i] = value;
+                value += (int)rngBounded(rng, 4);
+            }
+            runLens[r] = len;
+            pos += len;
+        }
+    } else {
+        for (size_t i = 0; i < cfg->n; i++) slot->keys[i] = (int)rngBounded(rng, (uint64_t)1 << 31);
+    }
+    slot->checksum = keyChecksum(slot->keys, cfg->n);
+}
+
+// Sorted for sort/merge; for top-k the prefix is sorted and nothing
+// after it is smaller than its last key
+static int checkSlot(const ClientConfig *cfg, const ClientSlot *slot) {
+    if (keyChecksum(slot->keys, cfg->n) != slot->checksum) return 0;
+    if (cfg->op != SORT_OP_TOPK) return isSorted(slot->keys, cfg->n);
+    size_t k = cfg->k < cfg->n ? cfg->k : cfg->n;
+    if (!isSorted(slot->keys, k)) return 0;
+    for (size_t i = k; k > 0 && i < cfg->n; i++) {
+        if (slot->keys[i] < slot->keys[k - 1]) return 0;
+    }
+    return 1;
+}
+
+static void *clientMain(void *arg) {
+    ClientThread *t = (ClientThread *)arg;
+    const ClientConfig *cfg = t->cfg;
+    int sock = sortClientConnect(cfg->socket_path);
+    ClientSlot *slots = (ClientSlot *)calloc((size_t)cfg->depth, sizeof(ClientSlot));
+    int *freeSlots = (int *)malloc((size_t)cfg->depth * sizeof(int));
+    uint64_t *runLens = (uint64_t *)malloc((cfg->runs ? cfg->runs : 1) * sizeof(uint64_t));
+    int ready = sock >= 0 && slots && freeSlots && runLens;
+    int freeCount = 0;
+    for (int s = 0; s < cfg->depth && ready; s++) {
+        slots[s].payload = sortPayloadCreate(cfg->n, &slots[s].keys);
+        if (slots[s].payload < 0) {
+            ready = 0;
+            break;
+        }
+        slots[s].id = UINT64_MAX;
+        freeSlots[freeCount++] = s;
+    }
+    if (!ready) t->error = 1;
+
+    SortRng rng;
+    rngSeed(&rng, getSortSeed() + (uint64_t)t->index);
+    size_t issued = 0;
+    while (ready && t->done < cfg->jobs) {
+        while (issued < cfg->jobs && freeCount > 0) {
+            ClientSlot *slot = &slots[freeSlots[--freeCount]];
+            fillSlot(cfg, slot, runLens, &rng);
+            SortRequest req = {(uint32_t)cfg->op, cfg->op == SORT_OP_MERGE ? cfg->runs : 0,
+                               ((uint64_t)t->index << 32) | issued, cfg->n, cfg->k};
+            slot->id = req.id;
+            slot->sent_ms = now_ms();
+            if (sortClientSend(sock, &req, slot->payload, runLens) != 0) {
+                ready = 0;
+                break;
+            }
+            issued++;
+        }
+        SortResponse resp;
+        if (!ready || sortClientReceive(sock, &resp) != 0) {
+            t->error = 1;
+            break;
+        }
+        double received = now_ms();
+        int s = 0;
+        while (s < cfg->depth && slots[s].id != resp.id) s++;
+        if (s == cfg->depth) {
+            t->error = 1;
+            break;
+        }
+        if (resp.status != 0 || !checkSlot(cfg, &slots[s])) t->failures++;
+        t->latencies[t->done++] = received - slots[s].sent_ms;
+        t->batch_sum += resp.batch;
+        t->queue_ms += resp.queue_ms;
+        slots[s].id = UINT64_MAX;
+        freeSlots[freeCount++] = s;
+    }
+
+    for (int s = 0; slots && s < cfg->depth; s++) {
+        if (slots[s].keys || slots[s].payload > 0) sortPayloadDestroy(slots[s].payload, slots[s].keys, cfg->n);
+    }
+    free(slots);
+    free(freeSlots);
+    free(runLens);
+    if (sock >= 0) close(sock);
+    return NULL;
+}
+
+static int compareDouble(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// STATS or SHUTDOWN on a connection of its own; 0 on success
+static int controlRequest(const char *path, SortOp op, SortResponse *resp) {
+    int sock = sortClientConnect(path);
+    if (sock < 0) return -1;
+    SortRequest req = {(uint32_t)op, 0, 0, 0, 0};
+    int status = sortClientSend(sock, &req, -1, NULL) == 0 && sortClientReceive(sock, resp) == 0 ? 0 : -1;
+    close(sock);
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+    const char *envPath = getenv("SORT_SERVER_SOCKET");
+    ClientConfig cfg = {envPath ? envPath : SORT_SERVICE_SOCKET, 4, 1000, 1000, SORT_OP_SORT, 10, 8, 8};
+    int stopServer = 0;
+    for (int i = 1; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--socket") == 0 && hasValue) cfg.socket_path = argv[++i];
+        else if (strcmp(argv[i], "--clients") == 0 && hasValue) cfg.clients = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--jobs") == 0 && hasValue) cfg.jobs = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--n") == 0 && hasValue) cfg.n = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--k") == 0 && hasValue) cfg.k = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--runs") == 0 && hasValue) cfg.runs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--depth") == 0 && hasValue) cfg.depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--shutdown") == 0) stopServer = 1;
+        else if (strcmp(argv[i], "--op") == 0 && hasValue) {
+            const char *op = argv[++i];
+            if (strcmp(op, "sort") == 0) cfg.op = SORT_OP_SORT;
+            else if (strcmp(op, "topk") == 0) cfg.op = SORT_OP_TOPK;
+            else if (strcmp(op, "merge") == 0) cfg.op = SORT_OP_MERGE;
+            else {
+                printf("Unknown op: %s (sort, topk or merge)\n", op);
+                return 1;
+            }
+        } else {
+            printf("Usage: %s [--socket path] [--clients c] [--jobs j] [--n keys] [--op sort|topk|merge]\n"
+                   "       [--k keys] [--runs r] [--depth d] [--shutdown]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.clients < 1 || cfg.depth < 1 || cfg.runs < 1 || cfg.runs > SORT_SERVICE_MAX_RUNS) {
+        printf("Invalid client parameters\n");
+        return 1;
+    }
+
+    printf("sort_client: %d clients x %zu %s jobs of %zu keys, %d in flight each, seed=%llu\n",
+           cfg.clients, cfg.jobs,
+           cfg.op == SORT_OP_SORT ? "sort" : cfg.op == SORT_OP_TOPK ? "topk" : "merge",
+           cfg.n, cfg.depth, (unsigned long long)getSortSeed());
+
+    ClientThread *threads = (ClientThread *)calloc((size_t)cfg.clients, sizeof(ClientThread));
+    pthread_t *ids = (pthread_t *)malloc((size_t)cfg.clients * sizeof(pthread_t));
+    if (!threads || !ids) return 1;
+    double start = now_ms();
+    for (int c = 0; c < cfg.clients; c++) {
+        threads[c].cfg = &cfg;
+        threads[c].index = c;
+        threads[c].latencies = (double *)malloc((cfg.jobs ? cfg.jobs : 1) * sizeof(double));
+        if (!threads[c].latencies || pthread_create(&ids[c], NULL, clientMain, &threads[c]) != 0) {
+            printf("Could not start client %d\n", c);
+            return 1;
+        }
+    }
+    for (int c = 0; c < cfg.clients; c++) pthread_join(ids[c], NULL);
+    double wallMs = now_ms() - start;
+
+    size_t total = 0, failures = 0, errors = 0;
+    uint64_t batchSum = 0;
+    double queueSum = 0.0;
+    for (int c = 0; c < cfg.clients; c++) total += threads[c].done;
+    double *all = (double *)malloc((total ? total : 1) * sizeof(double));
+    size_t filled = 0;
+    for (int c = 0; c < cfg.clients; c++) {
+        memcpy(all + filled, threads[c].latencies, threads[c].done * sizeof(double));
+        filled += threads[c].done;
+        failures += threads[c].failures;
+        errors += threads[c].error;
+        batchSum += threads[c].batch_sum;
+        queueSum += threads[c].queue_ms;
+        free(threads[c].latencies);
+    }
+    qsort(all, total, sizeof(double), compareDouble);
+
+    double seconds = wallMs / 1000.0;
+    printf("  %zu jobs in %.1f ms: %.1f jobs/s, %.2f Mkeys/s\n", total, wallMs,
+           seconds > 0 ? (double)total / seconds : 0.0,
+           seconds > 0 ? (double)total * (double)cfg.n / seconds / 1e6 : 0.0);
+    if (total > 0) {
+        printf("  round trip p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+               all[total / 2], all[total * 9 / 10], all[total * 99 / 100], all[total - 1]);
+        printf("  server: mean batch %.1f jobs, mean queueing %.3f ms\n",
+               (double)batchSum / (double)total, queueSum / (double)total);
+    }
+    printf("  %s: %zu failed checks, %zu lost connections\n",
+           failures == 0 && errors == 0 && total == cfg.jobs * (size_t)cfg.clients ? "PASS" : "FAIL",
+           failures, errors);
+
+    SortResponse stats;
+    if (controlRequest(cfg.socket_path, SORT_OP_STATS, &stats) == 0) {
+        printf("  server totals: %llu jobs in %llu batches, latency mean %.3f ms, max %.3f ms\n",
+               (unsigned long long)stats.jobs, (unsigned long long)stats.batches,
+               stats.mean_latency_ms, stats.max_latency_ms);
+    }
+    if (stopServer && controlRequest(cfg.socket_path, SORT_OP_SHUTDOWN, &stats) != 0) {
+        printf("Could not shut the server down\n");
+        errors++;
+    }
+
+    free(all);
+    free(ids);
+    free(threads);
+    return failures == 0 && errors == 0 && total == cfg.jobs * (size_t)cfg.clients ? 0 : 1;
+}
@@ -31,36 +31,32 @@ void displayMenu() {
 }
 
 // Time measurement helper
-double executeAndMeasure(void (*sortFunc)(int[], int), int arr[], int n) {
-    clock_t start = clock();
+double executeAndMeasure(void (*sortFunc)(int[], size_t), int arr[], size_t n) {
+    double start = now_ms();
     sortFunc(arr, n);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    return now_ms() - start;
 }
 
-double executeQuick(int arr[], int n) {
-    clock_t start = clock();
-    quickSort(arr, 0, n - 1);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+double executeQuick(int arr[], size_t n) {
+    double start = now_ms();
+    quickSort(arr, 0, (ptrdiff_t)n - 1);
+    return now_ms() - start;
 }
 
-double executeRadix(int arr[], int n) {
-    clock_t start = clock();
+double executeRadix(int arr[], size_t n) {
+    double start = now_ms();
     radixSort(arr, n, 5);  // Assume 5 digits max
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    return now_ms() - start;
 }
 
-double executeBucket(int arr[], int n, int maxVal) {
-    clock_t start = clock();
+double executeBucket(int arr[], size_t n, int maxVal) {
+    double start = now_ms();
     bucketSortInt(arr, n, maxVal);
-    clock_t end = clock();
-    return ((double)(end - start)) / CLOCKS_PER_SEC * 1000.0;
+    return now_ms() - start;
 }
 
-void runSingleAlgorithm(int choice, int *original, int n, int maxVal) {
-    int *arr = (int *)malloc(n * sizeof(int));
+void runSingleAlgorithm(int choice, int *original, size_t n, int maxVal) {
+    int *arr = (int *)calloc(n, sizeof(int));
     if (!arr) {
         printf("Memory allocation failed!\n");
         return;
@@ -110,7 +106,7 @@ void runSingleAlgorithm(int choice, int *original, int n, int maxVal) {
     }
     
     printf("│ Algorithm: %-43s │\n", algName);
-    printf("│ Array size: %-42d │\n", n);
+    printf("│ Array size: %-42zu │\n", n);
     printf("│ Status: %-46s │\n", isSorted(arr, n) ? "✓ SORTED SUCCESSFULLY" : "✗ FAILED");
     printf("│                                                        │\n");
     printf("│ ⏱  Execution Time: %.3f ms %*s │\n", time_ms, (int)(29 - (time_ms >= 1000 ? 4 : time_ms >= 100 ? 3 : time_ms >= 10 ? 2 : 1)), "");
@@ -123,8 +119,8 @@ void runSingleAlgorithm(int choice, int *original, int n, int maxVal) {
     free(arr);
 }
 
-void runAllAlgorithms(int *original, int n, int maxVal) {
-    int *arr = (int *)malloc(n * sizeof(int));
+void runAllAlgorithms(int *original, size_t n, int maxVal) {
+    int *arr = (int *)calloc(n, sizeof(int));
     if (!arr) {
         printf("Memory allocation failed!\n");
         return;
@@ -178,10 +174,10 @@ void runAllAlgorithms(int *original, int n, int maxVal) {
 }
 
 int main(void) {
-    srand(time(NULL));
+    setSortSeed((uint64_t)time(NULL));
     
     // Get array size from user
-    int n;
+    long long requested;
     printf("\n");
     printf("╔══════════════════════════════════════════════════════════╗\n");
     printf("║    WELCOME TO SORTING ALGORITHMS DEMONSTRATION          ║\n");
@@ -189,7 +185,7 @@ int main(void) {
     printf("\n");
     printf("Enter the size of the array to sort: ");
     fflush(stdout);
-    if (scanf("%d", &n) != 1) {
+    if (scanf("%lld", &requested) != 1) {
         printf("Invalid input!\n");
         return 1;
     }
@@ -197,14 +193,20 @@ int main(void) {
     int c;
     while ((c = getchar()) != '\n' && c != EOF);
     
-    if (n <= 0 || n > 1000000) {
-        printf("Invalid array size! Please enter between 1 and 1,000,000\n");
+    // No other upper bound: the allocation below is the only limit
+    if (requested <= 0) {
+        printf("Invalid array size! Please enter a positive number\n");
         return 1;
     }
+    if ((unsigned long long)requested > SIZE_MAX / sizeof(int)) {
+        printf("Invalid array size! Too large to allocate\n");
+        return 1;
+    }
+    size_t n = (size_t)requested;
     
     // Generate random array
     int maxVal = 100000;
-    int *original = (int *)malloc(n * sizeof(int));
+    int *original = (int *)calloc(n, sizeof(int));
     if (!original) {
         printf("Memory allocation failed!\n");
         return 1;
@@ -212,7 +214,7 @@ int main(void) {
     
     generateRandomArray(original, n, maxVal);
     
-    printf("\n✓ Random array generated with %d elements\n", n);
+    printf("\n✓ Random array generated with %zu elements\n", n);
     printf("  Value range: 0 to %d\n", maxVal);
     printf("\n  Array preview (first 15 elements): ");
     printArray(original, n < 15 ? n : 15);
@@ -0,0 +1,45 @@
+/*
+ * Sort Server
+ *
+ * Serves sort, top-k and merge jobs over a Unix domain socket until a
+ * client asks it to shut down or it receives SIGINT/SIGTERM.
+ * Usage: ./sort_server [--socket path] [--threads t] [--batch-keys n]
+ *                      [--batch-jobs j] [--verbose]
+ */
+
+#include <signal.h>
+#include "../include/sorting.h"
+
+static void handleStop(int sig) {
+    (void)sig;
+    sortServerStop();
+}
+
+int main(int argc, char *argv[]) {
+    SortServerConfig cfg;
+    sortServerConfigDefaults(&cfg);
+    for (int i = 1; i < argc; i++) {
+        int hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--socket") == 0 && hasValue) cfg.socket_path = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && hasValue) cfg.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--batch-keys") == 0 && hasValue) cfg.batch_max_keys = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--batch-jobs") == 0 && hasValue) cfg.batch_max_jobs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--verbose") == 0) cfg.verbose = 1;
+        else {
+            printf("Usage: %s [--socket path] [--threads t] [--batch-keys n] [--batch-jobs j] [--verbose]\n",
+                   argv[0]);
+            return 1;
+        }
+    }
+    if (cfg.batch_max_jobs < 1) cfg.batch_max_jobs = 1;
+
+    // No SA_RESTART: a signal interrupts poll() right away
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handleStop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    return sortServerRun(&cfg) == 0 ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/*
+ * Large Buffer Allocation
+ *
+ * Arrays and scratch buffers of large sorts are allocated here. Every
+ * sort_malloc block of at least large_min bytes comes through here, as do
+ * the drivers' input and work arrays. Two knobs:
+ *
+ *   - Page size: NORMAL uses malloc (4 KB pages). THP maps anonymous memory
+ *     aligned to 2 MB and asks for transparent huge pages (MADV_HUGEPAGE).
+ *     HUGETLB takes pages from the reserved hugetlbfs pool (MAP_HUGETLB)
+ *     and falls back to THP when the pool is empty. Huge pages cut TLB
+ *     misses in the radix scatter and merge passes, and page faults by 512x
+ *   - First touch: Linux places a page on the NUMA node of the thread that
+ *     first writes it. With first_touch, the pages are faulted in by
+ *     parallelFor() workers, each taking the same proportional slice of
+ *     the buffer it takes of the array in the algorithms' parallelFor()
+ *     loops, instead of all landing on the allocating thread's node
+ *
+ * The default is 4 KB pages with first touch (skipped when only one
+ * thread runs). Huge pages are opt-in: they pay off where the hardware
+ * really maps them as 2 MB pages, but faulting them in costs more (the
+ * kernel may compact memory first), and under a hypervisor that backs
+ * guest memory with small pages the TLB gain disappears. Measure with
+ * `sort_test memory` before turning them on. SORT_HUGEPAGES (off, thp,
+ * hugetlb) and SORT_FIRST_TOUCH (0, 1) override the defaults, as do
+ * setSortMemoryPolicy() and the benchmark options --pages and --first-touch.
+ *
+ * Blocks carry a header, so sortBufferFree() knows how each one was made
+ * even if the policy changed in between.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../include/sorting.h"
+
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+#define TOUCH_GRAIN 64            // Pages per first-touch worker, at least
+
+typedef struct {
+    size_t size;                  // Bytes requested
+    size_t mapped;                // Length of the mapping, 0 for malloc blocks
+    void *base;                   // Start of the mapping
+    size_t pad;                   // Keeps the payload 16-byte aligned
+} BufferHeader;
+
+static SortMemoryPolicy memory_policy;
+static pthread_once_t memory_policy_once = PTHREAD_ONCE_INIT;
+
+static const char *page_mode_names[] = {"off", "thp", "hugetlb"};
+
+const char *sortPageModeName(SortPageMode mode) {
+    return mode >= SORT_PAGES_NORMAL && mode <= SORT_PAGES_HUGETLB ? page_mode_names[mode] : "unknown";
+}
+
+// 0 and the mode for "off", "thp" or "hugetlb", -1 otherwise
+int parseSortPageMode(const char *name, SortPageMode *mode) {
+    for (int m = SORT_PAGES_NORMAL; m <= SORT_PAGES_HUGETLB; m++) {
+        if (strcmp(name, page_mode_names[m]) == 0) {
+            *mode = (SortPageMode)m;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void sortMemoryPolicyDefaults(SortMemoryPolicy *policy) {
+    policy->pages = SORT_PAGES_NORMAL;
+    policy->first_touch = 1;
+    policy->large_min = HUGE_PAGE_SIZE;
+
+    const char *pages = getenv("SORT_HUGEPAGES");
+    if (pages && parseSortPageMode(pages, &policy->pages) != 0) {
+        fprintf(stderr, "Ignoring SORT_HUGEPAGES=%s (off, thp or hugetlb)\n", pages);
+    }
+    const char *touch = getenv("SORT_FIRST_TOUCH");
+    if (touch) policy->first_touch = atoi(touch) != 0;
+}
+
+static void loadMemoryPolicyOnce(void) {
+    sortMemoryPolicyDefaults(&memory_policy);
+}
+
+const SortMemoryPolicy *sortMemoryPolicy(void) {
+    pthread_once(&memory_policy_once, loadMemoryPolicyOnce);
+    return &memory_policy;
+}
+
+void setSortMemoryPolicy(const SortMemoryPolicy *policy) {
+    pthread_once(&memory_policy_once, loadMemoryPolicyOnce);
+    memory_policy = *policy;
+}
+
+// ============================================================
+// MAPPING AND FIRST TOUCH
+// ============================================================
+
+static size_t roundUp(size_t bytes, size_t unit) {
+    return (bytes + unit - 1) / unit * unit;
+}
+
+// Anonymous mapping of at least bytes; sets *length to what was mapped
+static void *mapPages(size_t bytes, SortPageMode mode, size_t *length) {
+    if (mode == SORT_PAGES_HUGETLB) {
+        size_t len = roundUp(bytes, HUGE_PAGE_SIZE);
+        void *map = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (map != MAP_FAILED) {
+            *length = len;
+            return map;
+        }
+    }
+
+    // Over-map by one huge page and trim, so the block starts on a 2 MB
+    // boundary and every 2 MB of it can become one huge page
+    size_t len = roundUp(bytes, HUGE_PAGE_SIZE);
+    char *map = (char *)mmap(NULL, len + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) return NULL;
+    char *aligned = (char *)roundUp((size_t)map, HUGE_PAGE_SIZE);
+    if (aligned > map) munmap(map, (size_t)(aligned - map));
+    size_t tail = (size_t)(map + len + HUGE_PAGE_SIZE - (aligned + len));
+    if (tail > 0) munmap(aligned + len, tail);
+    madvise(aligned, len, MADV_HUGEPAGE);
+    *length = len;
+    return aligned;
+}
+
+typedef struct {
+    volatile char *base;
+    size_t page;
+} TouchJob;
+
+static void touchPages(size_t begin, size_t end, int worker, void *ctx) {
+    (void)worker;
+    TouchJob *job = (TouchJob *)ctx;
+    for (size_t p = begin; p < end; p++) job->base[p * job->page] = 0;
+}
+
+// Fault in [base, base + bytes) from the workers that will use it; the
+// memory must be zero or not hold data yet. Inside a parallel region the
+// caller is one of those workers already: touch serially rather than
+// start threads from every worker
+static void firstTouch(void *base, size_t bytes) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    TouchJob job = {(volatile char *)base, page};
+    size_t pages = (bytes + page - 1) / page;
+    if (sortInParallelRegion()) touchPages(0, pages, 0, &job);
+    else parallelFor(pages, TOUCH_GRAIN, touchPages, &job);
+}
+
+// 1 if the reserved hugetlbfs pool can back a mapping right now
+int sortHugetlbAvailable(void) {
+    void *map = mmap(NULL, HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (map == MAP_FAILED) return 0;
+    munmap(map, HUGE_PAGE_SIZE);
+    return 1;
+}
+
+// ============================================================
+// BUFFERS
+// ============================================================
+
+static void *bufferAlloc(size_t bytes, int zeroed) {
+    if (bytes > SIZE_MAX - HUGE_PAGE_SIZE * 2) return NULL;
+    const SortMemoryPolicy *policy = sortMemoryPolicy();
+    int large = bytes >= policy->large_min;
+    BufferHeader *block;
+
+    if (large && policy->pages != SORT_PAGES_NORMAL) {
+        size_t length;
+        void *map = mapPages(sizeof(BufferHeader) + bytes, policy->pages, &length);
+        if (!map) return NULL;
+        block = (BufferHeader *)map;
+        block->mapped = length;
+        block->base = map;
+    } else {
+        block = (BufferHeader *)(zeroed ? calloc(1, sizeof(BufferHeader) + bytes)
+                                        : malloc(sizeof(BufferHeader) + bytes));
+        if (!block) return NULL;
+        block->mapped = 0;
+        block->base = block;
+    }
+    block->size = bytes;
+
+    // Fresh mappings are zero, and malloc'd memory holds nothing yet. One
+    // thread has nowhere better to put the pages than where it faults them
+    if (large && policy->first_touch && sortThreadCount() > 1) firstTouch(block + 1, bytes);
+    return block + 1;
+}
+
+void *sortBufferAlloc(size_t bytes) {
+    return bufferAlloc(bytes, 0);
+}
+
+void *sortBufferAllocZeroed(size_t bytes) {
+    return bufferAlloc(bytes, 1);
+}
+
+size_t sortBufferSize(const void *ptr) {
+    return ((const BufferHeader *)ptr - 1)->size;
+}
+
+void sortBufferFree(void *ptr) {
+    if (!ptr) return;
+    BufferHeader *block = (BufferHeader *)ptr - 1;
+    if (block->mapped) munmap(block->base, block->mapped);
+    else free(block);
+}
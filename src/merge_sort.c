@@ -0,0 +1,236 @@
+/*
+ * Parallel Stable Merge Sort (merge-path partitioning)
+ *
+ * 1. The array is cut into one leaf per thread (never fewer than
+ *    parallel_grain keys each, see tuning.c); each thread sorts its
+ *    leaf with a sequential stable merge sort (insertion-sorted runs of
+ *    MERGE_RUN elements, then bottom-up merges)
+ * 2. Sorted runs are merged pairwise, level by level. Each level's output
+ *    is cut into equal slices, one per thread, and the merge-path co-rank
+ *    binary search finds where every slice starts in the two inputs, so
+ *    even the last level (a single merge) uses all threads
+ * 3. Levels ping-pong between the array and one scratch buffer instead
+ *    of copying back after every level
+ *
+ * Equal keys are always taken from the left run first, so the sort is
+ * stable: it keeps StableElement records with the same value in their
+ * original order.
+ *
+ * Complexity: O(n log n) work, O(n/p log n + log^2 n) time on p threads
+ * Space: O(n) scratch. If that cannot be allocated, the sort falls back to
+ * a sequential, still stable, in-place merge sort (rotation merges,
+ * O(n log^2 n))
+ */
+
+#include "../include/sorting.h"
+
+#define MERGE_RUN 32   // Insertion-sorted run length in leaves
+
+/*
+ * The algorithm is written once and instantiated per element type:
+ * NAME prefixes the generated functions, LESS(a, b) is the strict order
+ */
+#define DEFINE_MERGE_SORT(NAME, T, LESS)                                          \
+                                                                                  \
+/* Stable merge of a[0..na) and b[0..nb) into out */                              \
+static void NAME##Merge(const T *a, size_t na, const T *b, size_t nb, T *out) {   \
+    size_t i = 0, j = 0, k = 0;                                                   \
+    while (i < na && j < nb) {                                                    \
+        if (LESS(b[j], a[i])) out[k++] = b[j++];                                  \
+        else out[k++] = a[i++];                                                   \
+    }                                                                             \
+    while (i < na) out[k++] = a[i++];                                             \
+    while (j < nb) out[k++] = b[j++];                                             \
+}                                                                                 \
+                                                                                  \
+/* Merge path: how many of the first k outputs come from a */                     \
+static size_t NAME##CoRank(size_t k, const T *a, size_t na, const T *b, size_t nb) { \
+    size_t lo = k > nb ? k - nb : 0;                                              \
+    size_t hi = k < na ? k : na;                                                  \
+    while (lo < hi) {                                                             \
+        size_t mid = lo + (hi - lo) / 2;                                          \
+        if (LESS(b[k - mid - 1], a[mid])) hi = mid;                               \
+        else lo = mid + 1;                                                        \
+    }                                                                             \
+    return lo;                                                                    \
+}                                                                                 \
+                                                                                  \
+/* Insertion-sort arr[0..n) in runs of MERGE_RUN elements */                      \
+static void NAME##Runs(T *arr, size_t n) {                                        \
+    for (size_t start = 0; start < n; start += MERGE_RUN) {                       \
+        size_t end = start + MERGE_RUN < n ? start + MERGE_RUN : n;               \
+        for (size_t i = start + 1; i < end; i++) {                                \
+            T x = arr[i];                                                         \
+            size_t j = i;                                                         \
+            while (j > start && LESS(x, arr[j - 1])) {                            \
+                arr[j] = arr[j - 1];                                              \
+                j--;                                                              \
+            }                                                                     \
+            arr[j] = x;                                                           \
+        }                                                                         \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+/* Sequential stable sort of arr[0..n), tmp holds n elements */                   \
+static void NAME##Leaf(T *arr, T *tmp, size_t n) {                                \
+    NAME##Runs(arr, n);                                                           \
+    T *src = arr, *dst = tmp;                                                     \
+    for (size_t width = MERGE_RUN; width < n; width *= 2) {                       \
+        for (size_t lo = 0; lo < n; lo += 2 * width) {                            \
+            size_t mid = lo + width < n ? lo + width : n;                         \
+            size_t hi = lo + 2 * width < n ? lo + 2 * width : n;                  \
+            NAME##Merge(src + lo, mid - lo, src + mid, hi - mid, dst + lo);       \
+        }                                                                         \
+        T *t = src; src = dst; dst = t;                                           \
+    }                                                                             \
+    if (src != arr) memcpy(arr, src, n * sizeof(T));                              \
+}                                                                                 \
+                                                                                  \
+/* Reverse a[0..n) */                                                             \
+static void NAME##Reverse(T *a, size_t n) {                                       \
+    for (size_t i = 0, j = n; i + 1 < j; i++, j--) {                              \
+        T t = a[i]; a[i] = a[j - 1]; a[j - 1] = t;                                \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+/*                                                                                \
+ * Stable merge of the sorted a[0..mid) and a[mid..n) without a buffer:           \
+ * split the longer half at its middle, find the matching cut in the              \
+ * other by binary search, rotate the two inner pieces past each other            \
+ * and merge both sides the same way. O(n log n) moves per merge                  \
+ */                                                                               \
+static void NAME##MergeInPlace(T *a, size_t mid, size_t n) {                      \
+    while (mid > 0 && mid < n) {                                                  \
+        if (n == 2) {                       /* mid / 2 below would not split */   \
+            if (LESS(a[1], a[0])) NAME##Reverse(a, 2);                            \
+            return;                                                               \
+        }                                                                         \
+        size_t cut1, cut2;                                                        \
+        if (mid >= n - mid) {                                                     \
+            cut1 = mid / 2;                                                       \
+            size_t lo = mid, hi = n;        /* First of a[mid..n) not < a[cut1] */\
+            while (lo < hi) {                                                     \
+                size_t m = lo + (hi - lo) / 2;                                    \
+                if (LESS(a[m], a[cut1])) lo = m + 1;                              \
+                else hi = m;                                                      \
+            }                                                                     \
+            cut2 = lo;                                                            \
+        } else {                                                                  \
+            cut2 = mid + (n - mid) / 2;                                           \
+            size_t lo = 0, hi = mid;        /* First of a[0..mid) > a[cut2] */    \
+            while (lo < hi) {                                                     \
+                size_t m = lo + (hi - lo) / 2;                                    \
+                if (LESS(a[cut2], a[m])) hi = m;                                  \
+                else lo = m + 1;                                                  \
+            }                                                                     \
+            cut1 = lo;                                                            \
+        }                                                                         \
+        NAME##Reverse(a + cut1, mid - cut1);                                      \
+        NAME##Reverse(a + mid, cut2 - mid);                                       \
+        NAME##Reverse(a + cut1, cut2 - cut1);                                     \
+        size_t split = cut1 + (cut2 - mid);                                       \
+        /* Recurse on the shorter side, loop on the longer one */                 \
+        if (split < n - split) {                                                  \
+            NAME##MergeInPlace(a, cut1, split);                                   \
+            a += split;                                                           \
+            mid = cut2 - split;                                                   \
+            n -= split;                                                           \
+        } else {                                                                  \
+            NAME##MergeInPlace(a + split, cut2 - split, n - split);               \
+            mid = cut1;                                                           \
+            n = split;                                                            \
+        }                                                                         \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+/* Stable sort of arr[0..n) with no scratch, for when the buffer cannot be had */ \
+static void NAME##SortInPlace(T *arr, size_t n) {                                 \
+    NAME##Runs(arr, n);                                                           \
+    for (size_t width = MERGE_RUN; width < n; width *= 2) {                       \
+        for (size_t lo = 0; lo + width < n; lo += 2 * width) {                    \
+            size_t hi = lo + 2 * width < n ? lo + 2 * width : n;                  \
+            NAME##MergeInPlace(arr + lo, width, hi - lo);                         \
+        }                                                                         \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+typedef struct {                                                                  \
+    T *src;                                                                       \
+    T *dst;                                                                       \
+    size_t n;                                                                     \
+    size_t width;       /* Run length at this level (leaf phase: leaf size) */   \
+    size_t slices;                                                                \
+} NAME##Level;                                                                    \
+                                                                                  \
+static void NAME##LeafBody(size_t begin, size_t end, int worker, void *ctx) {     \
+    (void)worker;                                                                 \
+    NAME##Level *lv = (NAME##Level *)ctx;                                         \
+    for (size_t leaf = begin; leaf < end; leaf++) {                               \
+        size_t lo = leaf * lv->width;                                             \
+        size_t hi = lo + lv->width < lv->n ? lo + lv->width : lv->n;              \
+        if (lo < hi) NAME##Leaf(lv->src + lo, lv->dst + lo, hi - lo);             \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+/* One slice of a level: output positions [first, last) across all pairs */      \
+static void NAME##LevelBody(size_t begin, size_t end, int worker, void *ctx) {    \
+    (void)worker;                                                                 \
+    NAME##Level *lv = (NAME##Level *)ctx;                                         \
+    for (size_t s = begin; s < end; s++) {                                        \
+        size_t first = lv->n * s / lv->slices;                                    \
+        size_t last = lv->n * (s + 1) / lv->slices;                               \
+        while (first < last) {                                                    \
+            size_t pairLo = first / (2 * lv->width) * (2 * lv->width);            \
+            size_t mid = pairLo + lv->width < lv->n ? pairLo + lv->width : lv->n; \
+            size_t pairHi = mid + lv->width < lv->n ? mid + lv->width : lv->n;    \
+            size_t stop = last < pairHi ? last : pairHi;                          \
+            const T *a = lv->src + pairLo, *b = lv->src + mid;                    \
+            size_t na = mid - pairLo, nb = pairHi - mid;                          \
+            size_t i0 = NAME##CoRank(first - pairLo, a, na, b, nb);               \
+            size_t i1 = NAME##CoRank(stop - pairLo, a, na, b, nb);                \
+            size_t j0 = first - pairLo - i0, j1 = stop - pairLo - i1;             \
+            NAME##Merge(a + i0, i1 - i0, b + j0, j1 - j0, lv->dst + first);       \
+            first = stop;                                                         \
+        }                                                                         \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+static void NAME##Sort(T *arr, size_t n) {                                        \
+    if (n < 2) return;                                                            \
+    T *buf = (T *)sort_malloc(n * sizeof(T));                                     \
+    if (!buf) {                                                                   \
+        NAME##SortInPlace(arr, n);                                                \
+        return;                                                                   \
+    }                                                                             \
+    size_t threads = (size_t)sortThreadCount();                                   \
+    size_t grain = sortTuning()->parallel_grain;                                  \
+    if (threads > n / grain) threads = n / grain;                                 \
+    if (threads < 2) {                                                            \
+        NAME##Leaf(arr, buf, n);                                                  \
+        sort_free(buf);                                                           \
+        return;                                                                   \
+    }                                                                             \
+                                                                                  \
+    NAME##Level lv = {arr, buf, n, (n + threads - 1) / threads, threads};         \
+    parallelFor(threads, 1, NAME##LeafBody, &lv);                                 \
+    for (; lv.width < n; lv.width *= 2) {                                         \
+        parallelFor(lv.slices, 1, NAME##LevelBody, &lv);                          \
+        T *t = lv.src; lv.src = lv.dst; lv.dst = t;                               \
+    }                                                                             \
+    if (lv.src != arr) memcpy(arr, lv.src, n * sizeof(T));                        \
+    sort_free(buf);                                                               \
+}
+
+#define INT_LESS(a, b) ((a) < (b))
+#define STABLE_LESS(a, b) ((a).value < (b).value)
+
+DEFINE_MERGE_SORT(mergeInt, int, INT_LESS)
+DEFINE_MERGE_SORT(mergeStable, StableElement, STABLE_LESS)
+
+void parallelMergeSort(int arr[], size_t n) {
+    mergeIntSort(arr, n);
+}
+
+void parallelMergeSortStable(StableElement arr[], size_t n) {
+    mergeStableSort(arr, n);
+}
@@ -0,0 +1,118 @@
+/*
+ * Parallel Loop Helper
+ *
+ * parallelFor(count, grain, body, ctx) splits [0, count) into contiguous
+ * ranges and runs body on each range from its own POSIX thread. The calling
+ * thread takes the first range, so a single-range loop never spawns a thread.
+ *
+ * The number of threads defaults to the online CPUs and can be overridden
+ * with setSortThreadCount() or the SORT_THREADS environment variable.
+ *
+ * Threads running a range (and the workers of multi-thread pools) are
+ * marked as inside a parallel region, so helpers that would otherwise
+ * start threads of their own, such as first touch, can stay serial there.
+ */
+
+#include <pthread.h>
+#include <unistd.h>
+#include "../include/sorting.h"
+
+static int sort_threads = 0;   // 0 = not decided yet
+static __thread int in_parallel_region = 0;
+
+int sortThreadCount(void) {
+    if (sort_threads > 0) return sort_threads;
+    
+    const char *env = getenv("SORT_THREADS");
+    int threads = env ? atoi(env) : 0;
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    sort_threads = threads;
+    return sort_threads;
+}
+
+void setSortThreadCount(int threads) {
+    sort_threads = threads > 0 ? threads : 0;
+}
+
+int sortInParallelRegion(void) {
+    return in_parallel_region;
+}
+
+int sortSetParallelRegion(int inside) {
+    int previous = in_parallel_region;
+    in_parallel_region = inside;
+    return previous;
+}
+
+typedef struct {
+    ParallelBody body;
+    void *ctx;
+    size_t begin;
+    size_t end;
+    int worker;
+} ParallelRange;
+
+static void *runRange(void *arg) {
+    ParallelRange *range = (ParallelRange *)arg;
+    int outer = sortSetParallelRegion(1);
+    range->body(range->begin, range->end, range->worker, range->ctx);
+    sortSetParallelRegion(outer);
+    return NULL;
+}
+
+/*
+ * Run body over [0, count) on up to sortThreadCount() threads
+ * Each thread gets at least grain items (grain 0 is treated as 1), so small
+ * loops stay on the calling thread, as does the whole loop if the range
+ * bookkeeping cannot be allocated
+ */
+void parallelFor(size_t count, size_t grain, ParallelBody body, void *ctx) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    
+    size_t maxWorkers = (count + grain - 1) / grain;
+    int workers = sortThreadCount();
+    if ((size_t)workers > maxWorkers) workers = (int)maxWorkers;
+    if (workers <= 1) {
+        body(0, count, 0, ctx);
+        return;
+    }
+    
+    ParallelRange *ranges = (ParallelRange *)malloc(workers * sizeof(ParallelRange));
+    pthread_t *threads = (pthread_t *)malloc(workers * sizeof(pthread_t));
+    int *started = (int *)calloc(workers, sizeof(int));
+    if (!ranges || !threads || !started) {
+        // No memory to hand out ranges: run the whole loop here
+        free(started);
+        free(threads);
+        free(ranges);
+        body(0, count, 0, ctx);
+        return;
+    }
+    
+    for (int w = 0; w < workers; w++) {
+        ranges[w].body = body;
+        ranges[w].ctx = ctx;
+        ranges[w].begin = count * w / workers;
+        ranges[w].end = count * (w + 1) / workers;
+        ranges[w].worker = w;
+    }
+    for (int w = 1; w < workers; w++) {
+        started[w] = pthread_create(&threads[w], NULL, runRange, &ranges[w]) == 0;
+    }
+    
+    // The caller works too, and picks up any range whose thread failed to start
+    runRange(&ranges[0]);
+    for (int w = 1; w < workers; w++) {
+        if (started[w]) {
+            pthread_join(threads[w], NULL);
+        } else {
+            runRange(&ranges[w]);
+        }
+    }
+    
+    free(started);
+    free(threads);
+    free(ranges);
+}
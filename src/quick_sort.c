@@ -16,6 +16,9 @@
  * Recurrence relation:
  *   Best: T(n) = 2T(n/2) + O(n) => O(n log n)
  *   Worst: T(n) = T(n-1) + O(n) => O(n²)
+ * 
+ * Also here: the three-way variant, and a lazy sorted iterator that
+ * emits the first m of n keys in O(n + m log m).
  */
 
 #include "../include/sorting.h"
@@ -25,11 +28,11 @@
  * Uses the last element as pivot
  * Returns the final position of the pivot
  */
-int partition(int arr[], int p, int r) {
+ptrdiff_t partition(int arr[], ptrdiff_t p, ptrdiff_t r) {
     int pivot = arr[r];  // Use last element as pivot
-    int i = p - 1;       // Index of smaller element
+    ptrdiff_t i = p - 1; // Index of smaller element
     
-    for (int j = p; j < r; j++) {
+    for (ptrdiff_t j = p; j < r; j++) {
         // If current element is smaller than or equal to pivot
         if (arr[j] <= pivot) {
             i++;
@@ -46,22 +49,25 @@ int partition(int arr[], int p, int r) {
  * Quick Sort recursive function
  * Sorts arr[p..r] in place
  */
-void quickSort(int arr[], int p, int r) {
+void quickSort(int arr[], ptrdiff_t p, ptrdiff_t r) {
     if (p < r) {
-        int q = partition(arr, p, r);
+        TRACE_QS_ENTER();
+        ptrdiff_t q = partition(arr, p, r);
+        TRACE_QS_SPLIT(p, q, r);
         quickSort(arr, p, q - 1);  // Sort left subarray
         quickSort(arr, q + 1, r);  // Sort right subarray
+        TRACE_QS_LEAVE();
     }
 }
 
 /*
  * Partition with counters
  */
-static int partitionCounted(int arr[], int p, int r) {
+static ptrdiff_t partitionCounted(int arr[], ptrdiff_t p, ptrdiff_t r) {
     int pivot = arr[r];
-    int i = p - 1;
+    ptrdiff_t i = p - 1;
     
-    for (int j = p; j < r; j++) {
+    for (ptrdiff_t j = p; j < r; j++) {
         comparison_count++;
         if (arr[j] <= pivot) {
             i++;
@@ -76,10 +82,186 @@ static int partitionCounted(int arr[], int p, int r) {
 /*
  * Quick Sort with counters for analysis
  */
-void quickSortCounted(int arr[], int p, int r) {
+void quickSortCounted(int arr[], ptrdiff_t p, ptrdiff_t r) {
     if (p < r) {
-        int q = partitionCounted(arr, p, r);
+        TRACE_QS_ENTER();
+        ptrdiff_t q = partitionCounted(arr, p, r);
+        TRACE_QS_SPLIT(p, q, r);
         quickSortCounted(arr, p, q - 1);
         quickSortCounted(arr, q + 1, r);
+        TRACE_QS_LEAVE();
+    }
+}
+
+/*
+ * Median of three keys, used as the pivot value
+ */
+static int median3(int a, int b, int c) {
+    if (b < a) { int t = a; a = b; b = t; }
+    if (c < b) b = c;
+    return b < a ? a : b;
+}
+
+/*
+ * Pivot for arr[p..r]: median of three on short ranges, Tukey's ninther
+ * (median of three medians of three) on long ones, which keeps sorted,
+ * reversed and organ-pipe inputs balanced
+ */
+static int pivot3Way(const int arr[], ptrdiff_t p, ptrdiff_t r) {
+    ptrdiff_t len = r - p + 1;
+    ptrdiff_t mid = p + len / 2;
+    if (len < 64) return median3(arr[p], arr[mid], arr[r]);
+    
+    ptrdiff_t s = len / 8;
+    return median3(median3(arr[p], arr[p + s], arr[p + 2 * s]),
+                   median3(arr[mid - s], arr[mid], arr[mid + s]),
+                   median3(arr[r - 2 * s], arr[r - s], arr[r]));
+}
+
+/*
+ * Three-way Quick Sort (Dijkstra's Dutch national flag partition)
+ * Splits arr[p..r] into < pivot, == pivot and > pivot, so every key equal
+ * to the pivot is finished in one pass: O(n) when all keys are equal,
+ * O(n log d) for d distinct keys. Recurses into the smaller side.
+ */
+void quickSort3Way(int arr[], ptrdiff_t p, ptrdiff_t r) {
+    while (p < r) {
+        int pivot = pivot3Way(arr, p, r);
+        ptrdiff_t lt = p, i = p, gt = r;
+        
+        while (i <= gt) {
+            if (arr[i] < pivot) swap(&arr[lt++], &arr[i++]);
+            else if (arr[i] > pivot) swap(&arr[i], &arr[gt--]);
+            else i++;
+        }
+        
+        if (lt - p < r - gt) {
+            quickSort3Way(arr, p, lt - 1);
+            p = gt + 1;
+        } else {
+            quickSort3Way(arr, gt + 1, r);
+            r = lt - 1;
+        }
+    }
+}
+
+/*
+ * Lazy sorted iterator (incremental quicksort)
+ *
+ * Hands out the keys of arr in ascending order, sorting only as far as
+ * needed for the next one. The stack holds the boundaries of the ranges
+ * still unsorted: every key before a boundary is <= every key after it.
+ * To emit arr[pos], the range from pos to the top boundary is partitioned
+ * and the start of its upper part pushed, until the range starting at pos
+ * is short enough for insertion sort, or starts with the pivot's equal
+ * keys (already final). The upper parts are left alone until the
+ * iteration reaches them.
+ *
+ * The partition is Lomuto's scheme like partition() above, with the swap
+ * made unconditional so the loop has no data-dependent branch, and split
+ * on < pivot. When nothing is below the pivot (the pivot is the smallest
+ * key of the range), a second pass on <= pivot moves every copy of it to
+ * the front, where they are final. Runs of equal keys thus cost one pass
+ * instead of one per key, as plain partition() would take.
+ *
+ * Cost: O(n + m log m) expected for the first m keys, O(n log n) for all.
+ * arr is permuted in place; arr[0..m) holds the m keys emitted so far.
+ */
+
+// Move the keys < pivot (<= pivot with orEqual) to the front of
+// arr[p..r]; returns where the rest starts
+static ptrdiff_t partitionBranchless(int arr[], ptrdiff_t p, ptrdiff_t r, int pivot, int orEqual) {
+    ptrdiff_t i = p;
+    if (orEqual) {
+        for (ptrdiff_t j = p; j <= r; j++) {
+            int x = arr[j];
+            arr[j] = arr[i];
+            arr[i] = x;
+            i += x <= pivot;
+        }
+    } else {
+        for (ptrdiff_t j = p; j <= r; j++) {
+            int x = arr[j];
+            arr[j] = arr[i];
+            arr[i] = x;
+            i += x < pivot;
+        }
+    }
+    return i;
+}
+
+static int iteratorPush(SortedIterator *it, size_t boundary) {
+    if (it->depth == it->cap) {
+        size_t cap = it->cap * 2;
+        size_t *stack = (size_t *)sort_malloc(cap * sizeof(size_t));
+        if (!stack) return -1;
+        memcpy(stack, it->stack, it->depth * sizeof(size_t));
+        sort_free(it->stack);
+        it->stack = stack;
+        it->cap = cap;
+    }
+    it->stack[it->depth++] = boundary;
+    return 0;
+}
+
+int sortedIteratorInit(SortedIterator *it, int arr[], size_t n) {
+    it->arr = arr;
+    it->n = n;
+    it->pos = 0;
+    it->ready = 0;
+    it->cap = 64;
+    it->depth = 0;
+    it->stack = (size_t *)sort_malloc(it->cap * sizeof(size_t));
+    if (!it->stack) return -1;
+    it->stack[it->depth++] = n;   // Sentinel: the end of the array
+    return 0;
+}
+
+/*
+ * Next key in ascending order into *key
+ * Returns 1, 0 once every key has been emitted, or -1 if memory runs out
+ */
+int sortedIteratorNext(SortedIterator *it, int *key) {
+    if (it->pos == it->n) return 0;
+    size_t small = (size_t)sortTuning()->small_sort_max;
+    while (it->pos >= it->ready) {
+        size_t top = it->stack[it->depth - 1];
+        if (top == it->pos) {
+            it->depth--;
+            continue;
+        }
+        if (top - it->pos <= small) {
+            insertionSort(it->arr + it->pos, top - it->pos);
+            it->ready = top;
+            it->depth--;
+            break;
+        }
+        
+        ptrdiff_t p = (ptrdiff_t)it->pos, r = (ptrdiff_t)top - 1;
+        int pivot = pivot3Way(it->arr, p, r);
+        size_t split = (size_t)partitionBranchless(it->arr, p, r, pivot, 0);
+        if (split == it->pos) {
+            // The pivot is the smallest key: its copies come first, done
+            split = (size_t)partitionBranchless(it->arr, p, r, pivot, 1);
+            it->ready = split;
+        }
+        if (split < top && iteratorPush(it, split) != 0) return -1;
     }
+    *key = it->arr[it->pos++];
+    return 1;
+}
+
+/*
+ * Up to m next keys, ascending, into out
+ * Returns how many were written (fewer than m at the end of the keys)
+ */
+size_t sortedIteratorTake(SortedIterator *it, int out[], size_t m) {
+    size_t taken = 0;
+    while (taken < m && sortedIteratorNext(it, &out[taken]) == 1) taken++;
+    return taken;
+}
+
+void sortedIteratorFree(SortedIterator *it) {
+    sort_free(it->stack);
+    it->stack = NULL;
 }
@@ -7,6 +7,7 @@
  * key(x, i): Returns the i-th digit (0 = units, 1 = tens, 2 = hundreds, etc.)
  * sortAux(T, n, i): Stable sort by the i-th digit using counting sort
  * radixSort(T, n, k): Sort by distribution using k digits
+ * countingSort*(T, n): Counting sort on whole keys when their range is small
  * 
  * Complexity:
  *   Best Case: O(k × n) where k = number of digits
@@ -35,12 +36,12 @@ int key(int x, int i) {
  * Counting sort by the digit at position 'digit'
  * This is a stable sort which is essential for radix sort to work correctly
  */
-void sortAux(int arr[], int n, int digit) {
-    int *output = (int *)malloc(n * sizeof(int));
-    int count[10] = {0};
+void sortAux(int arr[], size_t n, int digit) {
+    int *output = (int *)sort_malloc(n * sizeof(int));
+    size_t count[10] = {0};
     
     // Count occurrences of each digit
-    for (int i = 0; i < n; i++) {
+    for (size_t i = 0; i < n; i++) {
         count[key(arr[i], digit)]++;
     }
     
@@ -50,18 +51,16 @@ void sortAux(int arr[], int n, int digit) {
     }
     
     // Build output array (traverse from right to left to maintain stability)
-    for (int i = n - 1; i >= 0; i--) {
+    for (size_t i = n; i-- > 0;) {
         int d = key(arr[i], digit);
         output[count[d] - 1] = arr[i];
         count[d]--;
     }
     
     // Copy output back to arr
-    for (int i = 0; i < n; i++) {
-        arr[i] = output[i];
-    }j
+    memcpy(arr, output, n * sizeof(int));
     
-    free(output);
+    sort_free(output);
 }
 
 /*
@@ -69,8 +68,594 @@ void sortAux(int arr[], int n, int digit) {
  * k = number of digits to process
  * Sorts integers between 0 and 10^k - 1
  */
-void radixSort(int arr[], int n, int k) {
+void radixSort(int arr[], size_t n, int k) {
     for (int i = 0; i < k; i++) {
+        TRACE_RADIX_PASS_BEGIN(pass_start);
         sortAux(arr, n, i);
+        TRACE_RADIX_PASS_END(i, pass_start);
     }
 }
+
+/*
+ * Binary LSD Radix Sort
+ *
+ * Same idea as radixSort, but with binary digits of radix_bits bits (from
+ * the tuning profile, 8 by default: 4 passes of 256 buckets; 11 gives 3
+ * passes of 2048). Negatives are included: the sign bit is flipped so
+ * they order before the positives. All digit histograms are built in one
+ * read pass, and a pass is skipped when every key has the same digit
+ * there. Passes ping-pong between arr and scratch instead of copying back.
+ *
+ * Complexity: O(ceil(32 / bits) × n), Space: O(n + passes × 2^bits)
+ */
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define RADIX_MIN_FILL 16
+
+static inline unsigned int radixKey(int x) {
+    return (unsigned int)x ^ 0x80000000u;
+}
+
+/*
+ * What the last pass does besides scattering (see the fused operations
+ * after the counting engine)
+ */
+typedef enum {
+    RADIX_GROUP_NONE,         // Plain sort
+    RADIX_GROUP_DISTINCT,     // Sort, and count the distinct keys
+    RADIX_GROUP_UNIQUE,       // Keep one key of each run
+    RADIX_GROUP_RUNS          // Keep one key of each run, and its length
+} RadixGroup;
+
+/*
+ * Last scatter pass, fused with the grouping. Earlier passes left src
+ * sorted by every digit below this one, and the scatter is stable, so the
+ * keys reach each bucket in ascending order: a key equal to the one just
+ * written to its bucket is a duplicate. UNIQUE and RUNS do not write it
+ * (RUNS bumps the count next to the kept key) and close the gaps between
+ * buckets afterwards, which moves only the kept keys.
+ * start receives a copy of the bucket offsets
+ * Returns the distinct keys (now at the front of dst for UNIQUE and RUNS)
+ */
+static size_t radixGroupPass(const int src[], int dst[], size_t n, size_t c[],
+                             size_t start[], size_t buckets, int shift, unsigned int mask,
+                             RadixGroup group, size_t counts[]) {
+    memcpy(start, c, buckets * sizeof(size_t));
+    
+    size_t distinct = 0;
+    if (group == RADIX_GROUP_DISTINCT) {
+        for (size_t i = 0; i < n; i++) {
+            int key = src[i];
+            size_t *pos = &c[(radixKey(key) >> shift) & mask];
+            if (*pos == start[pos - c] || dst[*pos - 1] != key) distinct++;
+            dst[(*pos)++] = key;
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            int key = src[i];
+            size_t *pos = &c[(radixKey(key) >> shift) & mask];
+            if (*pos > start[pos - c] && dst[*pos - 1] == key) {
+                if (counts) counts[*pos - 1]++;
+                continue;
+            }
+            if (counts) counts[*pos] = 1;
+            dst[(*pos)++] = key;
+        }
+        for (size_t d = 0; d < buckets; d++) {
+            size_t len = c[d] - start[d];
+            if (distinct != start[d]) {
+                memmove(dst + distinct, dst + start[d], len * sizeof(int));
+                if (counts) memmove(counts + distinct, counts + start[d], len * sizeof(size_t));
+            }
+            distinct += len;
+        }
+    }
+    return distinct;
+}
+
+/*
+ * LSD passes shared by radixSortLSDBuffered and the fused operations
+ * Returns n for RADIX_GROUP_NONE, the distinct keys otherwise, (size_t)-1
+ * if memory runs out (arr is then left untouched)
+ */
+static size_t radixSortGrouped(int arr[], int scratch[], size_t n,
+                               RadixGroup group, size_t counts[]) {
+    // Wider digits save passes only when the histograms stay small next
+    // to the data; below RADIX_MIN_FILL keys per bucket use 8 bits
+    int bits = sortTuning()->radix_bits;
+    if (n < ((size_t)RADIX_MIN_FILL << bits)) bits = RADIX_BITS;
+    size_t small_count[4 * RADIX_BUCKETS];
+    size_t *count = small_count;
+    if (bits != RADIX_BITS) {
+        size_t tables = (size_t)(32 + bits - 1) / bits;
+        count = (size_t *)sort_calloc(tables << bits, sizeof(size_t));
+        if (!count) count = small_count;   // Fall back to 8-bit digits
+    }
+    if (count == small_count) {
+        bits = RADIX_BITS;
+        memset(small_count, 0, sizeof(small_count));
+    }
+    int passes = (32 + bits - 1) / bits;
+    size_t buckets = (size_t)1 << bits;
+    unsigned int mask = (unsigned int)buckets - 1;
+    
+    // Bucket starts for the grouping pass
+    size_t small_start[RADIX_BUCKETS];
+    size_t *start = small_start;
+    if (group != RADIX_GROUP_NONE && buckets > RADIX_BUCKETS) {
+        start = (size_t *)sort_malloc(buckets * sizeof(size_t));
+        if (!start) {
+            sort_free(count);
+            return (size_t)-1;
+        }
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        unsigned int k = radixKey(arr[i]);
+        for (int pass = 0; pass < passes; pass++) {
+            count[pass * buckets + ((k >> (pass * bits)) & mask)]++;
+        }
+    }
+    
+    // A pass where all keys share the digit would not move anything. Which
+    // passes those are does not depend on the order, so the last one that
+    // does move keys (the one the grouping rides on) is known up front
+    int last = -1;
+    for (int pass = 0; pass < passes; pass++) {
+        if (count[pass * buckets + ((radixKey(arr[0]) >> (pass * bits)) & mask)] != n) last = pass;
+    }
+    size_t result = n;
+    if (last < 0 && group != RADIX_GROUP_NONE) {
+        // Every key is the same
+        result = 1;
+        if (counts) counts[0] = n;
+    }
+    
+    int *src = arr, *dst = scratch;
+    for (int pass = 0; pass <= last; pass++) {
+        int shift = pass * bits;
+        size_t *c = count + pass * buckets;
+        if (c[(radixKey(src[0]) >> shift) & mask] == n) continue;
+        
+        TRACE_RADIX_PASS_BEGIN(pass_start);
+        size_t offset = 0;
+        for (size_t d = 0; d < buckets; d++) {
+            size_t t = c[d];
+            c[d] = offset;
+            offset += t;
+        }
+        if (pass == last && group != RADIX_GROUP_NONE) {
+            result = radixGroupPass(src, dst, n, c, start, buckets, shift, mask, group, counts);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                dst[c[(radixKey(src[i]) >> shift) & mask]++] = src[i];
+            }
+        }
+        TRACE_RADIX_PASS_END(pass, pass_start);
+        
+        int *t = src; src = dst; dst = t;
+    }
+    
+    if (src != arr) {
+        size_t keep = group == RADIX_GROUP_UNIQUE || group == RADIX_GROUP_RUNS ? result : n;
+        memcpy(arr, src, keep * sizeof(int));
+    }
+    if (start != small_start) sort_free(start);
+    if (count != small_count) sort_free(count);
+    return result;
+}
+
+/*
+ * Sort with a caller-provided scratch buffer of n ints
+ * (lets repeated callers such as the external sort reuse one buffer)
+ */
+void radixSortLSDBuffered(int arr[], int scratch[], size_t n) {
+    if (n < 2) return;
+    radixSortGrouped(arr, scratch, n, RADIX_GROUP_NONE, NULL);
+}
+
+// Without memory for the scratch buffer, falls back to the in-place heap sort
+void radixSortLSD(int arr[], size_t n) {
+    if (n < 2) return;
+    int *scratch = (int *)sort_malloc(n * sizeof(int));
+    if (!scratch) {
+        heapSort(arr, n);
+        return;
+    }
+    radixSortLSDBuffered(arr, scratch, n);
+    sort_free(scratch);
+}
+
+/*
+ * Binary LSD Radix Sort for 64-bit keys (8 passes of 8 bits)
+ * Same scheme as radixSortLSDBuffered: sign bit flipped, one histogram
+ * pass, passes with a single populated digit skipped. Without memory for
+ * the buffers, falls back to the in-place vectorized introsort
+ */
+void radixSortLSD64(int64_t arr[], size_t n) {
+    if (n < 2) return;
+    int64_t *scratch = (int64_t *)sort_malloc(n * sizeof(int64_t));
+    size_t (*count)[RADIX_BUCKETS] = (size_t (*)[RADIX_BUCKETS])sort_calloc(8, sizeof(*count));
+    if (!scratch || !count) {
+        sort_free(count);
+        sort_free(scratch);
+        simdSort64(arr, n);
+        return;
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        uint64_t k = (uint64_t)arr[i] ^ 0x8000000000000000ULL;
+        for (int pass = 0; pass < 8; pass++) {
+            count[pass][(k >> (pass * RADIX_BITS)) & 0xFF]++;
+        }
+    }
+    
+    int64_t *src = arr, *dst = scratch;
+    for (int pass = 0; pass < 8; pass++) {
+        int shift = pass * RADIX_BITS;
+        size_t *c = count[pass];
+        uint64_t first = (uint64_t)src[0] ^ 0x8000000000000000ULL;
+        if (c[(first >> shift) & 0xFF] == n) continue;
+        
+        TRACE_RADIX_PASS_BEGIN(pass_start);
+        size_t offset = 0;
+        for (int d = 0; d < RADIX_BUCKETS; d++) {
+            size_t t = c[d];
+            c[d] = offset;
+            offset += t;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t k = (uint64_t)src[i] ^ 0x8000000000000000ULL;
+            dst[c[(k >> shift) & 0xFF]++] = src[i];
+        }
+        TRACE_RADIX_PASS_END(pass, pass_start);
+        
+        int64_t *t = src; src = dst; dst = t;
+    }
+    
+    if (src != arr) memcpy(arr, src, n * sizeof(int64_t));
+    sort_free(count);
+    sort_free(scratch);
+}
+
+/*
+ * Counting Sort engine
+ *
+ * The counting idea behind sortAux, applied to whole keys: when the key
+ * range max - min + 1 is small, one histogram pass plus a fill (or a
+ * stable scatter) sorts in O(n + range) with no comparisons at all.
+ * Keys are offset by the minimum, so negatives need no special case.
+ * The engine refuses ranges above COUNTING_MAX_RANGE (returns -1 and
+ * leaves the array untouched); deciding whether a range is small enough
+ * to be worth it is up to the caller (see sortAuto).
+ */
+#define COUNTING_MAX_RANGE ((size_t)1 << 24)
+
+/*
+ * Single pass for the smallest and largest key (n >= 1)
+ */
+static void keyRange(const int arr[], size_t n, int *minVal, int *maxVal) {
+    int lo = arr[0], hi = arr[0];
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i] < lo) lo = arr[i];
+        if (arr[i] > hi) hi = arr[i];
+    }
+    *minVal = lo;
+    *maxVal = hi;
+}
+
+static size_t keySpan(int minVal, int maxVal) {
+    return (size_t)((long long)maxVal - minVal) + 1;
+}
+
+/*
+ * Histogram-and-fill when every key is known to lie in [minVal, maxVal]
+ * Returns 0 on success, -1 if the range is too large or memory runs out
+ */
+int countingSortRange(int arr[], size_t n, int minVal, int maxVal) {
+    if (n < 2) return 0;
+    size_t range = keySpan(minVal, maxVal);
+    if (range > COUNTING_MAX_RANGE) return -1;
+    
+    size_t *count = (size_t *)sort_calloc(range, sizeof(size_t));
+    if (!count) return -1;
+    
+    for (size_t i = 0; i < n; i++) count[arr[i] - minVal]++;
+    
+    size_t k = 0;
+    for (size_t v = 0; v < range; v++) {
+        int key = (int)((long long)minVal + (long long)v);
+        for (size_t c = count[v]; c > 0; c--) arr[k++] = key;
+    }
+    
+    sort_free(count);
+    return 0;
+}
+
+int countingSort(int arr[], size_t n) {
+    if (n < 2) return 0;
+    int minVal, maxVal;
+    keyRange(arr, n, &minVal, &maxVal);
+    return countingSortRange(arr, n, minVal, maxVal);
+}
+
+/*
+ * Stable key/value counting sort: values[i] travels with keys[i], and
+ * records with equal keys keep their input order
+ */
+int countingSortKV(int keys[], int values[], size_t n) {
+    if (n < 2) return 0;
+    int minVal, maxVal;
+    keyRange(keys, n, &minVal, &maxVal);
+    size_t range = keySpan(minVal, maxVal);
+    if (range > COUNTING_MAX_RANGE) return -1;
+    
+    size_t *start = (size_t *)sort_calloc(range, sizeof(size_t));
+    int *outKeys = (int *)sort_malloc(n * sizeof(int));
+    int *outValues = (int *)sort_malloc(n * sizeof(int));
+    if (!start || !outKeys || !outValues) {
+        sort_free(start);
+        sort_free(outKeys);
+        sort_free(outValues);
+        return -1;
+    }
+    
+    for (size_t i = 0; i < n; i++) start[keys[i] - minVal]++;
+    size_t offset = 0;
+    for (size_t v = 0; v < range; v++) {
+        size_t t = start[v];
+        start[v] = offset;
+        offset += t;
+    }
+    
+    // Forward scatter: the first record with a key gets the first slot
+    for (size_t i = 0; i < n; i++) {
+        size_t pos = start[keys[i] - minVal]++;
+        outKeys[pos] = keys[i];
+        outValues[pos] = values[i];
+    }
+    memcpy(keys, outKeys, n * sizeof(int));
+    memcpy(values, outValues, n * sizeof(int));
+    
+    sort_free(start);
+    sort_free(outKeys);
+    sort_free(outValues);
+    return 0;
+}
+
+/*
+ * Parallel variant: every thread scans its own slice of the input into
+ * a private histogram (no atomics), the histograms are summed into start
+ * offsets, and every thread then fills its own slice of the output,
+ * finding the first key of the slice by binary search on the offsets.
+ * Threads are capped so the histograms add up to at most
+ * n / COUNTING_PARALLEL_FILL slots; a range too wide for two of them
+ * goes to the serial countingSortRange
+ */
+typedef struct {
+    int *arr;
+    size_t n;
+    int slices;
+    int minVal;
+    size_t range;
+    int *slice_min;
+    int *slice_max;
+    size_t *hist;       // slices x range private histograms
+    size_t *start;      // range + 1 output offsets
+} CountingJob;
+
+static void sliceBounds(const CountingJob *job, size_t s, size_t *lo, size_t *hi) {
+    *lo = job->n * s / job->slices;
+    *hi = job->n * (s + 1) / job->slices;
+}
+
+static void countingRangeBody(size_t begin, size_t end, int worker, void *ctx) {
+    (void)worker;
+    CountingJob *job = (CountingJob *)ctx;
+    for (size_t s = begin; s < end; s++) {
+        size_t lo, hi;
+        sliceBounds(job, s, &lo, &hi);
+        keyRange(job->arr + lo, hi - lo, &job->slice_min[s], &job->slice_max[s]);
+    }
+}
+
+static void countingHistogramBody(size_t begin, size_t end, int worker, void *ctx) {
+    (void)worker;
+    CountingJob *job = (CountingJob *)ctx;
+    for (size_t s = begin; s < end; s++) {
+        size_t lo, hi;
+        sliceBounds(job, s, &lo, &hi);
+        size_t *count = job->hist + s * job->range;
+        for (size_t i = lo; i < hi; i++) count[job->arr[i] - job->minVal]++;
+    }
+}
+
+static void countingFillBody(size_t begin, size_t end, int worker, void *ctx) {
+    (void)worker;
+    CountingJob *job = (CountingJob *)ctx;
+    for (size_t s = begin; s < end; s++) {
+        size_t lo, hi;
+        sliceBounds(job, s, &lo, &hi);
+        
+        // Last key value whose run starts at or before lo
+        size_t left = 0, right = job->range;
+        while (left + 1 < right) {
+            size_t mid = left + (right - left) / 2;
+            if (job->start[mid] <= lo) left = mid;
+            else right = mid;
+        }
+        for (size_t v = left, k = lo; k < hi; v++) {
+            size_t stop = job->start[v + 1] < hi ? job->start[v + 1] : hi;
+            int key = (int)((long long)job->minVal + (long long)v);
+            while (k < stop) job->arr[k++] = key;
+        }
+    }
+}
+
+#define COUNTING_PARALLEL_FILL 8   // Keys per histogram slot, at least
+
+int countingSortParallel(int arr[], size_t n) {
+    size_t threads = (size_t)sortThreadCount();
+    size_t grain = sortTuning()->parallel_grain;
+    if (threads > n / grain) threads = n / grain;
+    if (threads < 2) return countingSort(arr, n);
+    
+    CountingJob job;
+    memset(&job, 0, sizeof(job));
+    job.arr = arr;
+    job.n = n;
+    job.slices = (int)threads;
+    job.slice_min = (int *)sort_malloc(threads * sizeof(int));
+    job.slice_max = (int *)sort_malloc(threads * sizeof(int));
+    if (!job.slice_min || !job.slice_max) {
+        sort_free(job.slice_min);
+        sort_free(job.slice_max);
+        return -1;
+    }
+    
+    parallelFor(threads, 1, countingRangeBody, &job);
+    int maxVal = job.slice_max[0];
+    job.minVal = job.slice_min[0];
+    for (size_t s = 1; s < threads; s++) {
+        if (job.slice_min[s] < job.minVal) job.minVal = job.slice_min[s];
+        if (job.slice_max[s] > maxVal) maxVal = job.slice_max[s];
+    }
+    sort_free(job.slice_min);
+    sort_free(job.slice_max);
+    
+    job.range = keySpan(job.minVal, maxVal);
+    if (job.range > COUNTING_MAX_RANGE) return -1;
+    
+    // The private histograms and the prefix pass over them cost
+    // threads x range: worth it only while that stays small next to n
+    size_t fit = n / (job.range * COUNTING_PARALLEL_FILL);
+    if (threads > fit) threads = fit;
+    if (threads < 2) return countingSortRange(arr, n, job.minVal, maxVal);
+    job.slices = (int)threads;
+    job.hist = (size_t *)sort_calloc(threads * job.range, sizeof(size_t));
+    job.start = (size_t *)sort_malloc((job.range + 1) * sizeof(size_t));
+    if (!job.hist || !job.start) {
+        sort_free(job.hist);
+        sort_free(job.start);
+        return -1;
+    }
+    
+    parallelFor(threads, 1, countingHistogramBody, &job);
+    size_t offset = 0;
+    for (size_t v = 0; v < job.range; v++) {
+        job.start[v] = offset;
+        for (size_t s = 0; s < threads; s++) offset += job.hist[s * job.range + v];
+    }
+    job.start[job.range] = offset;
+    parallelFor(threads, 1, countingFillBody, &job);
+    
+    sort_free(job.hist);
+    sort_free(job.start);
+    return 0;
+}
+
+// ============================================================
+// FUSED SORT + UNIQUE / GROUP COUNT
+// ============================================================
+
+/*
+ * Sorting and then sweeping the sorted array for runs reads all n keys
+ * once more. Here the grouping happens where the keys are put in order:
+ *
+ *   - Key range up to n (and COUNTING_MAX_RANGE): the counting histogram
+ *     already holds every run length, so the output walk writes one key
+ *     per run (or the run lengths, or just counts the runs) and the
+ *     duplicates are never written at all
+ *   - Otherwise: radix passes, with the grouping folded into the last
+ *     scatter (see radixGroupPass)
+ *
+ * If the scratch buffer cannot be had, the keys are sorted in place and
+ * swept afterwards.
+ */
+
+static size_t groupSweep(int arr[], size_t n, RadixGroup group, size_t counts[]) {
+    size_t m = 0;
+    int prev = 0;
+    for (size_t i = 0; i < n; i++) {
+        int key = arr[i];
+        if (m > 0 && key == prev) {
+            if (counts) counts[m - 1]++;
+            continue;
+        }
+        if (counts) counts[m] = 1;
+        if (group != RADIX_GROUP_DISTINCT) arr[m] = key;
+        prev = key;
+        m++;
+    }
+    return m;
+}
+
+static size_t groupCounting(int arr[], size_t n, int minVal, size_t range,
+                            RadixGroup group, size_t counts[]) {
+    size_t *hist = (size_t *)sort_calloc(range, sizeof(size_t));
+    if (!hist) return (size_t)-1;
+    for (size_t i = 0; i < n; i++) hist[arr[i] - minVal]++;
+    
+    size_t m = 0, k = 0;
+    for (size_t v = 0; v < range; v++) {
+        size_t c = hist[v];
+        if (c == 0) continue;
+        int key = (int)((long long)minVal + (long long)v);
+        if (group == RADIX_GROUP_DISTINCT) {
+            while (c-- > 0) arr[k++] = key;
+        } else {
+            if (counts) counts[m] = c;
+            arr[m] = key;
+        }
+        m++;
+    }
+    
+    sort_free(hist);
+    return m;
+}
+
+static size_t sortGrouped(int arr[], size_t n, RadixGroup group, size_t counts[]) {
+    if (n == 0) return 0;
+    int minVal, maxVal;
+    keyRange(arr, n, &minVal, &maxVal);
+    size_t range = keySpan(minVal, maxVal);
+    if (range <= n && range <= COUNTING_MAX_RANGE) {
+        size_t m = groupCounting(arr, n, minVal, range, group, counts);
+        if (m != (size_t)-1) return m;
+    }
+    
+    int *scratch = (int *)sort_malloc(n * sizeof(int));
+    size_t m = scratch ? radixSortGrouped(arr, scratch, n, group, counts) : (size_t)-1;
+    sort_free(scratch);
+    if (m != (size_t)-1) return m;
+    
+    quickSort3Way(arr, 0, (ptrdiff_t)n - 1);
+    return groupSweep(arr, n, group, counts);
+}
+
+/*
+ * Sort arr and drop repeated keys: the distinct keys end up in ascending
+ * order in arr[0..m)
+ * Returns m
+ */
+size_t sortUnique(int arr[], size_t n) {
+    return sortGrouped(arr, n, RADIX_GROUP_UNIQUE, NULL);
+}
+
+/*
+ * Group equal keys: arr[0..m) receives the distinct keys in ascending
+ * order and counts[0..m) how often each occurred (counts needs room for
+ * n entries, since the keys may all differ)
+ * Returns m
+ */
+size_t sortRunLengths(int arr[], size_t n, size_t counts[]) {
+    return sortGrouped(arr, n, RADIX_GROUP_RUNS, counts);
+}
+
+/*
+ * Sort arr (all n keys are kept)
+ * Returns the number of distinct keys
+ */
+size_t sortDistinctCount(int arr[], size_t n) {
+    return sortGrouped(arr, n, RADIX_GROUP_DISTINCT, NULL);
+}
@@ -0,0 +1,197 @@
+/*
+ * Random Number Generation for Test Inputs
+ *
+ * xoshiro256** (Blackman & Vigna) seeded through splitmix64:
+ *   - Explicit seeds: the same seed always produces the same inputs
+ *   - Unbiased bounded values with Lemire's multiply-shift rejection,
+ *     over the full 64-bit range (no RAND_MAX limit, no modulo bias)
+ *   - Independent streams via the jump function (2^128 steps apart)
+ *
+ * Large arrays are filled in parallel. The array is cut into fixed-size
+ * chunks and chunk k always uses the generator jumped k times from the
+ * call's seed, so the output does not depend on the number of threads.
+ */
+
+#include "../include/sorting.h"
+
+#define RNG_CHUNK (1u << 16)   // Elements per independent stream
+
+static SortRng seed_rng;       // Hands out one seed per generator call
+static int seed_rng_ready = 0;
+static uint64_t sort_seed = 0;
+
+static uint64_t splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+void rngSeed(SortRng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&seed);
+    }
+}
+
+uint64_t rngNext(SortRng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+/*
+ * Uniform value in [0, range) without modulo bias
+ * range == 0 means the full 2^64 range
+ */
+uint64_t rngBounded(SortRng *rng, uint64_t range) {
+    if (range == 0) return rngNext(rng);
+    
+    __uint128_t m = (__uint128_t)rngNext(rng) * range;
+    uint64_t low = (uint64_t)m;
+    if (low < range) {
+        uint64_t threshold = -range % range;
+        while (low < threshold) {
+            m = (__uint128_t)rngNext(rng) * range;
+            low = (uint64_t)m;
+        }
+    }
+    return (uint64_t)(m >> 64);
+}
+
+// Uniform double in [0, 1) from the top 53 bits
+double rngUniform(SortRng *rng) {
+    return (rngNext(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Advance the generator by 2^128 steps (start of the next independent stream)
+void rngJump(SortRng *rng) {
+    static const uint64_t JUMP[] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ULL << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            rngNext(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+// ============================================================
+// SEEDING
+// ============================================================
+
+void setSortSeed(uint64_t seed) {
+    sort_seed = seed;
+    rngSeed(&seed_rng, seed);
+    seed_rng_ready = 1;
+}
+
+uint64_t getSortSeed(void) {
+    if (!seed_rng_ready) setSortSeed((uint64_t)time(NULL));
+    return sort_seed;
+}
+
+// Seed for the next generator call: a run is reproducible from sort_seed
+uint64_t nextInputSeed(void) {
+    if (!seed_rng_ready) setSortSeed((uint64_t)time(NULL));
+    return rngNext(&seed_rng);
+}
+
+// Restart the generator seeds from seed, leaving getSortSeed() alone:
+// the next generator call then repeats the one that followed the same
+// setInputSeed() in an earlier run
+void setInputSeed(uint64_t seed) {
+    if (!seed_rng_ready) setSortSeed((uint64_t)time(NULL));
+    rngSeed(&seed_rng, seed);
+}
+
+// ============================================================
+// PARALLEL FILLS
+// ============================================================
+
+typedef struct {
+    uint64_t seed;
+    size_t n;
+    StreamFill fill;
+    void *ctx;
+} StreamJob;
+
+static void fillChunks(size_t firstChunk, size_t endChunk, int worker, void *arg) {
+    (void)worker;
+    StreamJob *job = (StreamJob *)arg;
+    SortRng stream;
+    rngSeed(&stream, job->seed);
+    for (size_t c = 0; c < firstChunk; c++) rngJump(&stream);
+    
+    for (size_t c = firstChunk; c < endChunk; c++) {
+        SortRng rng = stream;
+        size_t begin = c * RNG_CHUNK;
+        size_t end = begin + RNG_CHUNK < job->n ? begin + RNG_CHUNK : job->n;
+        job->fill(&rng, begin, end, job->ctx);
+        rngJump(&stream);
+    }
+}
+
+/*
+ * Call fill(rng, begin, end, ctx) over [0, n) in chunks, in parallel
+ * Chunk k always gets the k-th independent stream of seed
+ */
+void parallelFillStreams(size_t n, uint64_t seed, StreamFill fill, void *ctx) {
+    StreamJob job = {seed, n, fill, ctx};
+    size_t chunks = (n + RNG_CHUNK - 1) / RNG_CHUNK;
+    parallelFor(chunks, 1, fillChunks, &job);
+}
+
+typedef struct {
+    int64_t minVal;
+    uint64_t range;      // maxVal - minVal + 1 (0 = full 64-bit range)
+    int *out32;          // Exactly one of out32/out64 is set
+    int64_t *out64;
+} UniformFill;
+
+static void fillUniformRange(SortRng *rng, size_t begin, size_t end, void *ctx) {
+    UniformFill *u = (UniformFill *)ctx;
+    if (u->out32) {
+        for (size_t i = begin; i < end; i++) {
+            u->out32[i] = (int)(u->minVal + (int64_t)rngBounded(rng, u->range));
+        }
+    } else {
+        for (size_t i = begin; i < end; i++) {
+            u->out64[i] = (int64_t)((uint64_t)u->minVal + rngBounded(rng, u->range));
+        }
+    }
+}
+
+// Uniform ints in [minVal, maxVal], reproducible for a given seed
+void fillRandomRange(int arr[], size_t n, int minVal, int maxVal, uint64_t seed) {
+    UniformFill u = {minVal, (uint64_t)((int64_t)maxVal - minVal + 1), arr, NULL};
+    parallelFillStreams(n, seed, fillUniformRange, &u);
+}
+
+// Uniform 64-bit ints in [minVal, maxVal], reproducible for a given seed
+void fillRandomRange64(int64_t arr[], size_t n, int64_t minVal, int64_t maxVal, uint64_t seed) {
+    UniformFill u = {minVal, (uint64_t)maxVal - (uint64_t)minVal + 1, NULL, arr};
+    parallelFillStreams(n, seed, fillUniformRange, &u);
+}
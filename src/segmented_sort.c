@@ -0,0 +1,151 @@
+/*
+ * Segmented Batch Sort
+ *
+ * Sorts many small independent arrays stored back to back in one buffer.
+ * offsets[] has segments + 1 entries (CSR layout): segment s is
+ * keys[offsets[s] .. offsets[s + 1]).
+ *
+ * Every segment is sent to the cheapest kernel for its length:
+ *   - up to 16 keys       -> Batcher odd-even merge network (branchless,
+ *                            unrolled, in registers)
+ *   - up to small_sort_max -> insertion sort
+ *   - below SEGMENT_RADIX_MIN -> vectorized quick sort
+ *   - longer               -> LSD radix sort with a per-worker scratch buffer
+ *
+ * Threads get contiguous runs of segments holding about the same number
+ * of keys, not the same number of segments, so a few long segments do
+ * not leave the other workers idle. Segments are never split.
+ *
+ * Complexity: the sum of the per-segment kernels, O(max segment) extra
+ * space per thread
+ */
+
+#include "../include/sorting.h"
+#include <limits.h>
+
+#define SEGMENT_NETWORK_MAX 16
+#define SEGMENT_RADIX_MIN 1024   // Radix histograms pay off from here up
+
+// ============================================================
+// SORTING NETWORKS
+// ============================================================
+
+// Batcher's odd-even merge sort; 8 keys need 19 comparators (optimal),
+// 16 keys 63
+#define NETWORK8(CE)                                                          \
+    CE(0, 1) CE(2, 3) CE(4, 5) CE(6, 7) CE(0, 2) CE(1, 3) CE(4, 6) CE(5, 7)   \
+    CE(1, 2) CE(5, 6) CE(0, 4) CE(1, 5) CE(2, 6) CE(3, 7) CE(2, 4) CE(3, 5)   \
+    CE(1, 2) CE(3, 4) CE(5, 6)
+
+#define NETWORK16(CE)                                                         \
+    CE(0, 1) CE(2, 3) CE(4, 5) CE(6, 7) CE(8, 9) CE(10, 11) CE(12, 13)        \
+    CE(14, 15) CE(0, 2) CE(1, 3) CE(4, 6) CE(5, 7) CE(8, 10) CE(9, 11)        \
+    CE(12, 14) CE(13, 15) CE(1, 2) CE(5, 6) CE(9, 10) CE(13, 14) CE(0, 4)     \
+    CE(1, 5) CE(2, 6) CE(3, 7) CE(8, 12) CE(9, 13) CE(10, 14) CE(11, 15)      \
+    CE(2, 4) CE(3, 5) CE(10, 12) CE(11, 13) CE(1, 2) CE(3, 4) CE(5, 6)        \
+    CE(9, 10) CE(11, 12) CE(13, 14) CE(0, 8) CE(1, 9) CE(2, 10) CE(3, 11)     \
+    CE(4, 12) CE(5, 13) CE(6, 14) CE(7, 15) CE(4, 8) CE(5, 9) CE(6, 10)       \
+    CE(7, 11) CE(2, 4) CE(3, 5) CE(6, 8) CE(7, 9) CE(10, 12) CE(11, 13)       \
+    CE(1, 2) CE(3, 4) CE(5, 6) CE(7, 8) CE(9, 10) CE(11, 12) CE(13, 14)
+
+// Compare-exchange as min/max, so the compiler emits no branches
+#define COMPARE_EXCHANGE(i, j) {                  \
+        int lo = v[i] < v[j] ? v[i] : v[j];       \
+        int hi = v[i] < v[j] ? v[j] : v[i];       \
+        v[i] = lo;                                \
+        v[j] = hi;                                \
+    }
+
+/*
+ * Sort up to 16 keys: pad with INT_MAX to the network width, which
+ * leaves the padding at the end
+ */
+static void networkSort(int a[], size_t n) {
+    int v[SEGMENT_NETWORK_MAX];
+    memcpy(v, a, n * sizeof(int));
+    if (n <= 8) {
+        for (size_t i = n; i < 8; i++) v[i] = INT_MAX;
+        NETWORK8(COMPARE_EXCHANGE)
+    } else {
+        for (size_t i = n; i < SEGMENT_NETWORK_MAX; i++) v[i] = INT_MAX;
+        NETWORK16(COMPARE_EXCHANGE)
+    }
+    memcpy(a, v, n * sizeof(int));
+}
+
+// ============================================================
+// SEGMENT DISPATCH
+// ============================================================
+
+typedef struct {
+    int *keys;
+    const size_t *offsets;
+    size_t segments;
+    size_t insertion_max;   // small_sort_max of the tuning profile
+    int *scratch;           // scratch_len ints per worker (radix segments)
+    size_t scratch_len;
+} SegmentJob;
+
+static void sortSegment(const SegmentJob *job, int a[], size_t n, int scratch[]) {
+    if (n < 2) return;
+    if (n <= SEGMENT_NETWORK_MAX) networkSort(a, n);
+    else if (n <= job->insertion_max) insertionSort(a, n);
+    else if (n < SEGMENT_RADIX_MIN) simdSort32((int32_t *)a, n);
+    else radixSortLSDBuffered(a, scratch, n);
+}
+
+// First segment that starts at or after key position pos
+static size_t segmentAt(const size_t offsets[], size_t segments, size_t pos) {
+    size_t lo = 0, hi = segments;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (offsets[mid] < pos) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/*
+ * [begin, end) is a range of key positions; the body sorts the segments
+ * that start inside it, so every segment has exactly one owner
+ */
+static void segmentBody(size_t begin, size_t end, int worker, void *ctx) {
+    SegmentJob *job = (SegmentJob *)ctx;
+    size_t base = job->offsets[0];
+    size_t first = segmentAt(job->offsets, job->segments, base + begin);
+    size_t last = segmentAt(job->offsets, job->segments, base + end);
+    int *scratch = job->scratch ? job->scratch + (size_t)worker * job->scratch_len : NULL;
+
+    for (size_t s = first; s < last; s++) {
+        size_t lo = job->offsets[s];
+        sortSegment(job, job->keys + lo, job->offsets[s + 1] - lo, scratch);
+    }
+}
+
+/*
+ * Sort every segment of keys in place
+ * Returns 0 on success, -1 if offsets decrease or memory runs out
+ * (keys are then unchanged)
+ */
+int segmentedSort(int keys[], const size_t offsets[], size_t segments) {
+    if (segments == 0) return 0;
+
+    size_t longest = 0;
+    for (size_t s = 0; s < segments; s++) {
+        if (offsets[s + 1] < offsets[s]) return -1;
+        size_t len = offsets[s + 1] - offsets[s];
+        if (len > longest) longest = len;
+    }
+
+    int workers = sortThreadCount();
+    SegmentJob job = {keys, offsets, segments, (size_t)sortTuning()->small_sort_max, NULL, 0};
+    if (longest >= SEGMENT_RADIX_MIN) {
+        job.scratch_len = longest;
+        job.scratch = (int *)sort_malloc((size_t)workers * longest * sizeof(int));
+        if (!job.scratch) return -1;
+    }
+
+    parallelFor(offsets[segments] - offsets[0], sortTuning()->parallel_grain, segmentBody, &job);
+    sort_free(job.scratch);
+    return 0;
+}
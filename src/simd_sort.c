@@ -0,0 +1,561 @@
+/*
+ * Vectorized Quick Sort (AVX-512 / AVX2, runtime dispatch)
+ *
+ * Same divide and conquer as quickSort, but the work is done a whole
+ * vector at a time:
+ * 1. Partition: W keys are loaded, compared with the pivot in one
+ *    instruction, and the resulting lane mask splits them. AVX-512 writes
+ *    both halves with compress-store; AVX2 has no compress, so a lookup
+ *    table of permutations packs the "< pivot" lanes first and the vector
+ *    is stored to both ends. The two outermost vectors are held in
+ *    registers so the partition is in place.
+ * 2. Leaves of at most 2W keys are sorted inside registers with a
+ *    bitonic network (one register, or two followed by a bitonic merge).
+ * 3. Like introsort, recursion depth is capped at 2 log2(n); beyond it
+ *    the range is finished with heap sort.
+ *
+ * The ISA is chosen once at first use with __builtin_cpu_supports; the
+ * SORT_ISA environment variable (scalar, avx2, avx512) can force a lower
+ * level. Without AVX2 everything goes to the scalar introsort.
+ * Float arrays must not contain NaN.
+ *
+ * Complexity: O(n log n) average and worst case, O(log n) stack
+ */
+
+#include "../include/sorting.h"
+#include <math.h>
+#include <pthread.h>
+#include <immintrin.h>
+
+#define INSERTION_MAX 16   // Scalar introsort finishes ranges this small
+
+// ============================================================
+// SCALAR INTROSORT (fallback and depth-limit escape)
+// ============================================================
+
+#define DEFINE_INTROSORT(NAME, T)                                                 \
+                                                                                  \
+static void NAME##Insertion(T *a, size_t n) {                                     \
+    for (size_t i = 1; i < n; i++) {                                              \
+        T x = a[i];                                                               \
+        size_t j = i;                                                             \
+        while (j > 0 && x < a[j - 1]) {                                           \
+            a[j] = a[j - 1];                                                      \
+            j--;                                                                  \
+        }                                                                         \
+        a[j] = x;                                                                 \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+static void NAME##SiftDown(T *a, size_t root, size_t n) {                         \
+    T x = a[root];                                                                \
+    size_t child;                                                                 \
+    while ((child = 2 * root + 1) < n) {                                          \
+        if (child + 1 < n && a[child] < a[child + 1]) child++;                    \
+        if (!(x < a[child])) break;                                               \
+        a[root] = a[child];                                                       \
+        root = child;                                                             \
+    }                                                                             \
+    a[root] = x;                                                                  \
+}                                                                                 \
+                                                                                  \
+static void NAME##HeapSort(T *a, size_t n) {                                      \
+    for (size_t i = n / 2; i-- > 0;) NAME##SiftDown(a, i, n);                     \
+    for (size_t i = n; i-- > 1;) {                                                \
+        T t = a[0]; a[0] = a[i]; a[i] = t;                                        \
+        NAME##SiftDown(a, 0, i);                                                  \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+/* Hoare partition around the median of first, middle and last; */             \
+/* returns j with a[0..j] <= pivot <= a[j+1..n), both sides non-empty */         \
+static size_t NAME##Partition(T *a, size_t n) {                                   \
+    size_t mid = (n - 1) / 2;                                                     \
+    T t;                                                                          \
+    if (a[mid] < a[0]) { t = a[mid]; a[mid] = a[0]; a[0] = t; }                   \
+    if (a[n - 1] < a[mid]) { t = a[n - 1]; a[n - 1] = a[mid]; a[mid] = t; }       \
+    if (a[mid] < a[0]) { t = a[mid]; a[mid] = a[0]; a[0] = t; }                   \
+    T pivot = a[mid];                                                             \
+    ptrdiff_t i = -1, j = (ptrdiff_t)n;                                           \
+    for (;;) {                                                                    \
+        do i++; while (a[i] < pivot);                                             \
+        do j--; while (pivot < a[j]);                                             \
+        if (i >= j) return (size_t)j;                                             \
+        t = a[i]; a[i] = a[j]; a[j] = t;                                          \
+    }                                                                             \
+}                                                                                 \
+                                                                                  \
+static void NAME##Rec(T *a, size_t n, int depth) {                                \
+    while (n > INSERTION_MAX) {                                                   \
+        if (depth-- == 0) {                                                       \
+            NAME##HeapSort(a, n);                                                 \
+            return;                                                               \
+        }                                                                         \
+        size_t left = NAME##Partition(a, n) + 1;                                  \
+        if (left < n - left) {                                                    \
+            NAME##Rec(a, left, depth);                                            \
+            a += left;                                                            \
+            n -= left;                                                            \
+        } else {                                                                  \
+            NAME##Rec(a + left, n - left, depth);                                 \
+            n = left;                                                             \
+        }                                                                         \
+    }                                                                             \
+    NAME##Insertion(a, n);                                                        \
+}                                                                                 \
+                                                                                  \
+static void NAME##Sort(T *a, size_t n) {                                          \
+    if (n > 1) NAME##Rec(a, n, depthLimit(n));                                    \
+}
+
+static int depthLimit(size_t n) {
+    int depth = 0;
+    while (n > 1) {
+        n >>= 1;
+        depth += 2;
+    }
+    return depth;
+}
+
+DEFINE_INTROSORT(intro32, int32_t)
+DEFINE_INTROSORT(intro64, int64_t)
+DEFINE_INTROSORT(introF, float)
+
+// ============================================================
+// LOOKUP TABLES (filled once by simdInit)
+// ============================================================
+
+/*
+ * Bitonic network of W lanes, one entry per compare-exchange step:
+ * lane i is paired with lane i ^ j and keeps the larger key when it is
+ * the upper lane of an ascending block or the lower lane of a
+ * descending one. The last log2(W) steps alone merge a bitonic register.
+ */
+static int32_t net16_idx[10][16];   // AVX-512 32-bit lanes
+static uint16_t net16_max[10];
+static int64_t net8q_idx[6][8];     // AVX-512 64-bit lanes
+static uint8_t net8q_max[6];
+static int32_t net8_idx[6][8];      // AVX2 32-bit lanes
+static int32_t net8_max[6][8];
+static int32_t net4_idx[3][8];      // AVX2 64-bit lanes (as 32-bit pairs)
+static int64_t net4_max[3][4];
+static int32_t rev16_idx[16];
+static int64_t rev8q_idx[8];
+static int32_t rev8_idx[8];
+static int32_t rev4_idx[8];
+
+// AVX2 compress emulation: lanes with the mask bit set first, then the rest
+static uint8_t perm8[256][8];       // 32-bit lanes
+static uint8_t perm4[16][8];        // 64-bit lanes as 32-bit pairs
+
+static int bitonicSteps(int lanes, int partner[][16], int takes_max[][16]) {
+    int steps = 0;
+    for (int k = 2; k <= lanes; k *= 2) {
+        for (int j = k / 2; j > 0; j /= 2) {
+            for (int i = 0; i < lanes; i++) {
+                int ascending = (i & k) == 0 || k == lanes;
+                int upper = (i & j) != 0;
+                partner[steps][i] = i ^ j;
+                takes_max[steps][i] = upper == ascending;
+            }
+            steps++;
+        }
+    }
+    return steps;
+}
+
+static void fillTables(void) {
+    int partner[10][16], takes_max[10][16];
+
+    int steps = bitonicSteps(16, partner, takes_max);
+    for (int s = 0; s < steps; s++) {
+        net16_max[s] = 0;
+        for (int i = 0; i < 16; i++) {
+            net16_idx[s][i] = partner[s][i];
+            if (takes_max[s][i]) net16_max[s] |= (uint16_t)(1u << i);
+        }
+    }
+
+    steps = bitonicSteps(8, partner, takes_max);
+    for (int s = 0; s < steps; s++) {
+        net8q_max[s] = 0;
+        for (int i = 0; i < 8; i++) {
+            net8q_idx[s][i] = partner[s][i];
+            net8_idx[s][i] = partner[s][i];
+            net8_max[s][i] = takes_max[s][i] ? -1 : 0;
+            if (takes_max[s][i]) net8q_max[s] |= (uint8_t)(1u << i);
+        }
+    }
+
+    steps = bitonicSteps(4, partner, takes_max);
+    for (int s = 0; s < steps; s++) {
+        for (int i = 0; i < 4; i++) {
+            net4_idx[s][2 * i] = 2 * partner[s][i];
+            net4_idx[s][2 * i + 1] = 2 * partner[s][i] + 1;
+            net4_max[s][i] = takes_max[s][i] ? -1 : 0;
+        }
+    }
+
+    for (int i = 0; i < 16; i++) rev16_idx[i] = 15 - i;
+    for (int i = 0; i < 8; i++) {
+        rev8q_idx[i] = 7 - i;
+        rev8_idx[i] = 7 - i;
+    }
+    for (int i = 0; i < 4; i++) {
+        rev4_idx[2 * i] = 2 * (3 - i);
+        rev4_idx[2 * i + 1] = 2 * (3 - i) + 1;
+    }
+
+    for (int m = 0; m < 256; m++) {
+        int k = 0;
+        for (int i = 0; i < 8; i++) if (m & (1 << i)) perm8[m][k++] = (uint8_t)i;
+        for (int i = 0; i < 8; i++) if (!(m & (1 << i))) perm8[m][k++] = (uint8_t)i;
+    }
+    for (int m = 0; m < 16; m++) {
+        int k = 0;
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = 0; i < 4; i++) {
+                if (((m >> i) & 1) != (pass == 0)) continue;
+                perm4[m][k++] = (uint8_t)(2 * i);
+                perm4[m][k++] = (uint8_t)(2 * i + 1);
+            }
+        }
+    }
+}
+
+// ============================================================
+// GENERIC VECTOR QUICKSORT
+// ============================================================
+
+/*
+ * Instantiated once per ISA and key type. P names the primitive set:
+ *   P##Load, P##Store, P##Set1, P##Min, P##Max, P##Step (one network
+ *   step), P##Reverse, P##LessMask (lanes < pivot as bits) and
+ *   P##StorePartition (lanes < pivot to left, the others ending at
+ *   right + (W - count)).
+ * S is the matching scalar introsort, TMAX pads partial leaves.
+ */
+#define DEFINE_VQSORT(P, T, V, W, STEPS, LOG_W, S, TMAX)                          \
+                                                                                  \
+static inline V P##Network(V v, int from) {                                       \
+    for (int s = from; s < STEPS; s++) v = P##Step(v, s);                         \
+    return v;                                                                     \
+}                                                                                 \
+                                                                                  \
+static inline T P##Median3(T x, T y, T z) {                                      \
+    if (y < x) { T t = x; x = y; y = t; }                                         \
+    if (z < y) y = z;                                                             \
+    return y < x ? x : y;                                                         \
+}                                                                                 \
+                                                                                  \
+static void P##Leaf(T *a, size_t n) {                                             \
+    T buf[2 * W];                                                                 \
+    for (size_t i = 0; i < 2 * W; i++) buf[i] = i < n ? a[i] : TMAX;              \
+    V x = P##Network(P##Load(buf), 0);                                            \
+    if (n > W) {                                                                  \
+        V y = P##Reverse(P##Network(P##Load(buf + W), 0));                        \
+        V lo = P##Min(x, y), hi = P##Max(x, y);                                   \
+        x = P##Network(lo, STEPS - LOG_W);                                        \
+        P##Store(buf + W, P##Network(hi, STEPS - LOG_W));                         \
+    }                                                                             \
+    P##Store(buf, x);                                                             \
+    memcpy(a, buf, n * sizeof(T));                                                \
+}                                                                                 \
+                                                                                  \
+/* a[0..k) < pivot <= a[k..n), requires n >= 2W */                               \
+static size_t P##Partition(T *a, size_t n, T pivot) {                             \
+    V pv = P##Set1(pivot);                                                        \
+    V first = P##Load(a), last = P##Load(a + n - W);                              \
+    size_t read_l = W, read_r = n - W;                                            \
+    size_t write_l = 0, write_r = n;                                              \
+                                                                                  \
+    /* Read from whichever side has less free space, so stores never */          \
+    /* reach keys that have not been loaded yet */                               \
+    while (read_r - read_l >= W) {                                                \
+        V v;                                                                      \
+        if (read_l - write_l <= write_r - read_r) {                               \
+            v = P##Load(a + read_l);                                              \
+            read_l += W;                                                          \
+        } else {                                                                  \
+            read_r -= W;                                                          \
+            v = P##Load(a + read_r);                                              \
+        }                                                                         \
+        unsigned mask = P##LessMask(v, pv);                                       \
+        int count = __builtin_popcount(mask);                                     \
+        write_r -= W - count;                                                     \
+        P##StorePartition(a + write_l, a + write_r, v, mask, count);              \
+        write_l += count;                                                         \
+    }                                                                             \
+                                                                                  \
+    T tail[W];                                                                    \
+    size_t rest = read_r - read_l;                                                \
+    memcpy(tail, a + read_l, rest * sizeof(T));                                   \
+    for (size_t i = 0; i < rest; i++) {                                           \
+        if (tail[i] < pivot) a[write_l++] = tail[i];                              \
+        else a[--write_r] = tail[i];                                              \
+    }                                                                             \
+                                                                                  \
+    V held[2] = {first, last};                                                    \
+    for (int h = 0; h < 2; h++) {                                                 \
+        unsigned mask = P##LessMask(held[h], pv);                                 \
+        int count = __builtin_popcount(mask);                                     \
+        write_r -= W - count;                                                     \
+        P##StorePartition(a + write_l, a + write_r, held[h], mask, count);        \
+        write_l += count;                                                         \
+    }                                                                             \
+    return write_l;                                                               \
+}                                                                                 \
+                                                                                  \
+static void P##Rec(T *a, size_t n, int depth) {                                   \
+    while (n > 2 * W) {                                                           \
+        if (depth-- == 0) {                                                       \
+            S##HeapSort(a, n);                                                    \
+            return;                                                               \
+        }                                                                         \
+        /* Tukey's ninther: the held end vectors land mid-range after */         \
+        /* each partition, so first/middle/last alone degrades on runs */         \
+        size_t step = n / 8;                                                      \
+        T pivot = P##Median3(P##Median3(a[0], a[step], a[2 * step]),              \
+                             P##Median3(a[3 * step], a[4 * step], a[5 * step]),   \
+                             P##Median3(a[6 * step], a[7 * step], a[n - 1]));     \
+        T t;                                                                      \
+        size_t k = P##Partition(a, n, pivot);                                     \
+        if (k == 0) {                                                             \
+            /* pivot is the minimum: its copies are already in place */          \
+            size_t e = 0;                                                         \
+            for (size_t i = 0; i < n; i++) {                                      \
+                if (a[i] == pivot) { t = a[e]; a[e++] = a[i]; a[i] = t; }         \
+            }                                                                     \
+            a += e;                                                               \
+            n -= e;                                                               \
+            continue;                                                             \
+        }                                                                         \
+        if (k < n - k) {                                                          \
+            P##Rec(a, k, depth);                                                  \
+            a += k;                                                               \
+            n -= k;                                                               \
+        } else {                                                                  \
+            P##Rec(a + k, n - k, depth);                                          \
+            n = k;                                                                \
+        }                                                                         \
+    }                                                                             \
+    if (n > 1) P##Leaf(a, n);                                                     \
+}                                                                                 \
+                                                                                  \
+static void P##Sort(T *a, size_t n) {                                             \
+    if (n > 1) P##Rec(a, n, depthLimit(n));                                       \
+}
+
+// ============================================================
+// AVX-512 PRIMITIVES
+// ============================================================
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512vl,avx512bw,popcnt")
+
+// int32, 16 lanes
+static inline __m512i z32Load(const int32_t *p) { return _mm512_loadu_si512(p); }
+static inline void z32Store(int32_t *p, __m512i v) { _mm512_storeu_si512(p, v); }
+static inline __m512i z32Set1(int32_t x) { return _mm512_set1_epi32(x); }
+static inline __m512i z32Min(__m512i a, __m512i b) { return _mm512_min_epi32(a, b); }
+static inline __m512i z32Max(__m512i a, __m512i b) { return _mm512_max_epi32(a, b); }
+static inline __m512i z32Step(__m512i v, int s) {
+    __m512i w = _mm512_permutexvar_epi32(_mm512_loadu_si512(net16_idx[s]), v);
+    return _mm512_mask_blend_epi32(net16_max[s], _mm512_min_epi32(v, w), _mm512_max_epi32(v, w));
+}
+static inline __m512i z32Reverse(__m512i v) {
+    return _mm512_permutexvar_epi32(_mm512_loadu_si512(rev16_idx), v);
+}
+static inline unsigned z32LessMask(__m512i v, __m512i p) { return _mm512_cmplt_epi32_mask(v, p); }
+static inline void z32StorePartition(int32_t *l, int32_t *r, __m512i v, unsigned m, int c) {
+    (void)c;
+    _mm512_mask_compressstoreu_epi32(l, (__mmask16)m, v);
+    _mm512_mask_compressstoreu_epi32(r, (__mmask16)~m, v);
+}
+
+// int64, 8 lanes
+static inline __m512i z64Load(const int64_t *p) { return _mm512_loadu_si512(p); }
+static inline void z64Store(int64_t *p, __m512i v) { _mm512_storeu_si512(p, v); }
+static inline __m512i z64Set1(int64_t x) { return _mm512_set1_epi64(x); }
+static inline __m512i z64Min(__m512i a, __m512i b) { return _mm512_min_epi64(a, b); }
+static inline __m512i z64Max(__m512i a, __m512i b) { return _mm512_max_epi64(a, b); }
+static inline __m512i z64Step(__m512i v, int s) {
+    __m512i w = _mm512_permutexvar_epi64(_mm512_loadu_si512(net8q_idx[s]), v);
+    return _mm512_mask_blend_epi64(net8q_max[s], _mm512_min_epi64(v, w), _mm512_max_epi64(v, w));
+}
+static inline __m512i z64Reverse(__m512i v) {
+    return _mm512_permutexvar_epi64(_mm512_loadu_si512(rev8q_idx), v);
+}
+static inline unsigned z64LessMask(__m512i v, __m512i p) { return _mm512_cmplt_epi64_mask(v, p); }
+static inline void z64StorePartition(int64_t *l, int64_t *r, __m512i v, unsigned m, int c) {
+    (void)c;
+    _mm512_mask_compressstoreu_epi64(l, (__mmask8)m, v);
+    _mm512_mask_compressstoreu_epi64(r, (__mmask8)~m, v);
+}
+
+// float, 16 lanes
+static inline __m512 zfLoad(const float *p) { return _mm512_loadu_ps(p); }
+static inline void zfStore(float *p, __m512 v) { _mm512_storeu_ps(p, v); }
+static inline __m512 zfSet1(float x) { return _mm512_set1_ps(x); }
+static inline __m512 zfMin(__m512 a, __m512 b) { return _mm512_min_ps(a, b); }
+static inline __m512 zfMax(__m512 a, __m512 b) { return _mm512_max_ps(a, b); }
+static inline __m512 zfStep(__m512 v, int s) {
+    __m512 w = _mm512_permutexvar_ps(_mm512_loadu_si512(net16_idx[s]), v);
+    return _mm512_mask_blend_ps(net16_max[s], _mm512_min_ps(v, w), _mm512_max_ps(v, w));
+}
+static inline __m512 zfReverse(__m512 v) {
+    return _mm512_permutexvar_ps(_mm512_loadu_si512(rev16_idx), v);
+}
+static inline unsigned zfLessMask(__m512 v, __m512 p) { return _mm512_cmp_ps_mask(v, p, _CMP_LT_OQ); }
+static inline void zfStorePartition(float *l, float *r, __m512 v, unsigned m, int c) {
+    (void)c;
+    _mm512_mask_compressstoreu_ps(l, (__mmask16)m, v);
+    _mm512_mask_compressstoreu_ps(r, (__mmask16)~m, v);
+}
+
+DEFINE_VQSORT(z32, int32_t, __m512i, 16, 10, 4, intro32, INT32_MAX)
+DEFINE_VQSORT(z64, int64_t, __m512i, 8, 6, 3, intro64, INT64_MAX)
+DEFINE_VQSORT(zf, float, __m512, 16, 10, 4, introF, INFINITY)
+
+#pragma GCC pop_options
+
+// ============================================================
+// AVX2 PRIMITIVES
+// ============================================================
+
+#pragma GCC push_options
+#pragma GCC target("avx2,popcnt")
+
+static inline __m256i permFromTable(const uint8_t idx[8]) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)idx));
+}
+
+// int32, 8 lanes
+static inline __m256i y32Load(const int32_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+static inline void y32Store(int32_t *p, __m256i v) { _mm256_storeu_si256((__m256i *)p, v); }
+static inline __m256i y32Set1(int32_t x) { return _mm256_set1_epi32(x); }
+static inline __m256i y32Min(__m256i a, __m256i b) { return _mm256_min_epi32(a, b); }
+static inline __m256i y32Max(__m256i a, __m256i b) { return _mm256_max_epi32(a, b); }
+static inline __m256i y32Step(__m256i v, int s) {
+    __m256i w = _mm256_permutevar8x32_epi32(v, y32Load(net8_idx[s]));
+    return _mm256_blendv_epi8(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), y32Load(net8_max[s]));
+}
+static inline __m256i y32Reverse(__m256i v) {
+    return _mm256_permutevar8x32_epi32(v, y32Load(rev8_idx));
+}
+static inline unsigned y32LessMask(__m256i v, __m256i p) {
+    return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(p, v)));
+}
+// Full-width stores: the caller guarantees W free slots at both ends
+static inline void y32StorePartition(int32_t *l, int32_t *r, __m256i v, unsigned m, int c) {
+    __m256i packed = _mm256_permutevar8x32_epi32(v, permFromTable(perm8[m]));
+    y32Store(l, packed);
+    y32Store(r - c, packed);
+}
+
+// int64, 4 lanes (no 64-bit min/max before AVX-512)
+static inline __m256i y64Load(const int64_t *p) { return _mm256_loadu_si256((const __m256i *)p); }
+static inline void y64Store(int64_t *p, __m256i v) { _mm256_storeu_si256((__m256i *)p, v); }
+static inline __m256i y64Set1(int64_t x) { return _mm256_set1_epi64x(x); }
+static inline __m256i y64Min(__m256i a, __m256i b) { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+static inline __m256i y64Max(__m256i a, __m256i b) { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+static inline __m256i y64Step(__m256i v, int s) {
+    __m256i w = _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256((const __m256i *)net4_idx[s]));
+    return _mm256_blendv_epi8(y64Min(v, w), y64Max(v, w), y64Load(net4_max[s]));
+}
+static inline __m256i y64Reverse(__m256i v) {
+    return _mm256_permutevar8x32_epi32(v, _mm256_loadu_si256((const __m256i *)rev4_idx));
+}
+static inline unsigned y64LessMask(__m256i v, __m256i p) {
+    return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(p, v)));
+}
+static inline void y64StorePartition(int64_t *l, int64_t *r, __m256i v, unsigned m, int c) {
+    __m256i packed = _mm256_permutevar8x32_epi32(v, permFromTable(perm4[m]));
+    y64Store(l, packed);
+    y64Store(r - c, packed);
+}
+
+// float, 8 lanes
+static inline __m256 yfLoad(const float *p) { return _mm256_loadu_ps(p); }
+static inline void yfStore(float *p, __m256 v) { _mm256_storeu_ps(p, v); }
+static inline __m256 yfSet1(float x) { return _mm256_set1_ps(x); }
+static inline __m256 yfMin(__m256 a, __m256 b) { return _mm256_min_ps(a, b); }
+static inline __m256 yfMax(__m256 a, __m256 b) { return _mm256_max_ps(a, b); }
+static inline __m256 yfStep(__m256 v, int s) {
+    __m256 w = _mm256_permutevar8x32_ps(v, y32Load(net8_idx[s]));
+    return _mm256_blendv_ps(_mm256_min_ps(v, w), _mm256_max_ps(v, w),
+                            _mm256_castsi256_ps(y32Load(net8_max[s])));
+}
+static inline __m256 yfReverse(__m256 v) {
+    return _mm256_permutevar8x32_ps(v, y32Load(rev8_idx));
+}
+static inline unsigned yfLessMask(__m256 v, __m256 p) {
+    return (unsigned)_mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_LT_OQ));
+}
+static inline void yfStorePartition(float *l, float *r, __m256 v, unsigned m, int c) {
+    __m256 packed = _mm256_permutevar8x32_ps(v, permFromTable(perm8[m]));
+    yfStore(l, packed);
+    yfStore(r - c, packed);
+}
+
+DEFINE_VQSORT(y32, int32_t, __m256i, 8, 6, 3, intro32, INT32_MAX)
+DEFINE_VQSORT(y64, int64_t, __m256i, 4, 3, 2, intro64, INT64_MAX)
+DEFINE_VQSORT(yf, float, __m256, 8, 6, 3, introF, INFINITY)
+
+#pragma GCC pop_options
+
+// ============================================================
+// RUNTIME DISPATCH
+// ============================================================
+
+static pthread_once_t simd_once = PTHREAD_ONCE_INIT;
+static void (*sort32_impl)(int32_t *, size_t) = intro32Sort;
+static void (*sort64_impl)(int64_t *, size_t) = intro64Sort;
+static void (*sortf_impl)(float *, size_t) = introFSort;
+static const char *simd_isa = "scalar";
+
+static void simdInit(void) {
+    __builtin_cpu_init();
+    int avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    int avx512 = avx2 && __builtin_cpu_supports("avx512f") &&
+                 __builtin_cpu_supports("avx512dq") &&
+                 __builtin_cpu_supports("avx512vl") &&
+                 __builtin_cpu_supports("avx512bw");
+
+    const char *env = getenv("SORT_ISA");
+    if (env && strcmp(env, "scalar") == 0) avx2 = avx512 = 0;
+    if (env && strcmp(env, "avx2") == 0) avx512 = 0;
+
+    fillTables();
+    if (avx512) {
+        sort32_impl = z32Sort;
+        sort64_impl = z64Sort;
+        sortf_impl = zfSort;
+        simd_isa = "avx512";
+    } else if (avx2) {
+        sort32_impl = y32Sort;
+        sort64_impl = y64Sort;
+        sortf_impl = yfSort;
+        simd_isa = "avx2";
+    }
+}
+
+const char *simdSortIsa(void) {
+    pthread_once(&simd_once, simdInit);
+    return simd_isa;
+}
+
+void simdSort32(int32_t arr[], size_t n) {
+    pthread_once(&simd_once, simdInit);
+    sort32_impl(arr, n);
+}
+
+void simdSort64(int64_t arr[], size_t n) {
+    pthread_once(&simd_once, simdInit);
+    sort64_impl(arr, n);
+}
+
+void simdSortFloat(float arr[], size_t n) {
+    pthread_once(&simd_once, simdInit);
+    sortf_impl(arr, n);
+}
@@ -0,0 +1,108 @@
+/*
+ * Sort Server Client
+ *
+ * The caller's side of the sort service protocol (see sort_server.c):
+ * create a payload, fill the keys through the returned mapping, send a
+ * request with the payload attached, and read the result from the same
+ * mapping once the response arrives. The payload can be reused for any
+ * number of requests, as long as only one of them is in flight at a time.
+ * The payload is sealed against shrinking, which the server requires.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "../include/sorting.h"
+
+int sortClientConnect(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (sock < 0) return -1;
+    if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+/*
+ * Send req, with payload attached unless it is -1; SORT_OP_MERGE also
+ * sends its req->runs run lengths
+ * Returns 0, or -1 if the message could not be sent whole
+ */
+int sortClientSend(int sock, const SortRequest *req, int payload, const uint64_t runLens[]) {
+    size_t lensBytes = req->op == SORT_OP_MERGE ? (size_t)req->runs * sizeof(uint64_t) : 0;
+    struct iovec iov[2] = {{(void *)req, sizeof(*req)}, {(void *)runLens, lensBytes}};
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = lensBytes ? 2 : 1;
+
+    if (payload >= 0) {
+        memset(&control, 0, sizeof(control));
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+        struct cmsghdr *c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(c), &payload, sizeof(int));
+    }
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    return sent == (ssize_t)(sizeof(*req) + lensBytes) ? 0 : -1;
+}
+
+// Wait for the next response; 0, or -1 once the server is gone
+int sortClientReceive(int sock, SortResponse *resp) {
+    ssize_t got;
+    do {
+        got = recv(sock, resp, sizeof(*resp), 0);
+    } while (got < 0 && errno == EINTR);
+    return got == (ssize_t)sizeof(*resp) ? 0 : -1;
+}
+
+/*
+ * Shared-memory payload for n int32 keys, mapped read-write at *keys
+ * Returns the memfd, or -1
+ */
+int sortPayloadCreate(size_t n, int **keys) {
+    *keys = NULL;
+    int payload = memfd_create("sort-payload", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (payload < 0) return -1;
+    size_t bytes = n * sizeof(int);
+    if (ftruncate(payload, (off_t)bytes) != 0 || fcntl(payload, F_ADD_SEALS, F_SEAL_SHRINK) != 0) {
+        close(payload);
+        return -1;
+    }
+    if (n > 0) {
+        void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, payload, 0);
+        if (map == MAP_FAILED) {
+            close(payload);
+            return -1;
+        }
+        *keys = (int *)map;
+    }
+    return payload;
+}
+
+void sortPayloadDestroy(int payload, int *keys, size_t n) {
+    if (keys) munmap(keys, n * sizeof(int));
+    if (payload >= 0) close(payload);
+}
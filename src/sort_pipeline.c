@@ -0,0 +1,317 @@
+/*
+ * Asynchronous Generate -> Sort -> Verify Pipeline
+ *
+ * The benchmark drivers generate an input, copy it, sort it and check it
+ * one step after another on one core. Here each step is a pipeline stage
+ * with a thread of its own (a one-worker ThreadPool, so stages keep FIFO
+ * order): while job i is being sorted, job i+1 is generated and job i-1
+ * verified.
+ *
+ *   - sortPipelineSubmit() never blocks and returns a future (SortJob)
+ *   - sortJobWait() blocks until the job has ended; an optional callback
+ *     runs on the pipeline thread that ends it
+ *   - sortJobCancel() stops a job that has not started sorting yet
+ *   - At most `depth` arrays are in flight at once: the generator stage
+ *     waits for a free slot, which bounds memory for long batches. Arrays
+ *     of ended jobs are recycled, so a batch does not page in fresh memory
+ *     for every job. A keep_output array leaves the count when its job
+ *     ends (the caller holds it until sortJobRelease), so waiting on a
+ *     later job never depends on releasing an earlier one
+ *
+ * The sort stage runs one job at a time, so its timings are not disturbed
+ * by other sorts (only by generation and verification on other cores).
+ */
+
+#include <pthread.h>
+#include "../include/sorting.h"
+
+#define PIPELINE_DEFAULT_DEPTH 3   // One array per stage
+
+struct SortPipeline {
+    ThreadPool *generator;
+    ThreadPool *sorter;
+    ThreadPool *verifier;
+    pthread_mutex_t lock;          // Guards every job's state too
+    pthread_cond_t changed;        // A job ended or an array was freed
+    int depth;
+    int arrays;                    // In flight (not yet ended), at most depth
+    int outstanding;               // Submitted and not ended
+    int **spare;                   // Arrays of ended jobs, for reuse
+    size_t *spare_len;
+    int spares;
+};
+
+struct SortJob {
+    SortPipeline *pipeline;
+    SortJobSpec spec;
+    SortJobResult result;
+    int *data;
+    size_t capacity;               // Of data, in keys
+    uint64_t checksum;             // Of the keys as generated
+    int cancelled;
+    int refs;                      // The caller, plus the pipeline until the job ends
+    double submitted_ms;
+};
+
+// Order-independent, so it survives the sort: catches lost or invented keys
+static uint64_t keysChecksum(const int arr[], size_t n) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += ((uint64_t)(uint32_t)arr[i] + 1) * 0x9E3779B97F4A7C15ULL;
+    return sum;
+}
+
+// Keep an array for the next job (caller holds the lock); 0 if it was kept
+static int recycleArray(SortPipeline *p, int *data, size_t capacity) {
+    if (p->spares == p->depth) return -1;
+    p->spare[p->spares] = data;
+    p->spare_len[p->spares] = capacity;
+    p->spares++;
+    return 0;
+}
+
+// A spare array of at least n keys, NULL if none (caller holds the lock)
+static int *reuseArray(SortPipeline *p, size_t n, size_t *capacity) {
+    for (int i = 0; i < p->spares; i++) {
+        if (p->spare_len[i] < n) continue;
+        int *data = p->spare[i];
+        *capacity = p->spare_len[i];
+        p->spares--;
+        p->spare[i] = p->spare[p->spares];
+        p->spare_len[i] = p->spare_len[p->spares];
+        return data;
+    }
+    return NULL;
+}
+
+static void jobUnref(SortJob *job) {
+    SortPipeline *p = job->pipeline;
+    int *freed = NULL;
+    pthread_mutex_lock(&p->lock);
+    int refs = --job->refs;
+    if (refs == 0 && job->data) {
+        // A kept output, already out of the arrays count
+        if (recycleArray(p, job->data, job->capacity) != 0) freed = job->data;
+        pthread_cond_broadcast(&p->changed);
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (refs > 0) return;
+    sortBufferFree(freed);
+    free(job);
+}
+
+// Enter a terminal state, release the array unless the caller keeps it
+// (either way it no longer counts against depth)
+static void jobFinish(SortJob *job, SortJobState state) {
+    SortPipeline *p = job->pipeline;
+    int *freed = NULL;
+    pthread_mutex_lock(&p->lock);
+    job->result.state = state;
+    job->result.latency_ms = now_ms() - job->submitted_ms;
+    if (job->data) p->arrays--;
+    if (job->data && !(state == SORT_JOB_DONE && job->spec.keep_output)) {
+        if (recycleArray(p, job->data, job->capacity) != 0) freed = job->data;
+        job->data = NULL;
+    }
+    pthread_mutex_unlock(&p->lock);
+    sortBufferFree(freed);
+
+    if (job->spec.on_done) job->spec.on_done(job, job->spec.ctx);
+
+    pthread_mutex_lock(&p->lock);
+    p->outstanding--;
+    pthread_cond_broadcast(&p->changed);
+    pthread_mutex_unlock(&p->lock);
+    jobUnref(job);
+}
+
+// ============================================================
+// STAGES
+// ============================================================
+
+static void verifyStage(void *arg) {
+    SortJob *job = (SortJob *)arg;
+    double start = now_ms();
+    job->result.passed = isSorted(job->data, job->spec.n) &&
+                         keysChecksum(job->data, job->spec.n) == job->checksum;
+    job->result.verify_ms = now_ms() - start;
+    jobFinish(job, SORT_JOB_DONE);
+}
+
+static void sortStage(void *arg) {
+    SortJob *job = (SortJob *)arg;
+    SortPipeline *p = job->pipeline;
+    pthread_mutex_lock(&p->lock);
+    int cancelled = job->cancelled;
+    if (!cancelled) job->result.state = SORT_JOB_SORTING;
+    pthread_mutex_unlock(&p->lock);
+    if (cancelled) {
+        jobFinish(job, SORT_JOB_CANCELLED);
+        return;
+    }
+
+    double start = now_ms();
+    job->spec.sort(job->data, job->spec.n);
+    job->result.sort_ms = now_ms() - start;
+
+    pthread_mutex_lock(&p->lock);
+    job->result.state = SORT_JOB_VERIFYING;
+    pthread_mutex_unlock(&p->lock);
+    if (threadPoolSubmit(p->verifier, verifyStage, job) != 0) verifyStage(job);
+}
+
+static void generateStage(void *arg) {
+    SortJob *job = (SortJob *)arg;
+    SortPipeline *p = job->pipeline;
+    pthread_mutex_lock(&p->lock);
+    while (!job->cancelled && p->arrays >= p->depth) pthread_cond_wait(&p->changed, &p->lock);
+    size_t n = job->spec.n;
+    int cancelled = job->cancelled;
+    if (!cancelled) {
+        p->arrays++;
+        job->result.state = SORT_JOB_GENERATING;
+        job->data = reuseArray(p, n, &job->capacity);
+    }
+    pthread_mutex_unlock(&p->lock);
+    if (cancelled) {
+        jobFinish(job, SORT_JOB_CANCELLED);
+        return;
+    }
+
+    if (!job->data) {
+        job->capacity = n ? n : 1;
+        job->data = (int *)sortBufferAlloc(job->capacity * sizeof(int));
+    }
+    if (!job->data) {
+        pthread_mutex_lock(&p->lock);
+        p->arrays--;
+        pthread_mutex_unlock(&p->lock);
+        jobFinish(job, SORT_JOB_FAILED);
+        return;
+    }
+
+    double start = now_ms();
+    if (job->spec.generate) job->spec.generate(job->data, n);
+    else copyArray((int *)job->spec.input, job->data, n);
+    job->checksum = keysChecksum(job->data, n);
+    job->result.generate_ms = now_ms() - start;
+
+    if (threadPoolSubmit(p->sorter, sortStage, job) != 0) sortStage(job);
+}
+
+// ============================================================
+// PUBLIC API
+// ============================================================
+
+SortPipeline *sortPipelineCreate(int depth) {
+    SortPipeline *p = (SortPipeline *)calloc(1, sizeof(SortPipeline));
+    if (!p) return NULL;
+    p->depth = depth > 0 ? depth : PIPELINE_DEFAULT_DEPTH;
+    p->spare = (int **)calloc((size_t)p->depth, sizeof(int *));
+    p->spare_len = (size_t *)calloc((size_t)p->depth, sizeof(size_t));
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->changed, NULL);
+    p->generator = threadPoolCreate(1);
+    p->sorter = threadPoolCreate(1);
+    p->verifier = threadPoolCreate(1);
+    if (!p->generator || !p->sorter || !p->verifier || !p->spare || !p->spare_len) {
+        sortPipelineDestroy(p);
+        return NULL;
+    }
+    return p;
+}
+
+/*
+ * Queue a job; spec is copied, spec->input (when used) must stay valid
+ * until the job ends
+ * Returns the job (release it with sortJobRelease), or NULL
+ */
+SortJob *sortPipelineSubmit(SortPipeline *pipeline, const SortJobSpec *spec) {
+    if (!spec->sort || (!spec->generate && !spec->input && spec->n > 0)) return NULL;
+    SortJob *job = (SortJob *)calloc(1, sizeof(SortJob));
+    if (!job) return NULL;
+    job->pipeline = pipeline;
+    job->spec = *spec;
+    job->result.state = SORT_JOB_QUEUED;
+    job->refs = 2;
+    job->submitted_ms = now_ms();
+
+    pthread_mutex_lock(&pipeline->lock);
+    pipeline->outstanding++;
+    pthread_mutex_unlock(&pipeline->lock);
+    if (threadPoolSubmit(pipeline->generator, generateStage, job) != 0) {
+        pthread_mutex_lock(&pipeline->lock);
+        pipeline->outstanding--;
+        pthread_mutex_unlock(&pipeline->lock);
+        free(job);
+        return NULL;
+    }
+    return job;
+}
+
+/*
+ * Ask a job to stop. Returns 0 if it will end as SORT_JOB_CANCELLED,
+ * -1 if it has already started sorting (it then runs to the end)
+ */
+int sortJobCancel(SortJob *job) {
+    SortPipeline *p = job->pipeline;
+    pthread_mutex_lock(&p->lock);
+    int state = job->result.state;
+    int accepted = state == SORT_JOB_QUEUED || state == SORT_JOB_GENERATING ||
+                   state == SORT_JOB_CANCELLED;
+    if (accepted) job->cancelled = 1;
+    pthread_cond_broadcast(&p->changed);   // Wake the generator if it waits for a slot
+    pthread_mutex_unlock(&p->lock);
+    return accepted ? 0 : -1;
+}
+
+static int jobEnded(const SortJob *job) {
+    return job->result.state >= SORT_JOB_DONE;
+}
+
+SortJobState sortJobPoll(SortJob *job) {
+    pthread_mutex_lock(&job->pipeline->lock);
+    SortJobState state = job->result.state;
+    pthread_mutex_unlock(&job->pipeline->lock);
+    return state;
+}
+
+void sortJobWait(SortJob *job, SortJobResult *result) {
+    SortPipeline *p = job->pipeline;
+    pthread_mutex_lock(&p->lock);
+    while (!jobEnded(job)) pthread_cond_wait(&p->changed, &p->lock);
+    if (result) *result = job->result;
+    pthread_mutex_unlock(&p->lock);
+}
+
+// Sorted keys of a finished keep_output job, NULL otherwise
+const int *sortJobOutput(SortJob *job) {
+    pthread_mutex_lock(&job->pipeline->lock);
+    const int *data = job->result.state == SORT_JOB_DONE ? job->data : NULL;
+    pthread_mutex_unlock(&job->pipeline->lock);
+    return data;
+}
+
+// Drop the caller's reference; a job still running is not affected
+void sortJobRelease(SortJob *job) {
+    if (job) jobUnref(job);
+}
+
+void sortPipelineDrain(SortPipeline *pipeline) {
+    pthread_mutex_lock(&pipeline->lock);
+    while (pipeline->outstanding > 0) pthread_cond_wait(&pipeline->changed, &pipeline->lock);
+    pthread_mutex_unlock(&pipeline->lock);
+}
+
+void sortPipelineDestroy(SortPipeline *pipeline) {
+    if (!pipeline) return;
+    if (pipeline->generator && pipeline->sorter && pipeline->verifier) sortPipelineDrain(pipeline);
+    threadPoolDestroy(pipeline->generator);
+    threadPoolDestroy(pipeline->sorter);
+    threadPoolDestroy(pipeline->verifier);
+    for (int i = 0; i < pipeline->spares; i++) sortBufferFree(pipeline->spare[i]);
+    free(pipeline->spare);
+    free(pipeline->spare_len);
+    pthread_cond_destroy(&pipeline->changed);
+    pthread_mutex_destroy(&pipeline->lock);
+    free(pipeline);
+}
@@ -0,0 +1,515 @@
+/*
+ * Sort Server
+ *
+ * One process sorts on behalf of every program on the host (sort_server,
+ * protocol in sorting.h):
+ *   - Clients connect to a Unix domain SOCK_SEQPACKET socket, so each
+ *     request and each response is exactly one message
+ *   - The keys travel in a memfd passed with the request (SCM_RIGHTS).
+ *     The server maps the client's pages and works on them in place:
+ *     neither side copies the payload. The memfd must carry F_SEAL_SHRINK,
+ *     or a client truncating it mid-job would fault the server (SIGBUS)
+ *   - Jobs run on one shared thread pool. Jobs of at most batch_max_keys
+ *     keys are collected while the event loop drains the sockets and
+ *     handed to the pool as a single task, so a burst of small requests
+ *     pays for one queue hand-off instead of one per request
+ *   - Each response reports the job's queueing and run time; SORT_OP_STATS
+ *     returns the totals, which are also printed at shutdown
+ *
+ * Connections are reference counted: the event loop holds one reference
+ * and every job in flight one more, so a client that hangs up with jobs
+ * still queued does not pull the socket out from under the workers.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "../include/sorting.h"
+
+#define SERVER_MAX_CLIENTS 256
+#define SERVER_POLL_MS 500       // Upper bound on noticing sortServerStop()
+
+static volatile sig_atomic_t server_stop;
+
+void sortServerConfigDefaults(SortServerConfig *cfg) {
+    const char *path = getenv("SORT_SERVER_SOCKET");
+    cfg->socket_path = path ? path : SORT_SERVICE_SOCKET;
+    cfg->threads = 0;
+    cfg->batch_max_keys = 4096;
+    cfg->batch_max_jobs = 64;
+    cfg->verbose = 0;
+}
+
+void sortServerStop(void) {
+    server_stop = 1;
+}
+
+// ============================================================
+// CONNECTIONS, JOBS AND STATISTICS
+// ============================================================
+
+typedef struct {
+    int sock;
+    int refs;                 // The event loop plus every job in flight
+    pthread_mutex_t lock;     // Guards refs and serializes responses
+} Connection;
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint64_t jobs;
+    uint64_t keys;
+    uint64_t batches;
+    double latency_ms;        // Sum of received -> answered
+    double max_latency_ms;
+    double start_ms;
+} ServerStats;
+
+typedef struct {
+    Connection *conn;
+    SortRequest req;
+    int payload;              // memfd
+    uint64_t *run_lens;       // SORT_OP_MERGE
+    double received_ms;
+} ServerJob;
+
+typedef struct {
+    ServerStats *stats;
+    int verbose;
+    int count;
+    ServerJob *jobs[];
+} ServerBatch;
+
+static Connection *connOpen(int sock) {
+    Connection *conn = (Connection *)malloc(sizeof(Connection));
+    if (!conn) return NULL;
+    conn->sock = sock;
+    conn->refs = 1;
+    pthread_mutex_init(&conn->lock, NULL);
+    return conn;
+}
+
+static void connRetain(Connection *conn) {
+    pthread_mutex_lock(&conn->lock);
+    conn->refs++;
+    pthread_mutex_unlock(&conn->lock);
+}
+
+static void connRelease(Connection *conn) {
+    pthread_mutex_lock(&conn->lock);
+    int refs = --conn->refs;
+    pthread_mutex_unlock(&conn->lock);
+    if (refs > 0) return;
+    close(conn->sock);
+    pthread_mutex_destroy(&conn->lock);
+    free(conn);
+}
+
+// A client that already hung up just loses its answer
+static void connRespond(Connection *conn, const SortResponse *resp) {
+    pthread_mutex_lock(&conn->lock);
+    if (send(conn->sock, resp, sizeof(*resp), MSG_NOSIGNAL) < 0 && errno != EPIPE) {
+        perror("sort_server: send");
+    }
+    pthread_mutex_unlock(&conn->lock);
+}
+
+static void statsRecord(ServerStats *stats, uint64_t keys, double latency) {
+    pthread_mutex_lock(&stats->lock);
+    stats->jobs++;
+    stats->keys += keys;
+    stats->latency_ms += latency;
+    if (latency > stats->max_latency_ms) stats->max_latency_ms = latency;
+    pthread_mutex_unlock(&stats->lock);
+}
+
+static void statsFill(ServerStats *stats, SortResponse *resp) {
+    pthread_mutex_lock(&stats->lock);
+    resp->jobs = stats->jobs;
+    resp->keys = stats->keys;
+    resp->batches = stats->batches;
+    resp->uptime_ms = now_ms() - stats->start_ms;
+    resp->mean_latency_ms = stats->jobs ? stats->latency_ms / (double)stats->jobs : 0.0;
+    resp->max_latency_ms = stats->max_latency_ms;
+    pthread_mutex_unlock(&stats->lock);
+}
+
+// ============================================================
+// JOB EXECUTION (pool workers)
+// ============================================================
+
+// Merge the sorted runs laid end to end in keys
+static int mergeRuns(int keys[], size_t n, const uint64_t lens[], uint32_t runs) {
+    const int **starts = (const int **)sort_malloc(runs * sizeof(int *));
+    size_t *sizes = (size_t *)sort_malloc(runs * sizeof(size_t));
+    int *out = (int *)sort_malloc(n * sizeof(int));
+    int status = starts && sizes && out ? 0 : -1;
+
+    size_t total = 0;
+    for (uint32_t r = 0; status == 0 && r < runs; r++) {
+        if (lens[r] > n - total) {
+            status = -1;
+            break;
+        }
+        starts[r] = keys + total;
+        sizes[r] = (size_t)lens[r];
+        total += sizes[r];
+    }
+    if (status == 0 && total != n) status = -1;
+    if (status == 0) status = mergeKWay(starts, sizes, (int)runs, out);
+    if (status == 0) memcpy(keys, out, n * sizeof(int));
+
+    sort_free(out);
+    sort_free(sizes);
+    sort_free(starts);
+    return status;
+}
+
+// Map the payload, run the operation on it in place; 0 or -1
+static int runJob(const ServerJob *job) {
+    const SortRequest *req = &job->req;
+    if (req->n > SIZE_MAX / sizeof(int)) return -1;
+    size_t n = (size_t)req->n;
+    size_t bytes = n * sizeof(int);
+
+    // Without the seal the size checked here could shrink under the mapping
+    int seals = fcntl(job->payload, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)) return -1;
+    struct stat st;
+    if (fstat(job->payload, &st) != 0 || (uint64_t)st.st_size < bytes) return -1;
+    if (n == 0) return 0;
+
+    int *keys = (int *)mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, job->payload, 0);
+    if (keys == MAP_FAILED) return -1;
+
+    int status = 0;
+    switch (req->op) {
+        case SORT_OP_SORT:
+            sortAuto(keys, n, NULL);
+            break;
+        case SORT_OP_TOPK:
+            heapTopK(keys, n, req->k < n ? (size_t)req->k : n);
+            break;
+        case SORT_OP_MERGE:
+            status = mergeRuns(keys, n, job->run_lens, req->runs);
+            break;
+        default:
+            status = -1;
+    }
+    munmap(keys, bytes);
+    return status;
+}
+
+static const char *opName(uint32_t op) {
+    switch (op) {
+        case SORT_OP_SORT:     return "sort";
+        case SORT_OP_TOPK:     return "topk";
+        case SORT_OP_MERGE:    return "merge";
+        case SORT_OP_STATS:    return "stats";
+        case SORT_OP_SHUTDOWN: return "shutdown";
+    }
+    return "unknown";
+}
+
+static void respondNow(Connection *conn, uint64_t id, int status) {
+    SortResponse resp;
+    memset(&resp, 0, sizeof(resp));
+    resp.id = id;
+    resp.status = status;
+    connRespond(conn, &resp);
+}
+
+static void jobFree(ServerJob *job) {
+    close(job->payload);
+    free(job->run_lens);
+    connRelease(job->conn);
+    free(job);
+}
+
+// Pool task: run the batch's jobs back to back, answer each as it finishes
+static void runBatch(void *arg) {
+    ServerBatch *batch = (ServerBatch *)arg;
+    for (int j = 0; j < batch->count; j++) {
+        ServerJob *job = batch->jobs[j];
+        SortResponse resp;
+        memset(&resp, 0, sizeof(resp));
+        resp.id = job->req.id;
+        resp.batch = (uint32_t)batch->count;
+
+        double started = now_ms();
+        resp.status = runJob(job);
+        double finished = now_ms();
+        resp.queue_ms = started - job->received_ms;
+        resp.run_ms = finished - started;
+        connRespond(job->conn, &resp);
+
+        double latency = now_ms() - job->received_ms;
+        statsRecord(batch->stats, resp.status == 0 ? job->req.n : 0, latency);
+        if (batch->verbose) {
+            printf("  job %llu: %s n=%llu batch=%d status=%d queue %.3f ms run %.3f ms\n",
+                   (unsigned long long)job->req.id, opName(job->req.op),
+                   (unsigned long long)job->req.n, batch->count, resp.status,
+                   resp.queue_ms, resp.run_ms);
+        }
+
+        jobFree(job);
+    }
+    free(batch);
+}
+
+// ============================================================
+// EVENT LOOP
+// ============================================================
+
+typedef struct {
+    const SortServerConfig *cfg;
+    ThreadPool *pool;
+    ServerStats stats;
+    ServerBatch *pending;     // Small jobs waiting for the end of the loop pass
+} SortServer;
+
+static ServerBatch *batchCreate(SortServer *server, int capacity) {
+    ServerBatch *batch = (ServerBatch *)malloc(sizeof(ServerBatch) + (size_t)capacity * sizeof(ServerJob *));
+    if (!batch) return NULL;
+    batch->stats = &server->stats;
+    batch->verbose = server->cfg->verbose;
+    batch->count = 0;
+    return batch;
+}
+
+static void batchSubmit(SortServer *server, ServerBatch *batch) {
+    pthread_mutex_lock(&server->stats.lock);
+    server->stats.batches++;
+    pthread_mutex_unlock(&server->stats.lock);
+    if (threadPoolSubmit(server->pool, runBatch, batch) != 0) runBatch(batch);
+}
+
+static void flushPending(SortServer *server) {
+    if (!server->pending) return;
+    batchSubmit(server, server->pending);
+    server->pending = NULL;
+}
+
+// Queue a job: alone if it is large, otherwise into the pending batch
+static void enqueueJob(SortServer *server, ServerJob *job) {
+    const SortServerConfig *cfg = server->cfg;
+    if (job->req.n > cfg->batch_max_keys || cfg->batch_max_jobs <= 1) {
+        ServerBatch *single = batchCreate(server, 1);
+        if (single) {
+            single->jobs[single->count++] = job;
+            batchSubmit(server, single);
+            return;
+        }
+    } else {
+        if (!server->pending) server->pending = batchCreate(server, cfg->batch_max_jobs);
+        if (server->pending) {
+            server->pending->jobs[server->pending->count++] = job;
+            if (server->pending->count == cfg->batch_max_jobs) flushPending(server);
+            return;
+        }
+    }
+    // Out of memory for the batch
+    respondNow(job->conn, job->req.id, -1);
+    jobFree(job);
+}
+
+/*
+ * Read one request from conn
+ * Returns 1 if a message was handled, 0 when none is waiting, -1 once the
+ * client has hung up
+ */
+static int readRequest(SortServer *server, Connection *conn) {
+    SortRequest req;
+    uint64_t lens[SORT_SERVICE_MAX_RUNS];
+    struct iovec iov[2] = {{&req, sizeof(req)}, {lens, sizeof(lens)}};
+    union {
+        char buf[CMSG_SPACE(sizeof(int))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    ssize_t got = recvmsg(conn->sock, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    if (got < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+    if (got == 0) return -1;
+
+    int payload = -1;
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS) {
+            memcpy(&payload, CMSG_DATA(c), sizeof(int));
+        }
+    }
+
+    if ((size_t)got < sizeof(req) || (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC))) {
+        if (payload >= 0) close(payload);
+        respondNow(conn, 0, -1);
+        return 1;
+    }
+
+    if (req.op == SORT_OP_STATS || req.op == SORT_OP_SHUTDOWN) {
+        if (payload >= 0) close(payload);
+        SortResponse resp;
+        memset(&resp, 0, sizeof(resp));
+        resp.id = req.id;
+        statsFill(&server->stats, &resp);
+        connRespond(conn, &resp);
+        if (req.op == SORT_OP_SHUTDOWN) server_stop = 1;
+        return 1;
+    }
+
+    size_t lensBytes = req.op == SORT_OP_MERGE ? (size_t)req.runs * sizeof(uint64_t) : 0;
+    int valid = payload >= 0 && (req.op == SORT_OP_SORT || req.op == SORT_OP_TOPK ||
+                                 (req.op == SORT_OP_MERGE && req.runs <= SORT_SERVICE_MAX_RUNS));
+    if (!valid || (size_t)got != sizeof(req) + lensBytes) {
+        if (payload >= 0) close(payload);
+        respondNow(conn, req.id, -1);
+        return 1;
+    }
+
+    ServerJob *job = (ServerJob *)calloc(1, sizeof(ServerJob));
+    uint64_t *runLens = lensBytes ? (uint64_t *)malloc(lensBytes) : NULL;
+    if (!job || (lensBytes && !runLens)) {
+        free(job);
+        free(runLens);
+        close(payload);
+        respondNow(conn, req.id, -1);
+        return 1;
+    }
+    if (lensBytes) memcpy(runLens, lens, lensBytes);
+    job->conn = conn;
+    job->req = req;
+    job->payload = payload;
+    job->run_lens = runLens;
+    job->received_ms = now_ms();
+    connRetain(conn);
+    enqueueJob(server, job);
+    return 1;
+}
+
+static int openListener(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "sort_server: socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        perror("sort_server: socket");
+        return -1;
+    }
+    unlink(path);   // A stale socket from a previous run
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(sock, 64) != 0) {
+        perror("sort_server: bind");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static void printServerSummary(ServerStats *stats) {
+    SortResponse totals;
+    memset(&totals, 0, sizeof(totals));
+    statsFill(stats, &totals);
+    double seconds = totals.uptime_ms / 1000.0;
+    printf("sort_server: %llu jobs in %llu batches, %llu keys over %.1f s "
+           "(%.1f jobs/s, %.2f Mkeys/s); latency mean %.3f ms, max %.3f ms\n",
+           (unsigned long long)totals.jobs, (unsigned long long)totals.batches,
+           (unsigned long long)totals.keys, seconds,
+           seconds > 0 ? (double)totals.jobs / seconds : 0.0,
+           seconds > 0 ? (double)totals.keys / seconds / 1e6 : 0.0,
+           totals.mean_latency_ms, totals.max_latency_ms);
+}
+
+/*
+ * Serve until a client sends SORT_OP_SHUTDOWN or sortServerStop() is
+ * called; queued jobs are finished before it returns
+ * Returns 0, or -1 if the socket or the pool cannot be set up
+ */
+int sortServerRun(const SortServerConfig *cfg) {
+    SortServer server;
+    memset(&server, 0, sizeof(server));
+    server.cfg = cfg;
+    pthread_mutex_init(&server.stats.lock, NULL);
+    server.stats.start_ms = now_ms();
+    server_stop = 0;
+
+    int listener = openListener(cfg->socket_path);
+    if (listener < 0) return -1;
+    server.pool = threadPoolCreate(cfg->threads);
+    if (!server.pool) {
+        close(listener);
+        unlink(cfg->socket_path);
+        return -1;
+    }
+    printf("sort_server: listening on %s, %d workers, batching jobs of <= %zu keys (up to %d per batch)\n",
+           cfg->socket_path, threadPoolSize(server.pool), cfg->batch_max_keys, cfg->batch_max_jobs);
+    fflush(stdout);
+
+    Connection *conns[SERVER_MAX_CLIENTS];
+    struct pollfd fds[SERVER_MAX_CLIENTS + 1];
+    int count = 0;
+
+    while (!server_stop) {
+        fds[0].fd = listener;
+        fds[0].events = POLLIN;
+        for (int c = 0; c < count; c++) {
+            fds[c + 1].fd = conns[c]->sock;
+            fds[c + 1].events = POLLIN;
+        }
+        int ready = poll(fds, (nfds_t)count + 1, SERVER_POLL_MS);
+        if (ready < 0 && errno != EINTR) {
+            perror("sort_server: poll");
+            break;
+        }
+        if (ready <= 0) continue;
+
+        // Backwards, so a hung-up client can be replaced by the last one
+        for (int c = count - 1; c >= 0; c--) {
+            if (!fds[c + 1].revents) continue;
+            int state;
+            while ((state = readRequest(&server, conns[c])) > 0 && !server_stop) {
+            }
+            if (state < 0) {
+                connRelease(conns[c]);
+                conns[c] = conns[--count];
+            }
+        }
+        flushPending(&server);
+
+        if (fds[0].revents & POLLIN) {
+            int sock;
+            while ((sock = accept4(listener, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+                Connection *conn = count < SERVER_MAX_CLIENTS ? connOpen(sock) : NULL;
+                if (!conn) {
+                    close(sock);
+                    continue;
+                }
+                conns[count++] = conn;
+            }
+        }
+    }
+
+    flushPending(&server);
+    threadPoolDestroy(server.pool);
+    for (int c = 0; c < count; c++) connRelease(conns[c]);
+    close(listener);
+    unlink(cfg->socket_path);
+    printServerSummary(&server.stats);
+    pthread_mutex_destroy(&server.stats.lock);
+    return 0;
+}
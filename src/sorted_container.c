@@ -0,0 +1,346 @@
+/*
+ * Incremental Sorted Container
+ *
+ * Keeps a multiset of keys sorted while new keys keep arriving, without
+ * sorting everything again after each batch. Inserts go to an unsorted
+ * buffer; once it holds buffer_keys keys it is sorted on its own (sortAuto)
+ * and becomes a sorted run. Runs are combined by linear merges:
+ *
+ *   - Single array (the default): every run is merged into one main
+ *     array right away, O(size) per flush. Queries binary-search one array
+ *   - Leveled: runs form a stack, oldest and largest at the bottom, and the
+ *     top is merged into the run below it only while it is more than half
+ *     that run's length. Run lengths thus at least double towards the
+ *     bottom, there are at most log2(size / buffer_keys) + 1 runs, and a
+ *     key is merged O(log size) times in all instead of once per flush.
+ *     Queries binary-search every run
+ *
+ * Merges run backwards in place when the target run has room, so a run
+ * only moves when its allocation doubles. Lookups, counts and ranks
+ * binary-search the runs and scan the buffer; a range scan also sorts the
+ * buffer (it stays sorted until the next insert) and merges the matching
+ * parts of the runs through a loser tree.
+ */
+
+#include "../include/sorting.h"
+
+#define CONTAINER_DEFAULT_BUFFER 4096
+#define CONTAINER_MAX_RUNS 64         // Lengths double: 2^64 keys before this fills
+
+typedef struct {
+    int *keys;
+    size_t len;
+    size_t cap;
+} SortedRun;
+
+struct SortedContainer {
+    SortedContainerConfig cfg;
+    int *buffer;
+    size_t buffered;
+    int buffer_sorted;
+    SortedRun runs[CONTAINER_MAX_RUNS];   // runs[0] is the oldest
+    int nruns;
+    size_t size;                          // Keys in runs and buffer
+};
+
+void sortedContainerConfigDefaults(SortedContainerConfig *cfg) {
+    cfg->buffer_keys = CONTAINER_DEFAULT_BUFFER;
+    cfg->leveled = 0;
+}
+
+// ============================================================
+// RUNS
+// ============================================================
+
+// First position whose key is >= key (or > key when inclusive)
+static size_t boundSearch(const int a[], size_t n, int key, int inclusive) {
+    size_t lo = 0, hi = n;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (a[mid] < key || (inclusive && a[mid] == key)) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+// Keys of the buffer that are < key (or <= key when inclusive)
+static size_t bufferBelow(const SortedContainer *sc, int key, int inclusive) {
+    if (sc->buffer_sorted) return boundSearch(sc->buffer, sc->buffered, key, inclusive);
+    size_t below = 0;
+    for (size_t i = 0; i < sc->buffered; i++) {
+        below += sc->buffer[i] < key || (inclusive && sc->buffer[i] == key);
+    }
+    return below;
+}
+
+/*
+ * Merge the m sorted keys of src into run: backwards in place when the
+ * run has room, otherwise forwards into a new allocation of twice the size
+ * Returns 0, or -1 if memory runs out (the run is then unchanged)
+ */
+static int runMerge(SortedRun *run, const int src[], size_t m) {
+    size_t a = run->len, b = m, need = run->len + m;
+    if (need > run->cap) {
+        size_t cap = run->cap * 2 > need ? run->cap * 2 : need;
+        int *keys = (int *)sort_malloc(cap * sizeof(int));
+        if (!keys) return -1;
+        size_t i = 0, j = 0, o = 0;
+        while (i < a && j < b) keys[o++] = src[j] < run->keys[i] ? src[j++] : run->keys[i++];
+        while (i < a) keys[o++] = run->keys[i++];
+        while (j < b) keys[o++] = src[j++];
+        sort_free(run->keys);
+        run->keys = keys;
+        run->cap = cap;
+    } else {
+        size_t o = need;
+        while (b > 0) {
+            if (a > 0 && run->keys[a - 1] > src[b - 1]) run->keys[--o] = run->keys[--a];
+            else run->keys[--o] = src[--b];
+        }
+    }
+    run->len = need;
+    return 0;
+}
+
+/*
+ * Merge each run into the one below it where the stack's shape asks for
+ * it, from the top down. After a push only the top can be out of shape,
+ * but if memory runs out the collapse stops early: the runs are all still
+ * valid, just more of them than the shape wants, and the next push
+ * resumes it wherever it stopped
+ */
+static void collapseRuns(SortedContainer *sc) {
+    int r = sc->nruns - 1;
+    while (r >= 1) {
+        SortedRun *run = &sc->runs[r];
+        SortedRun *below = run - 1;
+        if (sc->cfg.leveled && run->len * 2 <= below->len) {
+            r--;
+            continue;
+        }
+        if (runMerge(below, run->keys, run->len) != 0) return;
+        sort_free(run->keys);
+        memmove(run, run + 1, (size_t)(sc->nruns - r - 1) * sizeof(*run));
+        sc->nruns--;
+        memset(&sc->runs[sc->nruns], 0, sizeof(SortedRun));
+        // The run below grew: the one now above it only gets safer, so
+        // carry on downwards
+        if (r > sc->nruns - 1) r = sc->nruns - 1;
+    }
+}
+
+/*
+ * Push n sorted keys as a new run, taking ownership of keys (an
+ * allocation of cap keys) unless they can be merged right away
+ * Returns 0 once the keys are in the runs, or -1 if they could not be
+ * placed (the runs are then unchanged)
+ */
+static int pushRun(SortedContainer *sc, int *keys, size_t n, size_t cap, int *taken) {
+    *taken = 0;
+    if (n == 0) return 0;
+    SortedRun *top = sc->nruns > 0 ? &sc->runs[sc->nruns - 1] : NULL;
+    if (top && (!sc->cfg.leveled || n * 2 > top->len)) {
+        // Would be merged into the top run at once: skip the new run
+        if (runMerge(top, keys, n) != 0) return -1;
+    } else {
+        if (sc->nruns == CONTAINER_MAX_RUNS) return -1;
+        SortedRun *run = &sc->runs[sc->nruns++];
+        run->keys = keys;
+        run->len = n;
+        run->cap = cap;
+        *taken = 1;
+    }
+    collapseRuns(sc);
+    return 0;
+}
+
+// ============================================================
+// PUBLIC API
+// ============================================================
+
+SortedContainer *sortedContainerCreate(const SortedContainerConfig *cfg) {
+    SortedContainer *sc = (SortedContainer *)calloc(1, sizeof(SortedContainer));
+    if (!sc) return NULL;
+    if (cfg) sc->cfg = *cfg;
+    else sortedContainerConfigDefaults(&sc->cfg);
+    if (sc->cfg.buffer_keys == 0) sc->cfg.buffer_keys = CONTAINER_DEFAULT_BUFFER;
+    sc->buffer = (int *)sort_malloc(sc->cfg.buffer_keys * sizeof(int));
+    if (!sc->buffer) {
+        free(sc);
+        return NULL;
+    }
+    return sc;
+}
+
+void sortedContainerDestroy(SortedContainer *sc) {
+    if (!sc) return;
+    for (int r = 0; r < sc->nruns; r++) sort_free(sc->runs[r].keys);
+    sort_free(sc->buffer);
+    free(sc);
+}
+
+/*
+ * Sort the buffered keys and merge them into the runs
+ * Returns 0, or -1 if memory runs out (the keys then stay buffered)
+ */
+int sortedContainerFlush(SortedContainer *sc) {
+    if (sc->buffered == 0) return 0;
+    if (!sc->buffer_sorted) sortAuto(sc->buffer, sc->buffered, NULL);
+    sc->buffer_sorted = 1;
+
+    // A new run takes the buffer over, and a fresh one is allocated
+    int *fresh = (int *)sort_malloc(sc->cfg.buffer_keys * sizeof(int));
+    if (!fresh) return -1;
+    int taken;
+    if (pushRun(sc, sc->buffer, sc->buffered, sc->cfg.buffer_keys, &taken) != 0) {
+        sort_free(fresh);
+        return -1;
+    }
+    if (taken) sc->buffer = fresh;
+    else sort_free(fresh);
+    sc->buffered = 0;
+    return 0;
+}
+
+int sortedContainerInsert(SortedContainer *sc, int key) {
+    if (sc->buffered == sc->cfg.buffer_keys && sortedContainerFlush(sc) != 0) return -1;
+    sc->buffer[sc->buffered++] = key;
+    sc->buffer_sorted = 0;
+    sc->size++;
+    return 0;
+}
+
+/*
+ * Insert n keys. A batch at least as large as the buffer is sorted on
+ * its own and pushed as one run instead of going through the buffer
+ * Returns 0, or -1 if memory runs out (the keys are then not all inserted)
+ */
+int sortedContainerInsertBatch(SortedContainer *sc, const int keys[], size_t n) {
+    if (n >= sc->cfg.buffer_keys) {
+        int *run = (int *)sort_malloc(n * sizeof(int));
+        if (!run) return -1;
+        copyArray((int *)keys, run, n);
+        sortAuto(run, n, NULL);
+        int taken;
+        int status = pushRun(sc, run, n, n, &taken);
+        if (!taken) sort_free(run);
+        if (status != 0) return -1;
+        sc->size += n;
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (sortedContainerInsert(sc, keys[i]) != 0) return -1;
+    }
+    return 0;
+}
+
+// Merge every run and the buffer into one array (the fastest for queries)
+int sortedContainerCompact(SortedContainer *sc) {
+    if (sortedContainerFlush(sc) != 0) return -1;
+    if (sc->nruns < 2) return 0;
+    int *keys = (int *)sort_malloc(sc->size * sizeof(int));
+    const int **runs = (const int **)malloc((size_t)sc->nruns * sizeof(int *));
+    size_t *lens = (size_t *)malloc((size_t)sc->nruns * sizeof(size_t));
+    if (!keys || !runs || !lens) {
+        sort_free(keys);
+        free(runs);
+        free(lens);
+        return -1;
+    }
+    for (int r = 0; r < sc->nruns; r++) {
+        runs[r] = sc->runs[r].keys;
+        lens[r] = sc->runs[r].len;
+    }
+    if (mergeKWay(runs, lens, sc->nruns, keys) != 0) {
+        sort_free(keys);
+        free(runs);
+        free(lens);
+        return -1;
+    }
+    for (int r = 0; r < sc->nruns; r++) sort_free(sc->runs[r].keys);
+    memset(sc->runs, 0, sizeof(sc->runs));
+    sc->runs[0].keys = keys;
+    sc->runs[0].len = sc->runs[0].cap = sc->size;
+    sc->nruns = 1;
+    free(runs);
+    free(lens);
+    return 0;
+}
+
+size_t sortedContainerSize(const SortedContainer *sc) {
+    return sc->size;
+}
+
+int sortedContainerRuns(const SortedContainer *sc) {
+    return sc->nruns;
+}
+
+// Number of keys < key
+size_t sortedContainerRank(const SortedContainer *sc, int key) {
+    size_t rank = bufferBelow(sc, key, 0);
+    for (int r = 0; r < sc->nruns; r++) rank += boundSearch(sc->runs[r].keys, sc->runs[r].len, key, 0);
+    return rank;
+}
+
+// Number of keys equal to key
+size_t sortedContainerCount(const SortedContainer *sc, int key) {
+    size_t count = bufferBelow(sc, key, 1) - bufferBelow(sc, key, 0);
+    for (int r = 0; r < sc->nruns; r++) {
+        const SortedRun *run = &sc->runs[r];
+        count += boundSearch(run->keys, run->len, key, 1) - boundSearch(run->keys, run->len, key, 0);
+    }
+    return count;
+}
+
+int sortedContainerContains(const SortedContainer *sc, int key) {
+    for (int r = sc->nruns - 1; r >= 0; r--) {
+        const SortedRun *run = &sc->runs[r];
+        size_t i = boundSearch(run->keys, run->len, key, 0);
+        if (i < run->len && run->keys[i] == key) return 1;
+    }
+    return bufferBelow(sc, key, 1) > bufferBelow(sc, key, 0);
+}
+
+/*
+ * The keys in [lo, hi], ascending, into out (at most max of them)
+ * Returns how many keys lie in the range (more than max if out was too
+ * small), or (size_t)-1 if memory runs out
+ */
+size_t sortedContainerRange(SortedContainer *sc, int lo, int hi, int out[], size_t max) {
+    if (lo > hi) return 0;
+    if (!sc->buffer_sorted) {
+        sortAuto(sc->buffer, sc->buffered, NULL);
+        sc->buffer_sorted = 1;
+    }
+
+    // The matching slice of every run, the buffer being the last one
+    int k = sc->nruns + 1;
+    const int *slice[CONTAINER_MAX_RUNS + 1];
+    size_t len[CONTAINER_MAX_RUNS + 1];
+    int heads[CONTAINER_MAX_RUNS + 1], empty[CONTAINER_MAX_RUNS + 1];
+    size_t total = 0;
+    for (int r = 0; r < k; r++) {
+        const int *keys = r < sc->nruns ? sc->runs[r].keys : sc->buffer;
+        size_t n = r < sc->nruns ? sc->runs[r].len : sc->buffered;
+        size_t first = boundSearch(keys, n, lo, 0);
+        slice[r] = keys + first;
+        len[r] = boundSearch(keys, n, hi, 1) - first;
+        total += len[r];
+        empty[r] = len[r] == 0;
+        heads[r] = empty[r] ? 0 : slice[r][0];
+    }
+
+    size_t want = total < max ? total : max;
+    if (want == 0) return total;
+    LoserTree lt;
+    if (loserTreeInit(&lt, k, heads, empty) != 0) return (size_t)-1;
+    size_t pos[CONTAINER_MAX_RUNS + 1] = {0};
+    for (size_t o = 0; o < want; o++) {
+        int w = loserTreeWinner(&lt);
+        out[o] = loserTreeWinnerKey(&lt);
+        if (++pos[w] < len[w]) loserTreeReplace(&lt, slice[w][pos[w]]);
+        else loserTreeExhaust(&lt);
+    }
+    loserTreeFree(&lt);
+    return total;
+}
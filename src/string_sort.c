@@ -0,0 +1,291 @@
+/*
+ * String and Byte-Key Sorting
+ *
+ * Sorts SortString records (pointer + length, so keys may hold any byte,
+ * NUL included) in lexicographic order: bytes compare unsigned, and a key
+ * that is a prefix of another sorts first.
+ *
+ * Comparing keys through their pointers is what makes string sorts slow:
+ * every comparison is a cache miss into the key bytes. Both engines
+ * therefore work on items that carry a copy of the next 8 key bytes (big
+ * endian, zero padded past the end), so one integer comparison settles 8
+ * bytes, and the key bytes are only read again once those 8 are used up:
+ *
+ *   - Multikey quicksort (Bentley-Sedgewick): three-way partition on the
+ *     cached word instead of one character. The == part shares 8 more
+ *     bytes: keys that end within them are done (ordered by length), the
+ *     others reload the next 8 bytes and continue
+ *   - MSD radix sort: one 257-way counting pass per byte (bucket 0 for the
+ *     keys that end there), the digits read from the cached word. Where
+ *     every key shares the whole cached word, the 8 bytes are skipped in
+ *     one step. Buckets below STRING_RADIX_MIN keys go to the multikey
+ *     quicksort instead, where 257 counters would cost more than the keys
+ *     themselves
+ *
+ * Ranges of up to STRING_INSERTION_MAX keys finish with insertion sort.
+ * Neither engine is stable; equal keys are indistinguishable unless their
+ * pointers are compared.
+ */
+
+#include "../include/sorting.h"
+
+#define STRING_INSERTION_MAX 16
+#define STRING_RADIX_MIN 64
+#define STRING_BUCKETS 257        // End of key, then the 256 byte values
+
+typedef struct {
+    uint64_t cache;               // Key bytes [depth, depth + 8), big endian
+    const unsigned char *ptr;
+    size_t len;
+} StringItem;
+
+int compareSortStrings(const SortString *a, const SortString *b) {
+    size_t len = a->len < b->len ? a->len : b->len;
+    int c = len ? memcmp(a->ptr, b->ptr, len) : 0;
+    if (c != 0) return c;
+    return (a->len > b->len) - (a->len < b->len);
+}
+
+int isSortedStrings(const SortString strs[], size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        if (compareSortStrings(&strs[i - 1], &strs[i]) > 0) return 0;
+    }
+    return 1;
+}
+
+// The 8 key bytes from depth on, zero padded past the end
+static inline uint64_t loadCache(const unsigned char *ptr, size_t len, size_t depth) {
+    if (depth + 8 <= len) {
+        uint64_t w;
+        memcpy(&w, ptr + depth, 8);
+        return __builtin_bswap64(w);
+    }
+    uint64_t w = 0;
+    for (size_t i = 0; i < 8; i++) {
+        w = (w << 8) | (depth + i < len ? ptr[depth + i] : 0);
+    }
+    return w;
+}
+
+static void reloadCaches(StringItem a[], size_t n, size_t depth) {
+    for (size_t i = 0; i < n; i++) a[i].cache = loadCache(a[i].ptr, a[i].len, depth);
+}
+
+// Order of two keys equal before depth (caches hold depth on)
+static int compareFrom(const StringItem *a, const StringItem *b, size_t depth) {
+    if (a->cache != b->cache) return a->cache < b->cache ? -1 : 1;
+    size_t len = a->len < b->len ? a->len : b->len;
+    int c = len > depth ? memcmp(a->ptr + depth, b->ptr + depth, len - depth) : 0;
+    if (c != 0) return c;
+    return (a->len > b->len) - (a->len < b->len);
+}
+
+static void insertionSortStrings(StringItem a[], size_t n, size_t depth) {
+    for (size_t i = 1; i < n; i++) {
+        StringItem x = a[i];
+        size_t j = i;
+        while (j > 0 && compareFrom(&a[j - 1], &x, depth) > 0) {
+            a[j] = a[j - 1];
+            j--;
+        }
+        a[j] = x;
+    }
+}
+
+static inline void swapItems(StringItem *a, StringItem *b) {
+    StringItem t = *a;
+    *a = *b;
+    *b = t;
+}
+
+static uint64_t medianCache(const StringItem a[], size_t n) {
+    uint64_t x = a[0].cache, y = a[n / 2].cache, z = a[n - 1].cache;
+    if (y < x) { uint64_t t = x; x = y; y = t; }
+    if (z < y) y = z;
+    return y < x ? x : y;
+}
+
+// ============================================================
+// MULTIKEY QUICKSORT
+// ============================================================
+
+// Keys that end within the 8 bytes their equal caches cover differ in
+// length only (depth .. depth + 8): one pass per length, shortest first
+static void sortEndedByLength(StringItem a[], size_t n, size_t depth) {
+    size_t done = 0;
+    for (size_t len = depth; len < depth + 8 && done < n; len++) {
+        for (size_t k = done; k < n; k++) {
+            if (a[k].len == len) swapItems(&a[done++], &a[k]);
+        }
+    }
+}
+
+// Keys of a[0..n) share all bytes before depth; caches hold depth on
+static void multikeyQuickSort(StringItem a[], size_t n, size_t depth) {
+    while (n > STRING_INSERTION_MAX) {
+        uint64_t pivot = medianCache(a, n);
+        size_t lt = 0, i = 0, gt = n;
+        while (i < gt) {
+            if (a[i].cache < pivot) swapItems(&a[lt++], &a[i++]);
+            else if (a[i].cache > pivot) swapItems(&a[i], &a[--gt]);
+            else i++;
+        }
+        multikeyQuickSort(a, lt, depth);
+        multikeyQuickSort(a + gt, n - gt, depth);
+
+        // The == part: keys ending within these 8 bytes come first, by
+        // length (shorter is a prefix of longer); the rest go on
+        a += lt;
+        n = gt - lt;
+        size_t ended = 0;
+        for (size_t k = 0; k < n; k++) {
+            if (a[k].len <= depth + 8) swapItems(&a[ended++], &a[k]);
+        }
+        sortEndedByLength(a, ended, depth);
+        a += ended;
+        n -= ended;
+        depth += 8;
+        reloadCaches(a, n, depth);
+    }
+    insertionSortStrings(a, n, depth);
+}
+
+// ============================================================
+// MSD RADIX SORT
+// ============================================================
+
+typedef struct {
+    StringItem *tmp;              // Scatter buffer, as long as the input
+    uint16_t *digit;              // Bucket of each key in the current pass
+} RadixScratch;
+
+// Keys of a[0..n) share all bytes before depth; caches were loaded at
+// cacheDepth (depth - 8 < cacheDepth <= depth)
+static void msdRadixSort(StringItem a[], size_t n, size_t depth, size_t cacheDepth,
+                         RadixScratch *scratch) {
+    for (;;) {
+        if (n < STRING_RADIX_MIN) {
+            multikeyQuickSort(a, n, cacheDepth);
+            return;
+        }
+        if (depth == cacheDepth + 8) {
+            reloadCaches(a, n, depth);
+            cacheDepth = depth;
+        }
+
+        size_t count[STRING_BUCKETS] = {0};
+        uint16_t *digit = scratch->digit;
+        int shift = 56 - 8 * (int)(depth - cacheDepth);
+        for (size_t i = 0; i < n; i++) {
+            digit[i] = a[i].len <= depth ? 0 : (uint16_t)(1 + ((a[i].cache >> shift) & 0xFF));
+            count[digit[i]]++;
+        }
+
+        // One bucket holds every key: nothing to move, go one byte deeper
+        int only = -1;
+        for (int d = 0; d < STRING_BUCKETS; d++) {
+            if (count[d] == n) only = d;
+        }
+        if (only == 0) return;    // All keys end here: all equal
+        if (only > 0) {
+            // At the start of the cached word, check whether the keys share
+            // all of it: long common prefixes then cost a pass per 8 bytes
+            int shared = depth == cacheDepth;
+            for (size_t i = 0; i < n && shared; i++) {
+                shared = a[i].cache == a[0].cache && a[i].len > depth + 8;
+            }
+            depth += shared ? 8 : 1;
+            continue;
+        }
+
+        size_t start[STRING_BUCKETS], offset = 0;
+        for (int d = 0; d < STRING_BUCKETS; d++) {
+            start[d] = offset;
+            offset += count[d];
+        }
+        size_t pos[STRING_BUCKETS];
+        memcpy(pos, start, sizeof(pos));
+        for (size_t i = 0; i < n; i++) scratch->tmp[pos[digit[i]]++] = a[i];
+        memcpy(a, scratch->tmp, n * sizeof(StringItem));
+
+        // Bucket 0 is finished: those keys all end at depth. The largest
+        // bucket is sorted by this loop, only the others recurse, so each
+        // level of recursion at least halves n (nested prefixes would
+        // otherwise recurse once per byte)
+        int largest = 1;
+        for (int d = 2; d < STRING_BUCKETS; d++) {
+            if (count[d] > count[largest]) largest = d;
+        }
+        for (int d = 1; d < STRING_BUCKETS; d++) {
+            if (d != largest && count[d] > 1) {
+                msdRadixSort(a + start[d], count[d], depth + 1, cacheDepth, scratch);
+            }
+        }
+        if (count[largest] < 2) return;
+        a += start[largest];
+        n = count[largest];
+        depth++;
+    }
+}
+
+// ============================================================
+// PUBLIC API
+// ============================================================
+
+static StringItem *loadItems(const SortString strs[], size_t n) {
+    StringItem *items = (StringItem *)sort_malloc(n * sizeof(StringItem));
+    if (!items) return NULL;
+    for (size_t i = 0; i < n; i++) {
+        items[i].ptr = (const unsigned char *)strs[i].ptr;
+        items[i].len = strs[i].len;
+        items[i].cache = loadCache(items[i].ptr, items[i].len, 0);
+    }
+    return items;
+}
+
+static void storeItems(SortString strs[], const StringItem items[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        strs[i].ptr = (const char *)items[i].ptr;
+        strs[i].len = items[i].len;
+    }
+}
+
+// Returns 0 on success, -1 if memory runs out (strs is then unchanged)
+int stringSortMultikey(SortString strs[], size_t n) {
+    if (n < 2) return 0;
+    StringItem *items = loadItems(strs, n);
+    if (!items) return -1;
+    multikeyQuickSort(items, n, 0);
+    storeItems(strs, items, n);
+    sort_free(items);
+    return 0;
+}
+
+// Returns 0 on success, -1 if memory runs out (strs is then unchanged)
+int stringSortMSD(SortString strs[], size_t n) {
+    if (n < 2) return 0;
+    StringItem *items = loadItems(strs, n);
+    RadixScratch scratch;
+    scratch.tmp = (StringItem *)sort_malloc(n * sizeof(StringItem));
+    scratch.digit = (uint16_t *)sort_malloc(n * sizeof(uint16_t));
+    int status = -1;
+    if (items && scratch.tmp && scratch.digit) {
+        msdRadixSort(items, n, 0, 0, &scratch);
+        storeItems(strs, items, n);
+        status = 0;
+    }
+    sort_free(scratch.digit);
+    sort_free(scratch.tmp);
+    sort_free(items);
+    return status;
+}
+
+static int compareSortStringsVoid(const void *a, const void *b) {
+    return compareSortStrings((const SortString *)a, (const SortString *)b);
+}
+
+// The C library's qsort with a memcmp comparator, as a baseline
+int stringSortQsort(SortString strs[], size_t n) {
+    qsort(strs, n, sizeof(SortString), compareSortStringsVoid);
+    return 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * Worker Thread Pool
+ *
+ * parallelFor() starts its threads for one loop and joins them before it
+ * returns. Long-running callers (the sort server) need workers that stay
+ * up between jobs: the pool keeps a fixed set of threads waiting on a
+ * FIFO queue of tasks.
+ *
+ * Tasks may themselves call parallelFor(); those threads are separate
+ * from the pool's.
+ */
+
+#include <pthread.h>
+#include "../include/sorting.h"
+
+typedef struct PoolItem {
+    PoolTask task;
+    void *arg;
+    struct PoolItem *next;
+} PoolItem;
+
+struct ThreadPool {
+    pthread_mutex_t lock;
+    pthread_cond_t work;       // A task was queued, or the pool is stopping
+    pthread_cond_t idle;       // The last outstanding task finished
+    PoolItem *head;
+    PoolItem *tail;
+    int outstanding;           // Queued plus running
+    int stop;
+    int threads;
+    pthread_t *workers;
+};
+
+// Tasks run in submission order; workers leave once stopped and drained
+static void *poolWorker(void *arg) {
+    ThreadPool *pool = (ThreadPool *)arg;
+    if (pool->threads > 1) sortSetParallelRegion(1);
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->head && !pool->stop) pthread_cond_wait(&pool->work, &pool->lock);
+        if (!pool->head) break;
+
+        PoolItem *item = pool->head;
+        pool->head = item->next;
+        if (!pool->head) pool->tail = NULL;
+        pthread_mutex_unlock(&pool->lock);
+
+        item->task(item->arg);
+        free(item);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->outstanding == 0) pthread_cond_broadcast(&pool->idle);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool *threadPoolCreate(int threads) {
+    if (threads <= 0) threads = sortThreadCount();
+    ThreadPool *pool = (ThreadPool *)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+    pool->workers = (pthread_t *)malloc((size_t)threads * sizeof(pthread_t));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    for (int t = 0; t < threads; t++) {
+        if (pthread_create(&pool->workers[t], NULL, poolWorker, pool) != 0) break;
+        pool->threads++;
+    }
+    if (pool->threads == 0) {
+        threadPoolDestroy(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/*
+ * Queue task(arg) for the next free worker
+ * Returns 0, or -1 if the pool is shutting down or memory runs out
+ */
+int threadPoolSubmit(ThreadPool *pool, PoolTask task, void *arg) {
+    PoolItem *item = (PoolItem *)malloc(sizeof(PoolItem));
+    if (!item) return -1;
+    item->task = task;
+    item->arg = arg;
+    item->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->stop) {
+        pthread_mutex_unlock(&pool->lock);
+        free(item);
+        return -1;
+    }
+    if (pool->tail) pool->tail->next = item;
+    else pool->head = item;
+    pool->tail = item;
+    pool->outstanding++;
+    pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    return 0;
+}
+
+void threadPoolWait(ThreadPool *pool) {
+    pthread_mutex_lock(&pool->lock);
+    while (pool->outstanding > 0) pthread_cond_wait(&pool->idle, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void threadPoolDestroy(ThreadPool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int t = 0; t < pool->threads; t++) pthread_join(pool->workers[t], NULL);
+    pthread_cond_destroy(&pool->idle);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
+
+int threadPoolSize(const ThreadPool *pool) {
+    return pool->threads;
+}
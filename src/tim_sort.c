@@ -0,0 +1,321 @@
+/*
+ * TimSort Implementation
+ *
+ * Adaptive, stable merge sort for data that already contains order:
+ * 1. Scan for natural runs (strictly descending runs are reversed) and
+ *    extend short ones to minrun with binary insertion sort
+ * 2. Push runs on a stack and merge neighbours while the lengths break
+ *    the invariants len[i-2] > len[i-1] + len[i] and len[i-1] > len[i]
+ * 3. Before a merge, gallop to trim the prefix of the left run and the
+ *    suffix of the right run that are already in place; inside a merge,
+ *    switch to galloping when one run keeps winning
+ *
+ * Complexity:
+ *   Best Case: O(n) - already sorted or reverse sorted
+ *   Worst Case: O(n log n)
+ *   Space: O(n/2) - temporary copy of the smaller run
+ */
+
+#include "../include/sorting.h"
+
+#define MIN_MERGE 32       // Arrays shorter than this are just insertion sorted
+#define MIN_GALLOP 7       // Initial wins in a row before galloping
+#define MAX_RUNS 85        // Enough stack for any 64-bit array length
+
+typedef struct {
+    int *a;
+    int *tmp;
+    int min_gallop;
+    ptrdiff_t run_base[MAX_RUNS];
+    ptrdiff_t run_len[MAX_RUNS];
+    int stack_size;
+} TimState;
+
+/*
+ * minrun: n / 2^k in [MIN_MERGE/2, MIN_MERGE], rounded up when any
+ * shifted-out bit is set, so n / minrun is a power of two or just below
+ */
+static ptrdiff_t minRunLength(ptrdiff_t n) {
+    ptrdiff_t r = 0;
+    while (n >= MIN_MERGE) {
+        r |= n & 1;
+        n >>= 1;
+    }
+    return n + r;
+}
+
+/*
+ * Length of the run starting at lo; a strictly descending run is
+ * reversed in place (strict, so equal keys never swap and it stays stable)
+ */
+static ptrdiff_t countRunAndMakeAscending(int a[], ptrdiff_t lo, ptrdiff_t hi) {
+    ptrdiff_t run_hi = lo + 1;
+    if (run_hi == hi) return 1;
+    
+    if (a[run_hi++] < a[lo]) {
+        while (run_hi < hi && a[run_hi] < a[run_hi - 1]) run_hi++;
+        for (ptrdiff_t i = lo, j = run_hi - 1; i < j; i++, j--) swap(&a[i], &a[j]);
+    } else {
+        while (run_hi < hi && a[run_hi] >= a[run_hi - 1]) run_hi++;
+    }
+    return run_hi - lo;
+}
+
+/*
+ * Binary insertion sort of a[lo..hi), a[lo..start) already sorted
+ */
+static void binaryInsertionSort(int a[], ptrdiff_t lo, ptrdiff_t hi, ptrdiff_t start) {
+    for (; start < hi; start++) {
+        int pivot = a[start];
+        ptrdiff_t left = lo, right = start;
+        while (left < right) {
+            ptrdiff_t mid = left + (right - left) / 2;
+            if (pivot < a[mid]) right = mid;
+            else left = mid + 1;
+        }
+        memmove(&a[left + 1], &a[left], (size_t)(start - left) * sizeof(int));
+        a[left] = pivot;
+    }
+}
+
+/*
+ * Number of elements of a[0..len) that are < key (gallopLeft) or
+ * <= key (gallopRight): exponential search from the front, then binary
+ */
+static ptrdiff_t gallop(int key, const int a[], ptrdiff_t len, int inclusive) {
+    ptrdiff_t last = 0, ofs = 1;
+    while (ofs < len && (inclusive ? a[ofs - 1] <= key : a[ofs - 1] < key)) {
+        last = ofs;
+        ofs = ofs * 2 + 1;
+        if (ofs <= 0) ofs = len;   // Overflow
+    }
+    if (ofs > len) ofs = len;
+    
+    while (last < ofs) {
+        ptrdiff_t mid = last + (ofs - last) / 2;
+        if (inclusive ? a[mid] <= key : a[mid] < key) last = mid + 1;
+        else ofs = mid;
+    }
+    return last;
+}
+
+static ptrdiff_t gallopLeft(int key, const int a[], ptrdiff_t len) {
+    return gallop(key, a, len, 0);
+}
+
+static ptrdiff_t gallopRight(int key, const int a[], ptrdiff_t len) {
+    return gallop(key, a, len, 1);
+}
+
+/*
+ * Merge a[base1..base1+len1) with the run right after it, len1 <= len2:
+ * the left run is copied out and the output fills from the front
+ */
+static void mergeLo(TimState *ts, ptrdiff_t base1, ptrdiff_t len1, ptrdiff_t base2, ptrdiff_t len2) {
+    int *a = ts->a, *tmp = ts->tmp;
+    memcpy(tmp, &a[base1], (size_t)len1 * sizeof(int));
+    
+    ptrdiff_t i = 0, j = base2, k = base1, end2 = base2 + len2;
+    int min_gallop = ts->min_gallop;
+    
+    while (i < len1 && j < end2) {
+        int count1 = 0, count2 = 0;
+        
+        // One pair at a time until a run wins min_gallop times in a row
+        while (i < len1 && j < end2) {
+            if (a[j] < tmp[i]) {
+                a[k++] = a[j++];
+                count2++;
+                count1 = 0;
+                if (count2 >= min_gallop) break;
+            } else {
+                a[k++] = tmp[i++];
+                count1++;
+                count2 = 0;
+                if (count1 >= min_gallop) break;
+            }
+        }
+        
+        // Galloping: copy whole blocks while they stay long
+        while (i < len1 && j < end2) {
+            ptrdiff_t c1 = gallopRight(a[j], &tmp[i], len1 - i);
+            memcpy(&a[k], &tmp[i], (size_t)c1 * sizeof(int));
+            k += c1;
+            i += c1;
+            if (i >= len1) break;
+            a[k++] = a[j++];
+            if (j >= end2) break;
+            
+            ptrdiff_t c2 = gallopLeft(tmp[i], &a[j], end2 - j);
+            memmove(&a[k], &a[j], (size_t)c2 * sizeof(int));
+            k += c2;
+            j += c2;
+            if (j >= end2) break;
+            a[k++] = tmp[i++];
+            
+            if (c1 < MIN_GALLOP && c2 < MIN_GALLOP) {
+                min_gallop++;
+                break;
+            }
+            if (min_gallop > 1) min_gallop--;
+        }
+    }
+    
+    // What is left of the right run is already in place
+    memcpy(&a[k], &tmp[i], (size_t)(len1 - i) * sizeof(int));
+    ts->min_gallop = min_gallop;
+}
+
+/*
+ * Mirror of mergeLo for len1 > len2: the right run is copied out and
+ * the output fills from the back
+ */
+static void mergeHi(TimState *ts, ptrdiff_t base1, ptrdiff_t len1, ptrdiff_t base2, ptrdiff_t len2) {
+    int *a = ts->a, *tmp = ts->tmp;
+    memcpy(tmp, &a[base2], (size_t)len2 * sizeof(int));
+    
+    ptrdiff_t i = base1 + len1 - 1, j = len2 - 1, k = base2 + len2 - 1;
+    int min_gallop = ts->min_gallop;
+    
+    while (i >= base1 && j >= 0) {
+        int count1 = 0, count2 = 0;
+        
+        while (i >= base1 && j >= 0) {
+            if (tmp[j] < a[i]) {
+                a[k--] = a[i--];
+                count1++;
+                count2 = 0;
+                if (count1 >= min_gallop) break;
+            } else {
+                a[k--] = tmp[j--];
+                count2++;
+                count1 = 0;
+                if (count2 >= min_gallop) break;
+            }
+        }
+        
+        while (i >= base1 && j >= 0) {
+            // Left-run elements greater than tmp[j] go to the back as a block
+            ptrdiff_t c1 = (i - base1 + 1) - gallopRight(tmp[j], &a[base1], i - base1 + 1);
+            memmove(&a[k - c1 + 1], &a[i - c1 + 1], (size_t)c1 * sizeof(int));
+            k -= c1;
+            i -= c1;
+            if (i < base1) break;
+            a[k--] = tmp[j--];
+            if (j < 0) break;
+            
+            // Right-run elements not less than a[i] follow as a block
+            ptrdiff_t c2 = (j + 1) - gallopLeft(a[i], tmp, j + 1);
+            memcpy(&a[k - c2 + 1], &tmp[j - c2 + 1], (size_t)c2 * sizeof(int));
+            k -= c2;
+            j -= c2;
+            if (j < 0) break;
+            a[k--] = a[i--];
+            
+            if (c1 < MIN_GALLOP && c2 < MIN_GALLOP) {
+                min_gallop++;
+                break;
+            }
+            if (min_gallop > 1) min_gallop--;
+        }
+    }
+    
+    // What is left of the left run is already in place
+    memcpy(&a[base1], tmp, (size_t)(j + 1) * sizeof(int));
+    ts->min_gallop = min_gallop;
+}
+
+/*
+ * Merge stack entries i and i + 1
+ */
+static void mergeAt(TimState *ts, int i) {
+    ptrdiff_t base1 = ts->run_base[i], len1 = ts->run_len[i];
+    ptrdiff_t base2 = ts->run_base[i + 1], len2 = ts->run_len[i + 1];
+    
+    ts->run_len[i] = len1 + len2;
+    if (i == ts->stack_size - 3) {
+        ts->run_base[i + 1] = ts->run_base[i + 2];
+        ts->run_len[i + 1] = ts->run_len[i + 2];
+    }
+    ts->stack_size--;
+    
+    // Skip the prefix of run 1 and the suffix of run 2 that are in place
+    ptrdiff_t k = gallopRight(ts->a[base2], &ts->a[base1], len1);
+    base1 += k;
+    len1 -= k;
+    if (len1 == 0) return;
+    len2 = gallopLeft(ts->a[base1 + len1 - 1], &ts->a[base2], len2);
+    if (len2 == 0) return;
+    
+    if (len1 <= len2) mergeLo(ts, base1, len1, base2, len2);
+    else mergeHi(ts, base1, len1, base2, len2);
+}
+
+static void mergeCollapse(TimState *ts) {
+    while (ts->stack_size > 1) {
+        int n = ts->stack_size - 2;
+        ptrdiff_t *len = ts->run_len;
+        if ((n > 0 && len[n - 1] <= len[n] + len[n + 1]) ||
+            (n > 1 && len[n - 2] <= len[n - 1] + len[n])) {
+            if (len[n - 1] < len[n + 1]) n--;
+        } else if (len[n] > len[n + 1]) {
+            break;
+        }
+        mergeAt(ts, n);
+    }
+}
+
+static void mergeForceCollapse(TimState *ts) {
+    while (ts->stack_size > 1) {
+        int n = ts->stack_size - 2;
+        if (n > 0 && ts->run_len[n - 1] < ts->run_len[n + 1]) n--;
+        mergeAt(ts, n);
+    }
+}
+
+/*
+ * TimSort: sorts arr[0..n) stably
+ */
+void timSort(int arr[], size_t len) {
+    ptrdiff_t n = (ptrdiff_t)len;
+    if (n < 2) return;
+    
+    if (n < MIN_MERGE) {
+        ptrdiff_t run = countRunAndMakeAscending(arr, 0, n);
+        binaryInsertionSort(arr, 0, n, run);
+        return;
+    }
+    
+    TimState ts;
+    ts.a = arr;
+    ts.tmp = (int *)sort_malloc((size_t)(n / 2 + 1) * sizeof(int));
+    if (!ts.tmp) {
+        // No merge buffer: plain ints lose nothing to an unstable in-place sort
+        heapSort(arr, len);
+        return;
+    }
+    ts.min_gallop = MIN_GALLOP;
+    ts.stack_size = 0;
+    
+    ptrdiff_t min_run = minRunLength(n);
+    ptrdiff_t lo = 0, remaining = n;
+    while (remaining > 0) {
+        ptrdiff_t run = countRunAndMakeAscending(arr, lo, n);
+        if (run < min_run) {
+            ptrdiff_t forced = remaining < min_run ? remaining : min_run;
+            binaryInsertionSort(arr, lo, lo + forced, lo + run);
+            run = forced;
+        }
+        
+        ts.run_base[ts.stack_size] = lo;
+        ts.run_len[ts.stack_size] = run;
+        ts.stack_size++;
+        mergeCollapse(&ts);
+        
+        lo += run;
+        remaining -= run;
+    }
+    mergeForceCollapse(&ts);
+    
+    sort_free(ts.tmp);
+}
@@ -0,0 +1,118 @@
+/*
+ * Per-Phase Tracing
+ *
+ * Collects histograms that explain where a sort spends its time:
+ *   - Quick Sort: recursion depth of every partition step and the split
+ *     ratio (left part / partitioned range) of each partition
+ *   - Bucket Sort (integers): distribution of bucket occupancy
+ *   - Radix Sort: wall-clock time of each digit pass
+ *
+ * Everything in this file only exists when built with -DSORT_TRACE
+ * (make TRACE=1). Otherwise the TRACE_* hooks in sorting.h expand to
+ * nothing and the algorithms carry no tracing cost at all.
+ */
+
+#include "../include/sorting.h"
+
+#ifdef SORT_TRACE
+
+#define TRACE_DEPTH_BINS 128   // Last bin collects every deeper level
+#define TRACE_SPLIT_BINS 10
+#define TRACE_OCCUPANCY_BINS 16
+#define TRACE_RADIX_PASSES 16
+
+static struct {
+    // Quick Sort
+    int qs_depth;
+    int qs_max_depth;
+    long long qs_partitions;
+    long long qs_depth_hist[TRACE_DEPTH_BINS];
+    long long qs_split_hist[TRACE_SPLIT_BINS];
+    // Bucket Sort
+    long long bucket_runs;
+    long long bucket_count;
+    long long bucket_max_occupancy;
+    long long bucket_occupancy_hist[TRACE_OCCUPANCY_BINS];
+    // Radix Sort
+    int radix_passes;
+    double radix_pass_ms[TRACE_RADIX_PASSES];
+} trace;
+
+void trace_reset(void) {
+    memset(&trace, 0, sizeof(trace));
+}
+
+void trace_qs_enter(void) {
+    int d = trace.qs_depth++;
+    if (d > trace.qs_max_depth) trace.qs_max_depth = d;
+    trace.qs_depth_hist[d < TRACE_DEPTH_BINS ? d : TRACE_DEPTH_BINS - 1]++;
+}
+
+void trace_qs_leave(void) {
+    trace.qs_depth--;
+}
+
+void trace_qs_split(ptrdiff_t p, ptrdiff_t q, ptrdiff_t r) {
+    // Fraction of the range (pivot excluded) that went to the left part
+    double ratio = (double)(q - p) / (double)(r - p);
+    int bin = (int)(ratio * TRACE_SPLIT_BINS);
+    if (bin >= TRACE_SPLIT_BINS) bin = TRACE_SPLIT_BINS - 1;
+    trace.qs_split_hist[bin]++;
+    trace.qs_partitions++;
+}
+
+void trace_bucket_occupancy(long long occupancy) {
+    trace.bucket_count++;
+    if (occupancy > trace.bucket_max_occupancy) trace.bucket_max_occupancy = occupancy;
+    trace.bucket_occupancy_hist[occupancy < TRACE_OCCUPANCY_BINS ? occupancy : TRACE_OCCUPANCY_BINS - 1]++;
+}
+
+void trace_bucket_run(void) {
+    trace.bucket_runs++;
+}
+
+double trace_radix_pass_begin(void) {
+    return now_ms();
+}
+
+void trace_radix_pass_end(int pass, double start_ms) {
+    if (pass >= TRACE_RADIX_PASSES) return;
+    trace.radix_pass_ms[pass] += now_ms() - start_ms;
+    if (pass + 1 > trace.radix_passes) trace.radix_passes = pass + 1;
+}
+
+static void writeHistogram(FILE *f, const char *name, const long long *hist, int bins) {
+    // Trailing empty bins are dropped to keep the output compact
+    int last = bins - 1;
+    while (last > 0 && hist[last] == 0) last--;
+    fprintf(f, "\"%s\":[", name);
+    for (int i = 0; i <= last; i++) {
+        fprintf(f, "%s%lld", i ? "," : "", hist[i]);
+    }
+    fprintf(f, "]");
+}
+
+int trace_write_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    
+    fprintf(f, "{\"quick_sort\":{\"partitions\":%lld,\"max_depth\":%d,",
+            trace.qs_partitions, trace.qs_max_depth);
+    writeHistogram(f, "depth_hist", trace.qs_depth_hist, TRACE_DEPTH_BINS);
+    fprintf(f, ",");
+    writeHistogram(f, "split_ratio_hist", trace.qs_split_hist, TRACE_SPLIT_BINS);
+    
+    fprintf(f, "},\"bucket_sort\":{\"runs\":%lld,\"buckets\":%lld,\"max_occupancy\":%lld,",
+            trace.bucket_runs, trace.bucket_count, trace.bucket_max_occupancy);
+    writeHistogram(f, "occupancy_hist", trace.bucket_occupancy_hist, TRACE_OCCUPANCY_BINS);
+    
+    fprintf(f, "},\"radix_sort\":{\"pass_ms\":[");
+    for (int i = 0; i < trace.radix_passes; i++) {
+        fprintf(f, "%s%.6f", i ? "," : "", trace.radix_pass_ms[i]);
+    }
+    fprintf(f, "]}}\n");
+    
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+#endif // SORT_TRACE
@@ -0,0 +1,83 @@
+/*
+ * Machine Tuning Profile
+ *
+ * Thresholds that depend on the cache sizes and core count of the machine
+ * live in one SortTuning record instead of being hardcoded. The first
+ * call to sortTuning() fills it with the defaults and then overrides them
+ * from the profile written by `sort_test tune` (SORT_PROFILE, or
+ * output/sort_profile.txt when that is unset). A missing profile is not
+ * an error: the defaults stay.
+ *
+ * The file is plain text, one `key = value` per line, `#` starts a comment.
+ */
+
+#include <pthread.h>
+#include "../include/sorting.h"
+
+static SortTuning sort_tuning;
+static pthread_once_t tuning_once = PTHREAD_ONCE_INIT;
+
+void sortTuningDefaults(SortTuning *t) {
+    t->small_sort_max = 32;
+    t->radix_bits = 8;
+    t->parallel_grain = 1 << 14;
+    t->radix_min_n = 1024;
+}
+
+const char *sortTuningPath(void) {
+    const char *env = getenv("SORT_PROFILE");
+    return env && *env ? env : "output/sort_profile.txt";
+}
+
+static void loadProfileOnce(void) {
+    sortTuningDefaults(&sort_tuning);
+    sortTuningLoad(sortTuningPath(), &sort_tuning);
+}
+
+const SortTuning *sortTuning(void) {
+    pthread_once(&tuning_once, loadProfileOnce);
+    return &sort_tuning;
+}
+
+void setSortTuning(const SortTuning *t) {
+    pthread_once(&tuning_once, loadProfileOnce);
+    sort_tuning = *t;
+}
+
+/*
+ * Override the fields of t named in the profile; out-of-range values are
+ * skipped. Returns 0 on success, -1 when the file cannot be read.
+ */
+int sortTuningLoad(const char *path, SortTuning *t) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    
+    char line[256], key[64];
+    long value;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || sscanf(line, " %63[a-z_] = %ld", key, &value) != 2) continue;
+        
+        if (strcmp(key, "small_sort_max") == 0 && value >= 1 && value <= 1024) {
+            t->small_sort_max = (int)value;
+        } else if (strcmp(key, "radix_bits") == 0 && value >= 4 && value <= 16) {
+            t->radix_bits = (int)value;
+        } else if (strcmp(key, "parallel_grain") == 0 && value >= 1) {
+            t->parallel_grain = (size_t)value;
+        } else if (strcmp(key, "radix_min_n") == 0 && value >= 0 && value <= 0x7fffffffL) {
+            t->radix_min_n = (int)value;
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+int sortTuningSave(const char *path, const SortTuning *t) {
+    FILE *f = fopen(path, "w");
+    if (!f) return -1;
+    fprintf(f, "# Written by `sort_test tune`; read at startup (override with SORT_PROFILE)\n");
+    fprintf(f, "small_sort_max = %d\n", t->small_sort_max);
+    fprintf(f, "radix_bits = %d\n", t->radix_bits);
+    fprintf(f, "parallel_grain = %zu\n", t->parallel_grain);
+    fprintf(f, "radix_min_n = %d\n", t->radix_min_n);
+    return fclose(f) == 0 ? 0 : -1;
+}
@@ -3,17 +3,62 @@
  * Provides common functionality for all sorting algorithms
  */
 
+#include <limits.h>
 #include "../include/sorting.h"
 
 // Global counters
 long long comparison_count = 0;
 long long swap_count = 0;
 size_t memory_used = 0;
+size_t memory_peak = 0;
 
 void reset_counters(void) {
     comparison_count = 0;
     swap_count = 0;
     memory_used = 0;
+    memory_peak = 0;
+}
+
+// ============================================================
+// TRACKED ALLOCATOR
+// ============================================================
+
+// Blocks come from sortBufferAlloc (see memory.c), which records each
+// block's size, so sort_free can give the bytes back; large blocks follow
+// the huge-page and first-touch policy there.
+
+// Atomic updates, so parallelFor bodies may allocate too
+static void trackAlloc(size_t bytes) {
+    size_t used = __atomic_add_fetch(&memory_used, bytes, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&memory_peak, __ATOMIC_RELAXED);
+    while (used > peak &&
+           !__atomic_compare_exchange_n(&memory_peak, &peak, used, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void *sort_malloc(size_t bytes) {
+    void *ptr = sortBufferAlloc(bytes);
+    if (ptr) trackAlloc(bytes);
+    return ptr;
+}
+
+void *sort_calloc(size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+    void *ptr = sortBufferAllocZeroed(count * size);
+    if (ptr) trackAlloc(count * size);
+    return ptr;
+}
+
+void sort_free(void *ptr) {
+    if (!ptr) return;
+    size_t bytes = sortBufferSize(ptr);
+    // A reset between allocation and free must not wrap the counter
+    size_t used = __atomic_load_n(&memory_used, __ATOMIC_RELAXED);
+    size_t next;
+    do {
+        next = bytes <= used ? used - bytes : 0;
+    } while (!__atomic_compare_exchange_n(&memory_used, &used, next, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    sortBufferFree(ptr);
 }
 
 // Swap with counting
@@ -30,69 +75,85 @@ int compare_counted(int a, int b) {
     return a > b;
 }
 
-void printArray(int arr[], int n) {
+void printArray(int arr[], size_t n) {
     printf("[");
-    for (int i = 0; i < n; i++) {
+    for (size_t i = 0; i < n; i++) {
         printf("%d", arr[i]);
-        if (i < n - 1) printf(", ");
+        if (i + 1 < n) printf(", ");
     }
     printf("]\n");
 }
 
-void copyArray(int src[], int dest[], int n) {
-    for (int i = 0; i < n; i++) {
-        dest[i] = src[i];
-    }
+void copyArray(int src[], int dest[], size_t n) {
+    memcpy(dest, src, n * sizeof(int));
 }
 
-int isSorted(int arr[], int n) {
-    for (int i = 0; i < n - 1; i++) {
-        if (arr[i] > arr[i + 1]) return 0;
+int isSorted(int arr[], size_t n) {
+    for (size_t i = 1; i < n; i++) {
+        if (arr[i - 1] > arr[i]) return 0;
     }
     return 1;
 }
 
+double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
 // ============================================================
 // TEST CASE GENERATORS
 // ============================================================
 
-void generateRandomArray(int arr[], int n, int maxVal) {
-    for (int i = 0; i < n; i++) {
-        arr[i] = rand() % maxVal;
-    }
+// Random generators draw from seeded xoshiro streams (see random.c), so a
+// run is reproducible from its seed and large arrays are filled in parallel
+
+/*
+ * Key for position i of an n-element ramp: i itself while n fits in an
+ * int, otherwise i scaled down so the ramp stays monotone (with repeats)
+ */
+int sequenceKey(size_t i, size_t n) {
+    if (n <= (size_t)INT_MAX) return (int)i;
+    return (int)(i / ((n + INT_MAX - 1) / INT_MAX));
 }
 
-void generateSortedArray(int arr[], int n) {
-    for (int i = 0; i < n; i++) {
-        arr[i] = i;
+void generateRandomArray(int arr[], size_t n, int maxVal) {
+    fillRandomRange(arr, n, 0, maxVal - 1, nextInputSeed());
+}
+
+void generateRandomArray64(int64_t arr[], size_t n, int64_t minVal, int64_t maxVal) {
+    fillRandomRange64(arr, n, minVal, maxVal, nextInputSeed());
+}
+
+void generateSortedArray(int arr[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = sequenceKey(i, n);
     }
 }
 
-void generateReverseSortedArray(int arr[], int n) {
-    for (int i = 0; i < n; i++) {
-        arr[i] = n - i;
+void generateReverseSortedArray(int arr[], size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        arr[i] = sequenceKey(n - 1 - i, n) + 1;
     }
 }
 
-void generateNearlySortedArray(int arr[], int n, int numSwaps) {
+void generateNearlySortedArray(int arr[], size_t n, size_t numSwaps) {
     // Start with sorted array
-    for (int i = 0; i < n; i++) {
-        arr[i] = i;
-    }
+    generateSortedArray(arr, n);
     // Perform a few random swaps
-    for (int i = 0; i < numSwaps && n > 1; i++) {
-        int idx1 = rand() % n;
-        int idx2 = rand() % n;
+    SortRng rng;
+    rngSeed(&rng, nextInputSeed());
+    for (size_t i = 0; i < numSwaps && n > 1; i++) {
+        size_t idx1 = (size_t)rngBounded(&rng, n);
+        size_t idx2 = (size_t)rngBounded(&rng, n);
         int temp = arr[idx1];
         arr[idx1] = arr[idx2];
         arr[idx2] = temp;
     }
 }
 
-void generateDuplicatesArray(int arr[], int n, int uniqueValues) {
-    for (int i = 0; i < n; i++) {
-        arr[i] = rand() % uniqueValues;
-    }
+void generateDuplicatesArray(int arr[], size_t n, int uniqueValues) {
+    fillRandomRange(arr, n, 0, uniqueValues - 1, nextInputSeed());
 }
 
 // ============================================================
@@ -100,9 +161,9 @@ void generateDuplicatesArray(int arr[], int n, int uniqueValues) {
 // ============================================================
 
 // Bubble sort for StableElement (stable)
-void stableBubbleSort(StableElement arr[], int n) {
-    for (int i = 0; i < n - 1; i++) {
-        for (int j = 0; j < n - i - 1; j++) {
+void stableBubbleSort(StableElement arr[], size_t n) {
+    for (size_t i = 0; i + 1 < n; i++) {
+        for (size_t j = 0; j + 1 < n - i; j++) {
             if (arr[j].value > arr[j + 1].value) {
                 StableElement temp = arr[j];
                 arr[j] = arr[j + 1];
@@ -113,10 +174,10 @@ void stableBubbleSort(StableElement arr[], int n) {
 }
 
 // Selection sort for StableElement (unstable)
-void unstableSelectionSort(StableElement arr[], int n) {
-    for (int i = 0; i < n - 1; i++) {
-        int min_idx = i;
-        for (int j = i + 1; j < n; j++) {
+void unstableSelectionSort(StableElement arr[], size_t n) {
+    for (size_t i = 0; i + 1 < n; i++) {
+        size_t min_idx = i;
+        for (size_t j = i + 1; j < n; j++) {
             if (arr[j].value < arr[min_idx].value) {
                 min_idx = j;
             }
@@ -170,6 +231,17 @@ void demonstrateStability(void) {
     }
     printf("\n  Order of equal elements may be changed!\n\n");
     
-    printf("STABLE algorithms: Bubble Sort, Gnome Sort, Radix Sort, Bucket Sort\n");
+    // Parallel merge sort (stable)
+    StableElement merge_arr[] = {
+        {3, 0}, {1, 1}, {2, 2}, {1, 3}, {3, 4}, {2, 5}
+    };
+    parallelMergeSortStable(merge_arr, n);
+    printf("After STABLE sort (Parallel Merge Sort):\n  ");
+    for (int i = 0; i < n; i++) {
+        printf("(%d,idx%d) ", merge_arr[i].value, merge_arr[i].original_index);
+    }
+    printf("\n\n");
+    
+    printf("STABLE algorithms: Bubble Sort, Gnome Sort, Radix Sort, Bucket Sort, Merge Sort\n");
     printf("UNSTABLE algorithms: Quick Sort, Heap Sort\n");
 }